@@ -110,6 +110,12 @@ namespace cugl {
  * executed in the host thread.  If you need to access the AudioEngine in a
  * callback function, you should use the {@link Application#schedule} method
  * to delay until the main thread is next available.
+ *
+ * Commands that touch a sound effect channel (play, stop, pause, resume) are
+ * not applied to the mixer graph directly.  They are pushed onto a lock-free
+ * queue and applied by the audio thread at the start of its next render.
+ * Hence the main thread never waits on the audio thread, no matter how many
+ * effects are started in a single frame.
  */
 class AudioChannels {
 #pragma mark Sound State
@@ -154,6 +160,22 @@ private:
     std::deque<std::shared_ptr<audio::AudioPanner>> _pan1Pool;
     /** An object pool of panners for adapting stereo sound assets */
     std::deque<std::shared_ptr<audio::AudioPanner>> _pan2Pool;
+    /** An object pool of players, recycled per sample asset */
+    std::unordered_map<const Sound*,std::vector<std::shared_ptr<audio::AudioNode>>> _playPool;
+
+    /** The audio thread relay that applies queued channel commands */
+    class CommandRelay;
+    /** The relay between the mixer and the output device */
+    std::shared_ptr<CommandRelay> _relay;
+
+    /** The stack of sound effect channels that are not in use */
+    std::vector<Uint32> _chfree;
+    /** The channels whose effect is fading out (oldest first) */
+    std::deque<Uint32> _chfade;
+    /** The effect node that currently owns each channel (nullptr if free) */
+    std::vector<const audio::AudioNode*> _chowner;
+    /** Whether the owner of each channel has been asked to stop */
+    std::vector<bool> _chstop;
 
     /**
      * Callback function for background music
@@ -243,6 +265,40 @@ private:
      */
     void removeKey(std::string key);
 
+    /**
+     * Returns an available sound effect channel, or -1 if there is none.
+     *
+     * This method is O(1).  It first takes a channel that is not in use at
+     * all, and then a channel whose effect is already fading out.  If neither
+     * is available and force is true, it will stop the longest playing sound
+     * effect and take its channel.
+     *
+     * @param force Whether to force another sound to stop.
+     *
+     * @return an available sound effect channel, or -1 if there is none.
+     */
+    int acquireChannel(bool force);
+
+    /**
+     * Returns a channel to the free list if it is owned by the given node.
+     *
+     * A channel may be taken from a fading effect before that effect has
+     * finished.  In that case, the channel is not freed when the old effect
+     * is collected.
+     *
+     * @param node  The effect node that finished
+     */
+    void releaseChannel(const audio::AudioNode* node);
+
+    /**
+     * Returns a player node for the given sound, recycling one if possible.
+     *
+     * @param asset The sound asset
+     *
+     * @return a player node for the given sound, recycling one if possible.
+     */
+    std::shared_ptr<audio::AudioNode> acquirePlayer(const std::shared_ptr<Sound>& asset);
+
     /**
      * Returns a playable audio node for a given a sound instance.
      *
@@ -840,7 +896,7 @@ public:
      * @return the number of channels available for sound effects.
      */
     size_t getAvailableChannels() const {
-        return (size_t)_capacity-_effects.size();
+        return _chfree.size();
     }
 
     /**
@@ -13,6 +13,10 @@
 //  decoding forces us to put decoding state in these classes and not in the
 //  asset file (particularly when there are multiple streams).
 //
+//  Streamed players never decode on the audio thread.  Instead, a shared
+//  read-ahead thread decodes each stream a few pages ahead into a ring of
+//  pages, which the audio thread drains without locking.
+//
 //  CUGL MIT License:
 //
 //     This software is provided 'as-is', without any express or implied
@@ -40,10 +44,12 @@
 #define __CU_AUDIO_PLAYER_H__
 #include <SDL/SDL.h>
 #include <cugl/audio/CUAudioSample.h>
+#include <cugl/util/CULockFreeQueue.h>
 #include "CUAudioNode.h"
 #include <functional>
 #include <string>
 #include <atomic>
+#include <mutex>
 
 // TODO: Move fade-in/fade-out support to new class
 namespace  cugl {
@@ -63,7 +69,10 @@ namespace  cugl {
  * you should combine this node with {@link AudioScheduler}.
  *
  * This class is medium-weight, and has a lot of buffers to support stream
- * decoding (when appropriate).  In practice, it may be best to create a
+ * decoding (when appropriate).  A streamed player keeps a ring of decoded
+ * pages (about {@link READ_AHEAD} frames) that is filled by a background
+ * read-ahead thread shared by all streamed players.  If the ring runs dry
+ * (e.g. right after a seek) the player outputs silence rather than block.  In practice, it may be best to create a
  * memory pool of preallocated players (which are reinitialized) than to
  * construct them on the fly.
  *
@@ -93,19 +102,37 @@ protected:
     float* _buffer;
     
     // Streaming support
-    /** A buffer for storing each chunk as we need it */
+    /** The storage for every page in the read-ahead ring */
     float* _chunker;
-    /** The size of a single chunk in frames */
+    /** The size of a single page in frames */
     Uint32 _chksize;
-    /** The pointer to the last available frame in the chunk */
-    Uint32 _chklimt;
-    /** The number of the last read frame in the chunk */
-    Uint32 _chklast;
-        
-    /** Whether or not we need to reposition (STREAMING ACCESS) */
-    std::atomic<bool> _dirty;
+    /** The number of pages in the read-ahead ring */
+    Uint32 _chkpages;
+    /** The first frame of each page */
+    Uint64* _pgstart;
+    /** The number of frames decoded into each page */
+    Uint32* _pglimit;
+    /** The pages decoded by the read-ahead thread, in stream order */
+    LockFreeQueue<Uint32> _filled;
+    /** The pages released by the audio thread, ready to be decoded */
+    LockFreeQueue<Uint32> _empty;
+    /** The page the audio thread is reading from (-1 for none) */
+    Sint32 _chkpage;
+    /** The last page the audio thread asked to seek to (AUDIO THREAD ONLY) */
+    Uint64 _asked;
+    /** The page the read-ahead thread should seek to, or NO_SEEK */
+    std::atomic<Uint64> _seekpage;
+    /** The next page the read-ahead thread will decode */
+    Uint64 _nextpage;
+    /** A mutex guarding the decoder against disposal (never the audio thread) */
+    std::mutex _pgmutex;
 
 public:
+    /** The (minimum) number of frames a streamed player decodes ahead */
+    static const Uint32 READ_AHEAD;
+    /** The seek request value indicating that no seek is pending */
+    static const Uint64 NO_SEEK;
+
 #pragma mark Constructors
     /**
      * Creates a degenerate audio player with no associated source.
@@ -302,21 +329,45 @@ public:
      */
     virtual double setRemaining(double time) override;
     
-private:
 #pragma mark Stream Decoding
     /**
-     * Decodes the audio stream up to the given position.
+     * Decodes pages into the read-ahead ring until it is full.
+     *
+     * READ-AHEAD THREAD ONLY: Users should never access this method directly.
+     * It is called by the read-ahead thread, and once when the player is
+     * initialized to prime the ring.
+     *
+     * Pages are decoded in stream order, starting at any seek requested by
+     * the audio thread.  When the decoder reaches the end of the stream, it
+     * continues from the marked position so that a looping player never
+     * waits on the decoder.  Unused pages are simply discarded.
+     */
+    void readAhead();
+
+    /**
+     * Stops the read-ahead thread shared by all streamed players.
+     *
+     * This method blocks until the thread exits.  The thread is restarted
+     * automatically the next time a streamed player is initialized.  It is
+     * called when the audio manager is stopped.
+     */
+    static void stopReadAhead();
+
+private:
+    /**
+     * Returns true if the audio thread found a page containing the frame.
      *
      * AUDIO THREAD ONLY: Users should never access this method directly.
-     * The only exception is when the user needs to create a custom subclass
-     * of this AudioNode.
      *
-     * If the frame is longer than the stream length, it goes to the end of
-     * the stream.
+     * Pages that do not contain the frame are returned to the read-ahead
+     * thread.  If no decoded page contains it, this method asks the read-ahead
+     * thread to seek to it and returns false.
+     *
+     * @param frame    The absolute frame to read
      *
-     * @param frame    The absolute frame to skip to
+     * @return true if the audio thread found a page containing the frame.
      */
-    void scan(Uint64 frame);
+    bool acquirePage(Uint64 frame);
 };
 
     }
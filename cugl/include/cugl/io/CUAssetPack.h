@@ -0,0 +1,308 @@
+//
+//  CUAssetPack.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a packed asset archive.  Instead of
+//  shipping hundreds of loose files in the asset directory, an application
+//  may ship a single pack file with a hashed index.  Each entry in the pack
+//  is aligned and may optionally be compressed.
+//
+//  Packs are mounted globally.  Once a pack is mounted, every asset loader
+//  that opens files through openAsset() will find the packed entry first,
+//  and fall back to the loose file in the asset directory otherwise.  So
+//  mounting a pack is transparent to the rest of the engine.
+//
+//  Where the platform allows it, the pack is memory mapped, so uncompressed
+//  entries are read with no copies at all.  On platforms without a proper
+//  file system (e.g. Android, where assets live in the APK) the pack is read
+//  through a single SDL_RWops instead.
+//
+//  The pack format is produced by the script tooling/pack-assets.py.  All
+//  integers are stored little-endian.
+//
+//      Header (24 bytes):  magic, version, flags, count, names size, reserved
+//      Index (32 bytes per entry, sorted by hash):
+//          hash (8), offset (8), size (4), stored size (4), flags (4), name (4)
+//      Names: null-terminated relative paths, for collision checks
+//      Data:  entries, each aligned to ALIGNMENT bytes
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_ASSET_PACK_H__
+#define __CU_ASSET_PACK_H__
+#include <SDL/SDL.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Asset Pack
+
+/**
+ * This class represents a read-only archive of assets.
+ *
+ * An asset pack is a single file containing many assets, together with an
+ * index keyed on the hash of each asset path (relative to the asset directory).
+ * Looking up an entry is a binary search over the index, and opening it
+ * returns an SDL_RWops that can be passed to any SDL-based loader.
+ *
+ * Most of the time you will not use an instance of this class directly.
+ * Instead, call {@link mount} once at startup and let {@link openAsset} find
+ * the asset, either in a mounted pack or as a loose file.  All of the CUGL
+ * asset loaders and readers use {@link openAsset}.
+ *
+ * Opening an entry is thread-safe, so packs may be used by the asynchronous
+ * asset loaders.  However, {@link mount} and {@link unmountAll} should only
+ * be called when no loading is taking place.
+ */
+class AssetPack {
+public:
+    /** The magic number at the start of each pack ("CUPK") */
+    static const Uint32 MAGIC = 0x4B505543;
+    /** The current pack version */
+    static const Uint16 VERSION = 1;
+    /** The alignment (in bytes) of each entry in the pack */
+    static const Uint32 ALIGNMENT = 16;
+    /** The entry flag for an LZ4-compressed entry */
+    static const Uint32 COMPRESSED = 1;
+
+private:
+    /** An entry in the pack index */
+    struct Entry {
+        /** The hash of the entry path */
+        Uint64 hash;
+        /** The offset of the entry data from the start of the pack */
+        Uint64 offset;
+        /** The uncompressed size of the entry */
+        Uint32 size;
+        /** The stored (possibly compressed) size of the entry */
+        Uint32 stored;
+        /** The entry flags */
+        Uint32 flags;
+        /** The offset of the entry path in the name table */
+        Uint32 name;
+    };
+
+    /** The name of the pack file */
+    std::string _name;
+    /** The pack index, sorted by hash */
+    std::vector<Entry> _index;
+    /** The table of entry names */
+    std::vector<char> _names;
+
+    /** The memory mapped pack (or nullptr if not mapped) */
+    const Uint8* _mapped;
+    /** The size of the mapped region */
+    size_t _mapsize;
+    /** The platform handle for the mapping */
+    intptr_t _handle;
+    /** The underlying stream, when the pack is not mapped */
+    SDL_RWops* _source;
+    /** Mutex guarding access to the underlying stream */
+    std::mutex _mutex;
+
+    /**
+     * Returns the index entry for the given path, or nullptr if not present.
+     *
+     * @param path  The path relative to the asset directory
+     *
+     * @return the index entry for the given path, or nullptr if not present.
+     */
+    const Entry* find(const std::string& path) const;
+
+    /**
+     * Returns true if the pack could be memory mapped.
+     *
+     * @param path  The full path to the pack file
+     *
+     * @return true if the pack could be memory mapped.
+     */
+    bool map(const std::string& path);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an unmounted asset pack.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AssetPack();
+
+    /**
+     * Deletes this asset pack, releasing all resources.
+     */
+    ~AssetPack() { dispose(); }
+
+    /**
+     * Deletes the asset pack resources and resets all attributes.
+     *
+     * This will unmap the pack and close any underlying stream.  Any
+     * SDL_RWops previously returned by {@link open} remain valid only if the
+     * entry was copied out (e.g. the pack was not mapped or the entry was
+     * compressed).  Hence you should only dispose a pack after loading.
+     */
+    void dispose();
+
+    /**
+     * Initializes an asset pack from the given file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application asset directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  The relative path to the pack
+     *
+     * @return true if the pack is initialized properly, false otherwise.
+     */
+    bool init(const std::string& file);
+
+    /**
+     * Returns a newly allocated asset pack for the given file.
+     *
+     * This method assumes that the file name is a relative path. It will
+     * search the application asset directory {@see Application#getAssetDirectory()}
+     * for the file and return nullptr if it cannot find it there.
+     *
+     * @param file  The relative path to the pack
+     *
+     * @return a newly allocated asset pack for the given file.
+     */
+    static std::shared_ptr<AssetPack> alloc(const std::string& file) {
+        std::shared_ptr<AssetPack> result = std::make_shared<AssetPack>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+#pragma mark Entry Access
+    /**
+     * Returns the number of entries in this pack
+     *
+     * @return the number of entries in this pack
+     */
+    size_t size() const { return _index.size(); }
+
+    /**
+     * Returns true if this pack is memory mapped
+     *
+     * @return true if this pack is memory mapped
+     */
+    bool isMapped() const { return _mapped != nullptr; }
+
+    /**
+     * Returns true if this pack contains the given path
+     *
+     * @param path  The path relative to the asset directory
+     *
+     * @return true if this pack contains the given path
+     */
+    bool contains(const std::string& path) const { return find(path) != nullptr; }
+
+    /**
+     * Returns a read-only stream for the given path, or nullptr if not present.
+     *
+     * The stream is owned by the caller and should be closed with SDL_RWclose
+     * (or passed to an SDL function that frees its source).  Uncompressed
+     * entries of a mapped pack are read in place; all other entries are copied
+     * into a buffer owned by the stream.
+     *
+     * @param path  The path relative to the asset directory
+     *
+     * @return a read-only stream for the given path, or nullptr if not present.
+     */
+    SDL_RWops* open(const std::string& path);
+
+#pragma mark Global Mounting
+    /**
+     * Mounts the given pack so that {@link openAsset} will search it.
+     *
+     * The file is a path relative to the asset directory.  Packs are searched
+     * in the order they are mounted.  This method returns false (and mounts
+     * nothing) if the pack does not exist, so it is safe to call when the
+     * application is shipped with loose files instead.
+     *
+     * @param file  The relative path to the pack
+     *
+     * @return true if the pack was successfully mounted
+     */
+    static bool mount(const std::string& file);
+
+    /**
+     * Unmounts all asset packs.
+     */
+    static void unmountAll();
+
+    /**
+     * Returns a stream for the given file, searching any mounted packs first.
+     *
+     * The file may either be an absolute path inside the asset directory, or
+     * a path relative to it.  If no mounted pack contains the file, or if the
+     * mode is not a read mode, this falls back to SDL_RWFromFile.
+     *
+     * @param file  The path to the file
+     * @param mode  The SDL_RWFromFile mode string
+     *
+     * @return a stream for the given file, or nullptr if it cannot be found.
+     */
+    static SDL_RWops* openAsset(const std::string& file, const char* mode);
+
+#pragma mark Utilities
+    /**
+     * Returns the 64-bit FNV-1a hash of the given path.
+     *
+     * The path is normalized so that backslashes hash as forward slashes.
+     *
+     * @param path  The path relative to the asset directory
+     *
+     * @return the 64-bit FNV-1a hash of the given path.
+     */
+    static Uint64 hash(const std::string& path);
+
+    /**
+     * Decompresses an LZ4 block into the given buffer.
+     *
+     * The buffer must be large enough to hold the uncompressed data.  This
+     * method returns 0 if the block is malformed.
+     *
+     * @param src       The compressed block
+     * @param srclen    The compressed size
+     * @param dst       The output buffer
+     * @param dstlen    The capacity of the output buffer
+     *
+     * @return the number of bytes written to dst
+     */
+    static size_t decompress(const Uint8* src, size_t srclen, Uint8* dst, size_t dstlen);
+};
+
+}
+#endif /* __CU_ASSET_PACK_H__ */
@@ -35,5 +35,6 @@
 #include "CUJsonWriter.h"
 #include "CUBinaryReader.h"
 #include "CUBinaryWriter.h"
+#include "CUAssetPack.h"
 
 #endif /* __CU_IO_PKG_H__ */
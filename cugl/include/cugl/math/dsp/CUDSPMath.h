@@ -125,6 +125,45 @@ public:
      */
     static size_t scale_add(float* input1, float* input2, float scalar, float* output, size_t size);
     
+#pragma mark Panning Methods
+    /**
+     * Spreads a mono input signal into an interleaved stereo output
+     *
+     * Each input sample is multiplied by left for the left channel and by
+     * right for the right channel.  The output is overwritten, not added to.
+     *
+     * The output buffer must hold 2*frames elements. It may not be the same
+     * as the input buffer.
+     *
+     * @param input     The input buffer (mono)
+     * @param left      The left channel gain
+     * @param right     The right channel gain
+     * @param output    The output buffer (interleaved stereo)
+     * @param frames    The number of frames to process
+     *
+     * @return the number of frames successfully processed
+     */
+    static size_t pan_mono(float* input, float left, float right, float* output, size_t frames);
+
+    /**
+     * Mixes an interleaved stereo signal through a 2x2 gain matrix
+     *
+     * The matrix is stored by input channel, so that matrix[2*ii+jj] is the
+     * amount of input channel ii sent to output channel jj. This is the same
+     * layout as the channel mapping of {@link AudioPanner}. The output is
+     * overwritten, not added to.
+     *
+     * It is safe for output to be the same as the input buffer.
+     *
+     * @param input     The input buffer (interleaved stereo)
+     * @param matrix    The 2x2 gain matrix
+     * @param output    The output buffer (interleaved stereo)
+     * @param frames    The number of frames to process
+     *
+     * @return the number of frames successfully processed
+     */
+    static size_t pan_stereo(float* input, float* matrix, float* output, size_t frames);
+    
 #pragma mark Fade-In/Out Methods
     /**
      * Scales an input signal, storing the result in output
@@ -0,0 +1,321 @@
+//
+//  CULockFreeQueue.h
+//  Cornell University Game Library (CUGL)
+//
+//  This header provides a template for a bounded, lock-free queue.  The queue
+//  is designed for exactly one producer thread and one consumer thread (e.g.
+//  the main thread and the audio thread).  Neither side ever blocks on the
+//  other; instead, pushing to a full queue or popping from an empty queue
+//  simply fails.  This makes it safe to use from real-time threads, such as
+//  the audio callback, where taking a lock can cause an underrun.
+//
+//  All storage is preallocated when the queue is initialized, so neither push
+//  nor pop will allocate memory (beyond what the copy of T itself requires).
+//  Elements may also be filled and read in place, so that an element which
+//  owns memory (e.g. a vector) keeps it from one use of its slot to the next.
+//
+//  This is not a class. It is a class template. Templates do not have cpp
+//  files. They only have a header file.  When you include the header, it
+//  compiles the specific template used by your program. Hence all of the code
+//  for this templated class is in this header.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_LOCK_FREE_QUEUE_H__
+#define __CU_LOCK_FREE_QUEUE_H__
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cugl/util/CUDebug.h>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark LockFreeQueue Template
+
+/**
+ * Template for a bounded single-producer, single-consumer queue
+ *
+ * This queue is a ring buffer whose capacity is rounded up to a power of two.
+ * The head (consumer) and tail (producer) indices are kept on separate cache
+ * lines so that the two threads do not contend with one another.
+ *
+ * The methods {@link push}, {@link prepare}, {@link commit} and {@link full}
+ * may only be called by the producer thread, while {@link pop} and
+ * {@link peek} may only be called by the consumer thread.  The methods {@link size} and {@link isEmpty} may be called
+ * by either, but the result is only a snapshot.
+ *
+ * The element type must be default constructible and move assignable.  When
+ * an element is popped into a value, its slot is reset to a default value, so
+ * that any resources it holds (e.g. a shared pointer) are released by the
+ * consumer.  Elements filled with {@link prepare} and read with {@link peek}
+ * are never copied; popping them leaves the slot as it was, for the producer
+ * to reuse.
+ */
+template <class T>
+class LockFreeQueue {
+private:
+    /** The ring buffer storage */
+    T* _buffer;
+    /** The capacity mask (capacity-1) */
+    size_t _mask;
+
+    /** The read position; written only by the consumer */
+    alignas(64) std::atomic<size_t> _head;
+    /** The write position; written only by the producer */
+    alignas(64) std::atomic<size_t> _tail;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a new queue with no capacity.
+     *
+     * You must initialize this queue before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a queue on
+     * the heap, use one of the static constructors instead.
+     */
+    LockFreeQueue() : _buffer(nullptr), _mask(0), _head(0), _tail(0) { }
+
+    /**
+     * Deletes this queue, releasing all memory.
+     */
+    ~LockFreeQueue() { dispose(); }
+
+    /**
+     * Disposes this queue, releasing all memory.
+     *
+     * This method is not thread-safe.  Neither the producer nor the consumer
+     * may be using the queue when it is disposed.
+     */
+    void dispose() {
+        if (_buffer != nullptr) {
+            delete[] _buffer;
+            _buffer = nullptr;
+        }
+        _mask = 0;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Initializes a queue with (at least) the given capacity.
+     *
+     * The capacity is rounded up to the nearest power of two.
+     *
+     * @param  capacity the minimum number of elements the queue can hold
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(size_t capacity) {
+        CUAssertLog(capacity, "A lock-free queue must have non-zero capacity");
+        CUAssertLog(_buffer == nullptr, "The queue is already initialized");
+        size_t actual = 1;
+        while (actual < capacity) {
+            actual <<= 1;
+        }
+        _buffer = new T[actual];
+        _mask = actual-1;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        return _buffer != nullptr;
+    }
+
+    /**
+     * Returns a newly allocated queue with (at least) the given capacity.
+     *
+     * The capacity is rounded up to the nearest power of two.
+     *
+     * @param  capacity the minimum number of elements the queue can hold
+     *
+     * @return a newly allocated queue with (at least) the given capacity.
+     */
+    static std::shared_ptr<LockFreeQueue<T>> alloc(size_t capacity) {
+        std::shared_ptr<LockFreeQueue<T>> result = std::make_shared<LockFreeQueue<T>>();
+        return (result->init(capacity) ? result : nullptr);
+    }
+
+#pragma mark Producer Methods
+    /**
+     * Returns true if the element was added to the end of the queue.
+     *
+     * PRODUCER THREAD ONLY.  If the queue is full, this method does nothing
+     * and returns false.  It never blocks.
+     *
+     * @param value The element to add
+     *
+     * @return true if the element was added to the end of the queue.
+     */
+    bool push(const T& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail-_head.load(std::memory_order_acquire) > _mask) {
+            return false;
+        }
+        _buffer[tail & _mask] = value;
+        _tail.store(tail+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns true if the element was moved to the end of the queue.
+     *
+     * PRODUCER THREAD ONLY.  If the queue is full, this method does nothing
+     * (the value is not moved) and returns false.  It never blocks.
+     *
+     * @param value The element to add
+     *
+     * @return true if the element was moved to the end of the queue.
+     */
+    bool push(T&& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail-_head.load(std::memory_order_acquire) > _mask) {
+            return false;
+        }
+        _buffer[tail & _mask] = std::move(value);
+        _tail.store(tail+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns a pointer to the slot for the next element, or nullptr if full.
+     *
+     * PRODUCER THREAD ONLY.  The slot still holds whatever element last used
+     * it, to be overwritten in place.  The element is not added to the queue
+     * until a call to {@link commit}.  It never blocks.
+     *
+     * @return a pointer to the slot for the next element, or nullptr if full.
+     */
+    T* prepare() {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail-_head.load(std::memory_order_acquire) > _mask) {
+            return nullptr;
+        }
+        return _buffer+(tail & _mask);
+    }
+
+    /**
+     * Adds the element filled in by the last call to {@link prepare}.
+     *
+     * PRODUCER THREAD ONLY.  This method may only be called once for each
+     * call to {@link prepare} that did not return nullptr.
+     */
+    void commit() {
+        _tail.store(_tail.load(std::memory_order_relaxed)+1, std::memory_order_release);
+    }
+
+    /**
+     * Returns true if the queue is full.
+     *
+     * PRODUCER THREAD ONLY.  A full queue will reject any call to push.
+     *
+     * @return true if the queue is full.
+     */
+    bool full() const {
+        return _tail.load(std::memory_order_relaxed)-_head.load(std::memory_order_acquire) > _mask;
+    }
+
+#pragma mark Consumer Methods
+    /**
+     * Returns true if an element was removed from the front of the queue.
+     *
+     * CONSUMER THREAD ONLY.  The element is moved into value.  If the queue
+     * is empty, this method does nothing and returns false.
+     *
+     * @param value The element to store the result
+     *
+     * @return true if an element was removed from the front of the queue.
+     */
+    bool pop(T& value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(_buffer[head & _mask]);
+        _buffer[head & _mask] = T();
+        _head.store(head+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns true if the front element was removed, leaving it in place.
+     *
+     * CONSUMER THREAD ONLY.  Unlike the other pop, the slot is not reset,
+     * so the producer can reuse anything the element owns.  Use this after
+     * reading the element through {@link peek}.  If the queue is empty, this
+     * method does nothing and returns false.
+     *
+     * @return true if the front element was removed.
+     */
+    bool pop() {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        _head.store(head+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns a pointer to the front element, or nullptr if empty.
+     *
+     * CONSUMER THREAD ONLY.  The pointer is only valid until the next call
+     * to {@link pop}.
+     *
+     * @return a pointer to the front element, or nullptr if empty.
+     */
+    T* peek() {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return _buffer+(head & _mask);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the number of elements in the queue.
+     *
+     * This value is only a snapshot if the other thread is active.
+     *
+     * @return the number of elements in the queue.
+     */
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire)-_head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns true if the queue has no elements.
+     *
+     * This value is only a snapshot if the other thread is active.
+     *
+     * @return true if the queue has no elements.
+     */
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * Returns the maximum number of elements in the queue.
+     *
+     * @return the maximum number of elements in the queue.
+     */
+    size_t capacity() const { return _buffer == nullptr ? 0 : _mask+1; }
+};
+
+}
+#endif /* __CU_LOCK_FREE_QUEUE_H__ */
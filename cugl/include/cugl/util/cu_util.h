@@ -34,6 +34,7 @@
 #include "CUTimestamp.h"
 #include "CUFreeList.h"
 #include "CUGreedyFreeList.h"
+#include "CULockFreeQueue.h"
 #include "CUThreadPool.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
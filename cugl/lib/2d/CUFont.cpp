@@ -45,6 +45,7 @@
 
 #include <cugl/renderer/CUTexture.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/io/CUAssetPack.h>
 #include <cugl/2d/CUFont.h>
 #include <algorithm>
 #include <utf8/utf8.h>
@@ -127,7 +128,7 @@ bool Font::init(const std::string& file, int size) {
         CUAssertLog(false,"Font %s already loaded", _name.c_str());
         return false;
     }
-    _data = TTF_OpenFont(file.c_str(), size);
+    _data = TTF_OpenFontRW(AssetPack::openAsset(file, "rb"), 1, size);
     if (_data == nullptr) {
         CUAssertLog(false, "Font initialization error: %s", TTF_GetError());
         return false;
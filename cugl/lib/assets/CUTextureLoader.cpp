@@ -45,6 +45,7 @@
 //
 #include <cugl/assets/CUTextureLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/io/CUAssetPack.h>
 #include <SDL/SDL_image.h>
 
 using namespace cugl;
@@ -167,7 +168,8 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
     
     std::string path = Application::get()->getAssetDirectory();
     path.append(source);
-    SDL_Surface* surface = IMG_Load(path.c_str());
+    const char* ext = strrchr(source.c_str(),'.');
+    SDL_Surface* surface = IMG_LoadTyped_RW(AssetPack::openAsset(path,"rb"), 1, ext ? ext+1 : nullptr);
     if (surface == nullptr) {
         return nullptr;
     }
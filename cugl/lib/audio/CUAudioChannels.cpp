@@ -43,6 +43,7 @@
 //  Version: 12/20/18
 //
 #include <cugl/cugl.h>
+#include <cugl/util/CULockFreeQueue.h>
 #include <algorithm>
 
 using namespace cugl;
@@ -50,11 +51,170 @@ using namespace cugl::audio;
 
 /** The default number of slots */
 #define DEFAULT_SLOTSIZE    24
+/** The number of pending channel commands per slot */
+#define COMMANDS_PER_SLOT   8
+/** The maximum number of recycled players kept for a single sample */
+#define PLAYERS_PER_SAMPLE  4
 
 /** Reference to the sound engine singleton */
 AudioChannels* AudioChannels::_gEngine = nullptr;
 
 
+#pragma mark -
+#pragma mark Command Relay
+/**
+ * A pass-through node that applies queued channel commands
+ *
+ * This node sits between the mixer and the output device.  At the start of
+ * every render, the audio thread drains the command queue before reading the
+ * mixer.  As the commands run in the audio thread, any locks they take (e.g.
+ * in AudioFader) are never contended, and the main thread never waits on the
+ * audio callback.
+ *
+ * The main thread is the only producer, and the audio thread the only
+ * consumer, so the queue needs no locks.
+ */
+class AudioChannels::CommandRelay : public AudioNode {
+public:
+	/** The channel commands */
+	enum class Op : Uint8 {
+		/** Play the node on the channel */
+		PLAY,
+		/** Fade out (and stop) the node on the channel */
+		STOP,
+		/** Pause the channel (fading if the time is positive) */
+		PAUSE,
+		/** Resume the channel */
+		RESUME
+	};
+
+	/** A single channel command */
+	struct Command {
+		/** The command type */
+		Op op = Op::PLAY;
+		/** The channel for this command */
+		Uint32 slot = 0;
+		/** The loop count for PLAY */
+		Sint32 loops = 0;
+		/** The fade time for STOP and PAUSE */
+		float fade = 0;
+		/** The effect node for PLAY and STOP */
+		std::shared_ptr<AudioFader> node;
+	};
+
+private:
+	/** The mixer to read from */
+	std::shared_ptr<AudioMixer> _mixer;
+	/** The channel schedulers */
+	std::vector<std::shared_ptr<AudioScheduler>> _channel;
+	/** The channel wrappers for pausing */
+	std::vector<std::shared_ptr<AudioFader>> _chfader;
+	/** The pending commands */
+	LockFreeQueue<Command> _queue;
+
+	/**
+	 * Applies a single command to the mixer graph
+	 *
+	 * AUDIO THREAD ONLY.
+	 *
+	 * @param cmd	The command to apply
+	 */
+	void apply(const Command& cmd) {
+		switch (cmd.op) {
+		case Op::PLAY:
+			_channel[cmd.slot]->play(cmd.node, cmd.loops);
+			break;
+		case Op::STOP:
+			_channel[cmd.slot]->setLoops(0);
+			cmd.node->fadeOut(cmd.fade);
+			break;
+		case Op::PAUSE:
+			if (!_chfader[cmd.slot]->isPaused()) {
+				if (cmd.fade) {
+					_chfader[cmd.slot]->fadePause(cmd.fade);
+				}
+				else {
+					_chfader[cmd.slot]->pause();
+				}
+			}
+			break;
+		case Op::RESUME:
+			if (_chfader[cmd.slot]->isPaused()) {
+				_chfader[cmd.slot]->resume();
+			}
+			break;
+		}
+	}
+
+public:
+	/**
+	 * Initializes a relay for the given mixer graph
+	 *
+	 * @param mixer		The effect mixer
+	 * @param channel	The channel schedulers
+	 * @param chfader	The channel wrappers
+	 * @param capacity	The maximum number of pending commands
+	 *
+	 * @return true if initialization was successful
+	 */
+	bool init(const std::shared_ptr<AudioMixer>& mixer,
+		const std::vector<std::shared_ptr<AudioScheduler>>& channel,
+		const std::vector<std::shared_ptr<AudioFader>>& chfader, size_t capacity) {
+		if (!AudioNode::init(mixer->getChannels(), mixer->getRate())) {
+			return false;
+		}
+		_mixer = mixer;
+		_channel = channel;
+		_chfader = chfader;
+		return _queue.init(capacity);
+	}
+
+	/**
+	 * Disposes the relay, releasing any pending commands
+	 */
+	void dispose() override {
+		_queue.dispose();
+		_channel.clear();
+		_chfader.clear();
+		_mixer = nullptr;
+		AudioNode::dispose();
+	}
+
+	/**
+	 * Returns true if the command was queued
+	 *
+	 * MAIN THREAD ONLY.  This method fails (rather than blocks) if the
+	 * queue is full, such as when the audio device is not running.
+	 *
+	 * @param cmd	The command to queue
+	 *
+	 * @return true if the command was queued
+	 */
+	bool push(Command&& cmd) {
+		return _queue.push(std::move(cmd));
+	}
+
+	/**
+	 * Applies any pending commands and reads from the mixer
+	 *
+	 * AUDIO THREAD ONLY.
+	 *
+	 * @param buffer	The read buffer to store the results
+	 * @param frames	The maximum number of frames to read
+	 *
+	 * @return the actual number of frames read
+	 */
+	Uint32 read(float* buffer, Uint32 frames) override {
+		Command cmd;
+		while (_queue.pop(cmd)) {
+			apply(cmd);
+			cmd.node = nullptr;
+		}
+		return _mixer->read(buffer, frames);
+	}
+};
+
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -137,8 +297,17 @@ bool AudioChannels::init(Uint32 channels) {
 		_pan2Pool.push_back(AudioPanner::alloc(_mixer->getChannels(), 2, _mixer->getRate()));
 	}
 
+	// Every effect channel starts out free
+	for (Uint32 ii = _capacity; ii > 0; ii--) {
+		_chfree.push_back(ii);
+	}
+	_chowner.resize(_capacity + 1, nullptr);
+	_chstop.resize(_capacity + 1, false);
+
 	// Launch and go
-	_output->attach(_mixer);
+	_relay = std::make_shared<CommandRelay>();
+	_relay->init(_mixer, _channel, _chfader, COMMANDS_PER_SLOT * (_capacity + 1));
+	_output->attach(_relay);
 	AudioManager::get()->activate();
 	return true;
 }
@@ -160,14 +329,21 @@ void AudioChannels::dispose() {
 		_fadePool.clear();
 		_pan1Pool.clear();
 		_pan2Pool.clear();
+		_playPool.clear();
 		_capacity = 0;
 
 		_output->detach();
 		_output = nullptr;
+		_relay->dispose();
+		_relay = nullptr;
 		_mixer = nullptr;
 
 		_equeue.clear();
 		_effects.clear();
+		_chfree.clear();
+		_chfade.clear();
+		_chowner.clear();
+		_chstop.clear();
 	}
 }
 
@@ -209,8 +385,12 @@ void AudioChannels::gcMusic(const std::shared_ptr<AudioNode>& node, bool status)
  */
 void AudioChannels::gcEffect(const std::shared_ptr<AudioNode>& node, bool status) {
 	std::string key = node->getName();
+	releaseChannel(node.get());
+	auto it = _effects.find(key);
+	if (it != _effects.end() && it->second == node) {
+		removeKey(key);
+	}
 	std::shared_ptr<Sound> sound = disposeInstance(node);
-	removeKey(key);
 	if (_soundCB) {
 		_soundCB(key, status);
 	}
@@ -237,6 +417,80 @@ void AudioChannels::removeKey(std::string key) {
 	}
 }
 
+/**
+ * Returns an available sound effect channel, or -1 if there is none.
+ *
+ * This method is O(1).  It first takes a channel that is not in use at
+ * all, and then a channel whose effect is already fading out.  If neither
+ * is available and force is true, it will stop the longest playing sound
+ * effect and take its channel.
+ *
+ * @param force Whether to force another sound to stop.
+ *
+ * @return an available sound effect channel, or -1 if there is none.
+ */
+int AudioChannels::acquireChannel(bool force) {
+	if (!_chfree.empty()) {
+		Uint32 slot = _chfree.back();
+		_chfree.pop_back();
+		return slot;
+	}
+
+	// Try again for soon to be deleted; skip entries that are stale
+	while (!_chfade.empty()) {
+		Uint32 slot = _chfade.front();
+		_chfade.pop_front();
+		if (_chowner[slot] != nullptr && _chstop[slot]) {
+			return slot;
+		}
+	}
+
+	if (force && !_equeue.empty()) {
+		std::string altkey = _equeue.front();
+		_equeue.pop_front();
+		int slot = _effects[altkey]->getTag();
+		stopEffect(altkey);
+		return slot;
+	}
+	return -1;
+}
+
+/**
+ * Returns a channel to the free list if it is owned by the given node.
+ *
+ * A channel may be taken from a fading effect before that effect has
+ * finished.  In that case, the channel is not freed when the old effect
+ * is collected.
+ *
+ * @param node  The effect node that finished
+ */
+void AudioChannels::releaseChannel(const AudioNode* node) {
+	Uint32 slot = node->getTag();
+	if (slot < _chowner.size() && _chowner[slot] == node) {
+		_chowner[slot] = nullptr;
+		_chstop[slot] = false;
+		_chfree.push_back(slot);
+	}
+}
+
+/**
+ * Returns a player node for the given sound, recycling one if possible.
+ *
+ * @param asset The sound asset
+ *
+ * @return a player node for the given sound, recycling one if possible.
+ */
+std::shared_ptr<AudioNode> AudioChannels::acquirePlayer(const std::shared_ptr<Sound>& asset) {
+	auto it = _playPool.find(asset.get());
+	if (it != _playPool.end() && !it->second.empty()) {
+		std::shared_ptr<AudioNode> player = it->second.back();
+		it->second.pop_back();
+		player->setGain(asset->getVolume());
+		return player;
+	}
+	return asset->createNode();
+}
+
 /**
  * Returns a playable audio node for a given a sound instance.
  *
@@ -281,7 +535,7 @@ std::shared_ptr<AudioFader> AudioChannels::wrapInstance(const std::shared_ptr<So
 		}
 	}
 	fader->attach(panner);
-	panner->attach(asset->createNode());
+	panner->attach(acquirePlayer(asset));
 	return fader;
 }
 
@@ -328,6 +582,16 @@ std::shared_ptr<Sound> AudioChannels::disposeInstance(const std::shared_ptr<audi
 		if (panner) {
 			std::shared_ptr<AudioNode>   source = panner->getInput();
 			AudioPlayer* player = dynamic_cast<AudioPlayer*>(source.get());
+			if (player) {
+				// Rewind the player so the next play of this sample can reuse it
+				std::vector<std::shared_ptr<AudioNode>>& pool = _playPool[player->getSource().get()];
+				if (pool.size() < PLAYERS_PER_SAMPLE) {
+					player->unmark();
+					player->setPosition(0);
+					player->resume();
+					pool.push_back(source);
+				}
+			}
 			fader->detach();
 			fader->fadeOut(-1);
 			fader->reset();
@@ -1008,35 +1272,11 @@ bool AudioChannels::playEffect(const std::string& key, const std::shared_ptr<Sou
 		}
 	}
 
-	// Find an empty scheduler
-	int audioID = -1;
-	for (auto it = _channel.begin() + 1; audioID == -1 && it != _channel.end(); ++it) {
-		if (!(*it)->isPlaying()) {
-			audioID = (*it)->getTag();
-		}
-	}
-
-	// Try again for soon to be deleted.
-	for (auto it = _effects.begin(); audioID == -1 && it != _effects.end(); ++it) {
-		if (it->second->isFadeOut()) {
-			Uint32 tag = it->second->getTag();
-			if (!_channel[tag]->getTailSize()) {
-				audioID = tag;
-			}
-		}
-	}
-
+	int audioID = acquireChannel(force);
 	if (audioID == -1) {
-		if (force) {
-			std::string altkey = _equeue.front();
-			audioID = _effects[altkey]->getTag();
-			stopEffect(altkey);
-		}
-		else {
-			// Fail if nothing available
-			CULogError("No available sound channels");
-			return false;
-		}
+		// Fail if nothing available
+		CULogError("No available sound channels");
+		return false;
 	}
 
 	std::shared_ptr<AudioFader> fader = wrapInstance(sound);
@@ -1048,7 +1288,23 @@ bool AudioChannels::playEffect(const std::string& key, const std::shared_ptr<Sou
 	}
 	fader->setTag(audioID);
 	fader->setName(key);
-	_channel[audioID]->play(fader, loop ? -1 : 0);
+
+	CommandRelay::Command cmd;
+	cmd.op = CommandRelay::Op::PLAY;
+	cmd.slot = audioID;
+	cmd.loops = loop ? -1 : 0;
+	cmd.node = fader;
+	if (!_relay->push(std::move(cmd))) {
+		// The audio thread is not keeping up (or not running)
+		CULogError("Sound command queue is full");
+		disposeInstance(fader);
+		_chowner[audioID] = fader.get();
+		releaseChannel(fader.get());
+		return false;
+	}
+
+	_chowner[audioID] = fader.get();
+	_chstop[audioID] = false;
 	_effects.emplace(key, fader);
 	_equeue.push_back(key);
 	return true;
@@ -1070,7 +1326,7 @@ AudioChannels::State AudioChannels::getEffectState(const std::string& key) const
 
 	std::shared_ptr<AudioNode> node = _effects.at(key);
 	std::shared_ptr<audio::AudioScheduler> slot = _channel.at(node->getTag());
-	if (!slot->isPlaying()) {
+	if (!slot->isPlaying() && _chowner[node->getTag()] != node.get()) {
 		return State::INACTIVE;
 	}
 	else if (node->isPaused() || slot->isPaused()) {
@@ -1363,9 +1619,21 @@ void AudioChannels::setEffectRemaining(const std::string& key, float time) {
  */
 void AudioChannels::stopEffect(const std::string& key, float fade) {
 	if (_effects.find(key) != _effects.end()) {
-		std::shared_ptr<AudioNode> node = _effects.at(key);
-		_channel[node->getTag()]->setLoops(0);
-		((AudioFader*)node.get())->fadeOut(fade);
+		std::shared_ptr<AudioFader> node = _effects.at(key);
+		Uint32 tag = node->getTag();
+		CommandRelay::Command cmd;
+		cmd.op = CommandRelay::Op::STOP;
+		cmd.slot = tag;
+		cmd.fade = fade;
+		cmd.node = node;
+		if (!_relay->push(std::move(cmd))) {
+			_channel[tag]->setLoops(0);
+			node->fadeOut(fade);
+		}
+		if (_chowner[tag] == node.get() && !_chstop[tag]) {
+			_chstop[tag] = true;
+			_chfade.push_back(tag);
+		}
 	}
 }
 
@@ -1385,14 +1653,18 @@ void AudioChannels::stopEffect(const std::string& key, float fade) {
  */
 void AudioChannels::pauseEffect(const std::string& key, float fade) {
 	if (_effects.find(key) != _effects.end()) {
-		std::shared_ptr<AudioNode> node = _effects.at(key);
 		Uint32 tag = _effects.at(key)->getTag();
-		CUAssertLog(!_chfader.at(tag)->isPaused(), "The sound for that effect is already paused");
-		if (fade) {
-			_chfader.at(tag)->fadePause(fade);
-		}
-		else {
-			_chfader.at(tag)->pause();
+		CommandRelay::Command cmd;
+		cmd.op = CommandRelay::Op::PAUSE;
+		cmd.slot = tag;
+		cmd.fade = fade;
+		if (!_relay->push(std::move(cmd))) {
+			if (fade) {
+				_chfader.at(tag)->fadePause(fade);
+			}
+			else {
+				_chfader.at(tag)->pause();
+			}
 		}
 	}
 }
@@ -1406,10 +1678,13 @@ void AudioChannels::pauseEffect(const std::string& key, float fade) {
  */
 void AudioChannels::resumeEffect(std::string key) {
 	if (_effects.find(key) != _effects.end()) {
-		std::shared_ptr<AudioNode> node = _effects.at(key);
 		Uint32 tag = _effects.at(key)->getTag();
-		CUAssertLog(_chfader.at(tag)->isPaused(), "The sound for that effect is not paused");
-		_chfader.at(tag)->resume();
+		CommandRelay::Command cmd;
+		cmd.op = CommandRelay::Op::RESUME;
+		cmd.slot = tag;
+		if (!_relay->push(std::move(cmd))) {
+			_chfader.at(tag)->resume();
+		}
 	}
 }
 
@@ -1428,7 +1703,7 @@ void AudioChannels::resumeEffect(std::string key) {
  */
 void AudioChannels::stopAllEffects(float fade) {
 	for (auto it = _effects.begin(); it != _effects.end(); ++it) {
-		it->second->fadeOut(fade);
+		stopEffect(it->first, fade);
 	}
 	_effects.clear();
 	_equeue.clear();
@@ -1448,13 +1723,17 @@ void AudioChannels::stopAllEffects(float fade) {
  * @param fade      the number of seconds to fade out
  */
 void AudioChannels::pauseAllEffects(float fade) {
-	for (auto it = _chfader.begin() + 1; it != _chfader.end(); ++it) {
-		if (!(*it)->isPaused()) {
+	for (Uint32 ii = 1; ii <= _capacity; ii++) {
+		CommandRelay::Command cmd;
+		cmd.op = CommandRelay::Op::PAUSE;
+		cmd.slot = ii;
+		cmd.fade = fade;
+		if (!_relay->push(std::move(cmd)) && !_chfader[ii]->isPaused()) {
 			if (fade) {
-				(*it)->fadePause(fade);
+				_chfader[ii]->fadePause(fade);
 			}
 			else {
-				(*it)->pause();
+				_chfader[ii]->pause();
 			}
 		}
 	}
@@ -1464,9 +1743,12 @@ void AudioChannels::pauseAllEffects(float fade) {
  * Resumes all paused sound effects.
  */
 void AudioChannels::resumeAllEffects() {
-	for (auto it = _chfader.begin() + 1; it != _chfader.end(); ++it) {
-		if ((*it)->isPaused()) {
-			(*it)->resume();
+	for (Uint32 ii = 1; ii <= _capacity; ii++) {
+		CommandRelay::Command cmd;
+		cmd.op = CommandRelay::Op::RESUME;
+		cmd.slot = ii;
+		if (!_relay->push(std::move(cmd)) && _chfader[ii]->isPaused()) {
+			_chfader[ii]->resume();
 		}
 	}
 }
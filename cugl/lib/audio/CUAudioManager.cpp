@@ -36,6 +36,7 @@
 #include <cugl/audio/CUAudioManager.h>
 #include <cugl/audio/graph/CUAudioOutput.h>
 #include <cugl/audio/graph/CUAudioInput.h>
+#include <cugl/audio/graph/CUAudioPlayer.h>
 #include <cugl/util/CUDebug.h>
 
 using namespace cugl;
@@ -134,6 +135,7 @@ void AudioManager::dispose() {
         deactivate();
         _outputs.clear();
         _inputs.clear();
+        audio::AudioPlayer::stopReadAhead();
 
 #if CU_PLATFORM == CU_PLATFORM_MACOS
         AudioObjectRemovePropertyListener(kAudioObjectSystemObject, &test_address, device_unplugged, this);
@@ -36,6 +36,7 @@
 //
 #include <cugl/audio/codecs/CUWAVDecoder.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/io/CUAssetPack.h>
 #include <cassert>
 #include <climits>
 
@@ -937,7 +938,7 @@ bool WAVDecoder::bootstrap(const std::string& file) {
     
     SDL_zero(chunk);
     
-    _source = SDL_RWFromFile(file.c_str(),"r");
+    _source = AssetPack::openAsset(file,"r");
      was_error = 0;
     if (_source == NULL) {
         SDL_SetError("'%s' not found",file.c_str());
@@ -235,21 +235,29 @@ std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
  */
 Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
     dsp::DSPMath::VECTORIZE = true;
-    std::memset(buffer,0,frames*_channels*sizeof(float));
+    Uint32 total = frames;
     frames = std::min(frames,_capacity);
+    bool mixed = false;
     if (!_paused.load(std::memory_order_relaxed)) {
+        // Mix straight into the output, applying the gain in the same pass
+        float gain = _ndgain.load(std::memory_order_relaxed);
         std::shared_ptr<AudioNode> temp;
         for(int ii = 0; ii < _width; ii++) {
             temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-            if (temp) {
-                Uint32 amt = temp->read(_buffer,frames);
+            if (temp && !mixed) {
+                Uint32 amt = temp->read(buffer,frames);
                 if (amt < frames) {
-                    std::memset(_buffer+amt,0,(frames-amt)*_channels*sizeof(float));
+                    std::memset(buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
+                }
+                if (gain != 1) {
+                    dsp::DSPMath::scale(buffer,gain,buffer,amt*_channels);
                 }
-                dsp::DSPMath::add(_buffer,buffer,buffer,frames*_channels);
+                mixed = true;
+            } else if (temp) {
+                Uint32 amt = temp->read(_buffer,frames);
+                dsp::DSPMath::scale_add(_buffer,buffer,gain,buffer,amt*_channels);
             }
         }
-        //dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,frames*_channels);
         float knee = _knee.load(std::memory_order_relaxed);
         if (knee == 1) {
             //dsp::DSPMath::clamp(buffer,-1,1,frames*_channels);
@@ -257,6 +265,11 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
             //dsp::DSPMath::ease(buffer,1,knee,frames*_channels);
         }
     }
+    if (!mixed) {
+        std::memset(buffer,0,total*_channels*sizeof(float));
+    } else if (frames < total) {
+        std::memset(buffer+frames*_channels,0,(total-frames)*_channels*sizeof(float));
+    }
     return frames;
 }
 
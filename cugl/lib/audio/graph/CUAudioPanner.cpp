@@ -33,6 +33,7 @@
 //
 #include <cugl/audio/graph/CUAudioPanner.h>
 #include <cugl/audio/CUAudioManager.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
 #include <cmath>
 
@@ -263,23 +264,40 @@ Uint32 AudioPanner::read(float* buffer, Uint32 frames) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
     } else {
         frames = std::min(frames,_capacity);
-        std::memset(buffer,0,frames*_channels*sizeof(float));
         Uint32 amt = input->read(_buffer, frames);
-        for(int ii = 0; ii < _field; ii++) {
-            for(int jj = 0; jj < _channels; jj++) {
-                float percent =  _mapper[ii*_channels+jj].load(std::memory_order_relaxed);
-                if (percent > 0) {
-                    float* output = buffer+jj;
-                    float* input  = _buffer+ii;
-                    Uint32 tmp = amt;
-                    while (tmp--) {
-                        *output += *input*percent;
-                        output += _channels;
-                        input += _field;
+        if (_channels == 2 && _field == 1) {
+            // Mono to stereo is the common case (e.g. sound effects)
+            dsp::DSPMath::pan_mono(_buffer,
+                                   _mapper[0].load(std::memory_order_relaxed),
+                                   _mapper[1].load(std::memory_order_relaxed),
+                                   buffer, amt);
+        } else if (_channels == 2 && _field == 2) {
+            float matrix[4];
+            for(int ii = 0; ii < 4; ii++) {
+                matrix[ii] = _mapper[ii].load(std::memory_order_relaxed);
+            }
+            dsp::DSPMath::pan_stereo(_buffer, matrix, buffer, amt);
+        } else {
+            std::memset(buffer,0,amt*_channels*sizeof(float));
+            for(int ii = 0; ii < _field; ii++) {
+                for(int jj = 0; jj < _channels; jj++) {
+                    float percent =  _mapper[ii*_channels+jj].load(std::memory_order_relaxed);
+                    if (percent > 0) {
+                        float* output = buffer+jj;
+                        float* input  = _buffer+ii;
+                        Uint32 tmp = amt;
+                        while (tmp--) {
+                            *output += *input*percent;
+                            output += _channels;
+                            input += _field;
+                        }
                     }
                 }
             }
         }
+        if (amt < frames) {
+            std::memset(buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
+        }
         return amt;
     }
     return frames;
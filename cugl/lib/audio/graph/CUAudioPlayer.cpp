@@ -44,10 +44,123 @@
 #include <cugl/util/CUTimestamp.h>
 #include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/audio/codecs/cu_codecs.h>
+#include <vector>
 
 using namespace cugl::audio;
 using namespace cugl;
 
+/** The (minimum) number of frames a streamed player decodes ahead */
+const Uint32 AudioPlayer::READ_AHEAD = 16384;
+/** The seek request value indicating that no seek is pending */
+const Uint64 AudioPlayer::NO_SEEK = (Uint64)-1;
+
+/** The number of milliseconds the read-ahead thread sleeps between passes */
+#define READ_AHEAD_SLEEP 4
+
+#pragma mark -
+#pragma mark Read-Ahead Thread
+/** A mutex guarding the read-ahead thread state */
+static std::mutex gStreamMutex;
+/** The streamed players serviced by the read-ahead thread */
+static std::vector<std::weak_ptr<AudioPlayer>> gStreams;
+/** The read-ahead thread (nullptr if never started) */
+static SDL_Thread* gStreamThread = nullptr;
+/** Whether the read-ahead thread is still running */
+static bool gStreamActive = false;
+/** Whether the read-ahead thread has been asked to stop */
+static bool gStreamStop = false;
+
+/**
+ * The body function of the read-ahead thread.
+ *
+ * Each pass tops up the ring of every streamed player.  The thread exits
+ * once there are no players left (or it is asked to stop).
+ *
+ * @param data  Unused
+ *
+ * @return 0 on exit
+ */
+static int streamThreadFunc(void* /*data*/) {
+    std::vector<std::shared_ptr<AudioPlayer>> players;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(gStreamMutex);
+            for(auto it = gStreams.begin(); it != gStreams.end(); ) {
+                std::shared_ptr<AudioPlayer> player = it->lock();
+                if (player) {
+                    players.push_back(player);
+                    ++it;
+                } else {
+                    it = gStreams.erase(it);
+                }
+            }
+            if (players.empty() || gStreamStop) {
+                gStreamActive = false;
+                return 0;
+            }
+        }
+        for(auto it = players.begin(); it != players.end(); ++it) {
+            (*it)->readAhead();
+        }
+        players.clear();
+        SDL_Delay(READ_AHEAD_SLEEP);
+    }
+    return 0;
+}
+
+/**
+ * Adds a player to the read-ahead thread, starting the thread if necessary.
+ *
+ * @param player    The streamed player
+ */
+static void startStream(const std::shared_ptr<AudioPlayer>& player) {
+    std::lock_guard<std::mutex> lock(gStreamMutex);
+    bool found = false;
+    for(auto it = gStreams.begin(); !found && it != gStreams.end(); ++it) {
+        found = !it->owner_before(player) && !player.owner_before(*it);
+    }
+    if (!found) {
+        gStreams.push_back(player);
+    }
+    if (!gStreamActive) {
+        if (gStreamThread != nullptr) {
+            SDL_WaitThread(gStreamThread, nullptr);
+        }
+        gStreamStop = false;
+        gStreamActive = true;
+        gStreamThread = SDL_CreateThread(streamThreadFunc, "CUGL Read-Ahead", nullptr);
+        if (gStreamThread == nullptr) {
+            CULogError("[AUDIO] Could not start the read-ahead thread: %s", SDL_GetError());
+            gStreamActive = false;
+        }
+    }
+}
+
+/**
+ * Stops the read-ahead thread shared by all streamed players.
+ *
+ * This method blocks until the thread exits.  The thread is restarted
+ * automatically the next time a streamed player is initialized.  It is
+ * called when the audio manager is stopped.
+ */
+void AudioPlayer::stopReadAhead() {
+    SDL_Thread* thread = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(gStreamMutex);
+        gStreamStop = true;
+        thread = gStreamThread;
+        gStreamThread = nullptr;
+    }
+    if (thread != nullptr) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    std::lock_guard<std::mutex> lock(gStreamMutex);
+    gStreams.clear();
+    gStreamActive = false;
+}
+
+#pragma mark -
+
 #pragma mark Constructors
 /**
  * Creates a degenerate audio player with no associated source.
@@ -62,10 +175,14 @@ _buffer(nullptr),
 _decoder(nullptr),
 _source(nullptr),
 _chunker(nullptr),
-_chklimt(0),
-_chklast(0),
 _chksize(0),
-_dirty(false) {
+_chkpages(0),
+_pgstart(nullptr),
+_pglimit(nullptr),
+_chkpage(-1),
+_asked(NO_SEEK),
+_seekpage(NO_SEEK),
+_nextpage(0) {
     _classname = "AudioPlayer";
 }
 
@@ -83,18 +200,36 @@ bool AudioPlayer::init(const std::shared_ptr<AudioSample>& source) {
     if (AudioNode::init(source->getChannels(),source->getRate())) {
         _source = source;
         _buffer = source->getBuffer();
-        _dirty  = false;
         
         // TODO: Require manager active and access buffer from it.
         _decoder = source->getDecoder();
-        if (source->isStreamed() && _decoder != nullptr) {
+        if (!source->isStreamed() || _decoder == nullptr) {
+            return true;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(_pgmutex);
             Uint32 channels = _decoder->getChannels();
             _chksize  = _decoder->getPageSize();
-            _chklimt  = _chksize;
-            _chklast  = _chksize;
-            _chunker  = (float*)malloc(_chksize*channels*sizeof(float));
-            std::memset(_chunker,0,_chksize*channels*sizeof(float));
+            _chkpages = std::max(4u,(READ_AHEAD+_chksize-1)/_chksize);
+            _chunker  = (float*)malloc(_chkpages*_chksize*channels*sizeof(float));
+            _pgstart  = (Uint64*)malloc(_chkpages*sizeof(Uint64));
+            _pglimit  = (Uint32*)malloc(_chkpages*sizeof(Uint32));
+            _filled.init(_chkpages);
+            _empty.init(_chkpages);
+            for(Uint32 ii = 0; ii < _chkpages; ii++) {
+                _empty.push(ii);
+            }
+            _chkpage  = -1;
+            _asked    = NO_SEEK;
+            _nextpage = 0;
+            _seekpage.store(NO_SEEK);
+            _decoder->setPage(0);
         }
+
+        // Prime the ring so playback can start immediately
+        readAhead();
+        startStream(std::dynamic_pointer_cast<AudioPlayer>(shared_from_this()));
         return true;
     }
     return false;
@@ -108,6 +243,7 @@ bool AudioPlayer::init(const std::shared_ptr<AudioSample>& source) {
  */
 void AudioPlayer::dispose() {
     if (_booted) {
+        std::lock_guard<std::mutex> lock(_pgmutex);
         AudioNode::dispose();
         _source = nullptr;
         _decoder = nullptr;
@@ -116,13 +252,26 @@ void AudioPlayer::dispose() {
         _buffer  = nullptr;
         _calling.store(false);
         _callback = nullptr;
-        _chksize = 0;
-        _chklimt = 0;
-        _chklast = 0;
+        _chksize  = 0;
+        _chkpages = 0;
+        _chkpage  = -1;
+        _asked    = NO_SEEK;
+        _nextpage = 0;
+        _seekpage.store(NO_SEEK);
+        _filled.dispose();
+        _empty.dispose();
         if (_chunker) {
             free(_chunker);
             _chunker = nullptr;
         }
+        if (_pgstart) {
+            free(_pgstart);
+            _pgstart = nullptr;
+        }
+        if (_pglimit) {
+            free(_pglimit);
+            _pglimit = nullptr;
+        }
     }
 }
 
@@ -165,36 +314,41 @@ Uint32 AudioPlayer::read(float* buffer, Uint32 frames) {
     
         amt = (Uint32)(off+amt > _source->getLength() ? _source->getLength()-off : amt);
         std::memcpy(buffer,input,sizeof(float)*amt*_source->getChannels());
-    } else {
-        if (_dirty.load(std::memory_order_acquire)) {
-            scan(off);
-            _dirty.store(false,std::memory_order_relaxed);
-        }
-        
+    } else if (_chunker) {
         Uint32 remnant  = frames;
         Uint32 channels = _decoder->getChannels();
+        Uint64 length   = _source->getLength();
+        Uint64 pos = off;
         bool okay = true;
-        while (okay && remnant) {
-            if (_chklast >= _chklimt) {
-                _chklimt = _decoder->pagein(_chunker);
-                _chklast = 0;
-            }
-            Uint32 avail = std::min((_chklimt-_chklast),remnant);
-            if (avail == 0) {
+        while (okay && remnant && pos < length) {
+            if (!acquirePage(pos)) {
                 okay = false;
             } else {
-                std::memcpy(buffer+(frames-remnant)*channels, _chunker+_chklast*channels, avail*channels*sizeof(float));
-                remnant  -= avail;
-                _chklast += avail;
+                Uint64 start = _pgstart[_chkpage];
+                Uint32 avail = (Uint32)std::min(start+_pglimit[_chkpage]-pos,(Uint64)remnant);
+                float* input = _chunker+((Uint64)_chkpage*_chksize+(pos-start))*channels;
+                std::memcpy(buffer+(frames-remnant)*channels, input, avail*channels*sizeof(float));
+                remnant -= avail;
+                pos += avail;
             }
         }
         amt -= remnant;
+        
+        // Never block on the decoder; fill any underrun with silence
+        if (!okay) {
+            std::memset(buffer+amt*channels,0,remnant*channels*sizeof(float));
+        }
+        dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,amt*_channels);
+        _offset.store(off+amt,std::memory_order_release);
+        _polling.store(false);
+        return okay ? amt : frames;
+    } else {
+        amt = 0;
     }
 
     dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,amt*_channels);
     _offset.store(off+amt,std::memory_order_release);
     _polling.store(false);
-    Timestamp end;
     return amt;
 }
 
@@ -247,7 +401,6 @@ bool AudioPlayer::unmark() {
  */
 bool AudioPlayer::reset() {
     _offset.store(_marked.load(std::memory_order_relaxed),std::memory_order_relaxed);
-    _dirty.store(true);
     return true;
 }
 
@@ -281,7 +434,6 @@ Sint64 AudioPlayer::advance(Uint32 frames) {
 Sint64 AudioPlayer::setPosition(Uint32 position) {
     Uint64 off  = position > _source->getLength() ? _source->getLength() : position;
     _offset.store(off, std::memory_order_release);
-    _dirty.store(true);
     return off;
 }
 
@@ -319,7 +471,6 @@ double AudioPlayer::setElapsed(double time) {
         result = off/_source->getRate();
     }
     _offset.store(off, std::memory_order_relaxed);
-    _dirty.store(true);
     return result;
 }
 
@@ -372,7 +523,6 @@ double AudioPlayer::setRemaining(double time) {
         result = (_source->getLength()-off)/_source->getRate();
     }
     _offset.store(off, std::memory_order_relaxed);
-    _dirty.store(true);
     return result;
 }
 
@@ -380,20 +530,98 @@ double AudioPlayer::setRemaining(double time) {
 #pragma mark -
 #pragma mark Stream Decoding
 /**
- * Decodes the audio stream up to the given position.
+ * Decodes pages into the read-ahead ring until it is full.
+ *
+ * READ-AHEAD THREAD ONLY: Users should never access this method directly.
+ * It is called by the read-ahead thread, and once when the player is
+ * initialized to prime the ring.
+ *
+ * Pages are decoded in stream order, starting at any seek requested by
+ * the audio thread.  When the decoder reaches the end of the stream, it
+ * continues from the marked position so that a looping player never
+ * waits on the decoder.  Unused pages are simply discarded.
+ */
+void AudioPlayer::readAhead() {
+    std::lock_guard<std::mutex> lock(_pgmutex);
+    if (_decoder == nullptr || _chunker == nullptr) {
+        return;
+    }
+    
+    Uint32 channels = _decoder->getChannels();
+    Uint64 length   = _source->getLength();
+    Uint32* index;
+    while ((index = _empty.peek()) != nullptr) {
+        Uint64 seek = _seekpage.exchange(NO_SEEK,std::memory_order_acq_rel);
+        if (seek != NO_SEEK && seek != _nextpage) {
+            _nextpage = seek;
+            _decoder->setPage(seek);
+        }
+        
+        bool wrapped = false;
+        if (_nextpage*_chksize >= length) {
+            _nextpage = _marked.load(std::memory_order_relaxed)/_chksize;
+            _decoder->setPage(_nextpage);
+            wrapped = true;
+        }
+        
+        Sint32 amt = _decoder->pagein(_chunker+(Uint64)(*index)*_chksize*channels);
+        if (amt <= 0 && !wrapped) {
+            // The stream was shorter than reported; loop around next time
+            _nextpage = _marked.load(std::memory_order_relaxed)/_chksize;
+            _decoder->setPage(_nextpage);
+            amt = _decoder->pagein(_chunker+(Uint64)(*index)*_chksize*channels);
+        }
+        if (amt <= 0) {
+            return;
+        }
+        
+        Uint32 page = *index;
+        _pgstart[page] = _nextpage*_chksize;
+        _pglimit[page] = (Uint32)amt;
+        _nextpage++;
+        _empty.pop(page);
+        _filled.push(page);
+    }
+}
+
+/**
+ * Returns true if the audio thread found a page containing the frame.
  *
  * AUDIO THREAD ONLY: Users should never access this method directly.
- * The only exception is when the user needs to create a custom subclass
- * of this AudioNode.
  *
- * If the frame is longer than the stream length, it goes to the end of
- * the stream.
+ * Pages that do not contain the frame are returned to the read-ahead
+ * thread.  If no decoded page contains it, this method asks the read-ahead
+ * thread to seek to it and returns false.
  *
- * @param frame    The absolute frame to skip to
+ * @param frame    The absolute frame to read
+ *
+ * @return true if the audio thread found a page containing the frame.
  */
-void AudioPlayer::scan(Uint64 frame) {
-    Uint32 page = (Uint32)(frame/_chksize);
-    _decoder->setPage(page);
-    _chklimt = (Uint32)_decoder->pagein(_chunker);
-    _chklast = (Uint32)(_chklimt == 0 ? _chksize : frame % _chksize);
+bool AudioPlayer::acquirePage(Uint64 frame) {
+    if (_chkpage >= 0) {
+        Uint64 start = _pgstart[_chkpage];
+        if (frame >= start && frame < start+_pglimit[_chkpage]) {
+            return true;
+        }
+        _empty.push((Uint32)_chkpage);
+        _chkpage = -1;
+    }
+    
+    Uint32 page;
+    while (_filled.pop(page)) {
+        Uint64 start = _pgstart[page];
+        if (frame >= start && frame < start+_pglimit[page]) {
+            _chkpage = (Sint32)page;
+            _asked = NO_SEEK;
+            return true;
+        }
+        _empty.push(page);
+    }
+    
+    Uint64 want = frame/_chksize;
+    if (_asked != want) {
+        _asked = want;
+        _seekpage.store(want,std::memory_order_release);
+    }
+    return false;
 }
@@ -246,7 +246,8 @@ Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
         if (_resampler != NULL) {
             bool search = true;
             while (take < frames && search) {
-                Sint32 amt = std::ceil(frames*_cvtratio);
+                // Only pull as much input as is needed for the remaining frames
+                Sint32 amt = std::ceil((frames-take)*_cvtratio);
                 amt = input->read(_cvtbuffer, amt);
                 SDL_AudioStreamPut(_resampler, _cvtbuffer, amt*sizeof(float)*_channels);
                 amt  = SDL_AudioStreamGet(_resampler, buffer+take*_channels,
@@ -258,14 +259,17 @@ Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
                 } else if (amt == 0) {
                     search = false;
                 } else {
-                    take += amt/sizeof(float)*_channels;
+                    take += amt/(sizeof(float)*_channels);
                 }
             }
         } else {
             take = input->read(buffer, frames);
         }
         
-        dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,take*_channels);
+        float gain = _ndgain.load(std::memory_order_relaxed);
+        if (gain != 1) {
+            dsp::DSPMath::scale(buffer,gain,buffer,take*_channels);
+        }
         return take;
     }
     return frames;
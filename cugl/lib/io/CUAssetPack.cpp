@@ -0,0 +1,564 @@
+//
+//  CUAssetPack.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a packed asset archive.  Instead of
+//  shipping hundreds of loose files in the asset directory, an application
+//  may ship a single pack file with a hashed index.  Each entry in the pack
+//  is aligned and may optionally be compressed.
+//
+//  Packs are mounted globally.  Once a pack is mounted, every asset loader
+//  that opens files through openAsset() will find the packed entry first,
+//  and fall back to the loose file in the asset directory otherwise.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/io/CUAssetPack.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/base/CUApplication.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined (__WINDOWS__)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#elif !defined (__ANDROID__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    /** Platforms with a proper file system can memory map the pack */
+    #define CU_PACK_MMAP 1
+#endif
+
+using namespace cugl;
+
+/** The size of the pack header in bytes */
+#define HEADER_SIZE 24
+/** The size of a single index entry in bytes */
+#define ENTRY_SIZE  32
+
+/** The FNV-1a 64-bit offset basis */
+#define FNV_OFFSET  0xcbf29ce484222325ULL
+/** The FNV-1a 64-bit prime */
+#define FNV_PRIME   0x100000001b3ULL
+
+/** The packs currently mounted */
+static std::vector<std::shared_ptr<AssetPack>> _mounted;
+
+#pragma mark -
+#pragma mark Stream Helpers
+/**
+ * Closes a memory stream whose buffer is owned by the stream.
+ *
+ * @param context   The stream to close
+ *
+ * @return 0 on success
+ */
+static int SDLCALL closeOwned(SDL_RWops* context) {
+    if (context) {
+        SDL_free(context->hidden.mem.base);
+        SDL_FreeRW(context);
+    }
+    return 0;
+}
+
+/**
+ * Returns a read-only stream that takes ownership of the given buffer.
+ *
+ * The buffer must have been allocated with SDL_malloc.
+ *
+ * @param buffer    The buffer to wrap
+ * @param size      The buffer size
+ *
+ * @return a read-only stream that takes ownership of the given buffer.
+ */
+static SDL_RWops* wrapOwned(Uint8* buffer, size_t size) {
+    SDL_RWops* result = SDL_RWFromConstMem(buffer, (int)size);
+    if (result == nullptr) {
+        SDL_free(buffer);
+        return nullptr;
+    }
+    result->close = closeOwned;
+    return result;
+}
+
+/**
+ * Reads a little-endian 32-bit integer from the given bytes
+ *
+ * @param data  The bytes to read
+ *
+ * @return the decoded integer
+ */
+static Uint32 readLE32(const Uint8* data) {
+    Uint32 result;
+    std::memcpy(&result, data, sizeof(Uint32));
+    return SDL_SwapLE32(result);
+}
+
+/**
+ * Reads a little-endian 64-bit integer from the given bytes
+ *
+ * @param data  The bytes to read
+ *
+ * @return the decoded integer
+ */
+static Uint64 readLE64(const Uint8* data) {
+    Uint64 result;
+    std::memcpy(&result, data, sizeof(Uint64));
+    return SDL_SwapLE64(result);
+}
+
+/**
+ * Returns the given path relative to the asset directory.
+ *
+ * If the path is not inside the asset directory, it is returned unchanged.
+ *
+ * @param path  The path to relativize
+ *
+ * @return the given path relative to the asset directory.
+ */
+static std::string relativize(const std::string& path) {
+    std::string root = Application::get()->getAssetDirectory();
+    if (!root.empty() && path.compare(0, root.size(), root) == 0) {
+        return path.substr(root.size());
+    }
+    return path;
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an unmounted asset pack.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AssetPack::AssetPack() :
+_mapped(nullptr),
+_mapsize(0),
+_handle(-1),
+_source(nullptr) {
+}
+
+/**
+ * Deletes the asset pack resources and resets all attributes.
+ *
+ * This will unmap the pack and close any underlying stream.
+ */
+void AssetPack::dispose() {
+    std::unique_lock<std::mutex> lock(_mutex);
+#if defined (CU_PACK_MMAP)
+    if (_mapped != nullptr) {
+        munmap((void*)_mapped, _mapsize);
+    }
+    if (_handle >= 0) {
+        close((int)_handle);
+    }
+#elif defined (__WINDOWS__)
+    if (_mapped != nullptr) {
+        UnmapViewOfFile(_mapped);
+    }
+    if (_handle != -1) {
+        CloseHandle((HANDLE)_handle);
+    }
+#endif
+    if (_source != nullptr) {
+        SDL_RWclose(_source);
+        _source = nullptr;
+    }
+    _mapped = nullptr;
+    _mapsize = 0;
+    _handle = -1;
+    _index.clear();
+    _names.clear();
+    _name.clear();
+}
+
+/**
+ * Returns true if the pack could be memory mapped.
+ *
+ * @param path  The full path to the pack file
+ *
+ * @return true if the pack could be memory mapped.
+ */
+bool AssetPack::map(const std::string& path) {
+#if defined (CU_PACK_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    _handle  = fd;
+    _mapped  = (const Uint8*)data;
+    _mapsize = (size_t)info.st_size;
+    return true;
+#elif defined (__WINDOWS__)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < HEADER_SIZE) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    _handle  = (intptr_t)mapping;
+    _mapped  = (const Uint8*)data;
+    _mapsize = (size_t)size.QuadPart;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Initializes an asset pack from the given file.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application asset directory for the file and return false if
+ * it cannot find it there.
+ *
+ * @param file  The relative path to the pack
+ *
+ * @return true if the pack is initialized properly, false otherwise.
+ */
+bool AssetPack::init(const std::string& file) {
+    CUAssertLog(_index.empty() && _mapped == nullptr, "Asset pack is already initialized");
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+#if defined (__WINDOWS__)
+    std::replace(_name.begin(), _name.end(), '/', '\\');
+#endif
+
+    // Read the header and index, either from the mapping or the stream
+    Uint8 header[HEADER_SIZE];
+    if (map(_name)) {
+        std::memcpy(header, _mapped, HEADER_SIZE);
+    } else {
+        _source = SDL_RWFromFile(_name.c_str(), "rb");
+        if (_source == nullptr || SDL_RWread(_source, header, HEADER_SIZE, 1) != 1) {
+            dispose();
+            return false;
+        }
+    }
+
+    if (readLE32(header) != MAGIC || readLE32(header+4) != VERSION) {
+        CULogError("File '%s' is not a valid asset pack", file.c_str());
+        dispose();
+        return false;
+    }
+
+    Uint32 count = readLE32(header+12);
+    Uint32 names = readLE32(header+16);
+    size_t tables = (size_t)count*ENTRY_SIZE+names;
+    std::vector<Uint8> buffer;
+    const Uint8* data = nullptr;
+    if (_mapped != nullptr) {
+        if (HEADER_SIZE+tables > _mapsize) {
+            dispose();
+            return false;
+        }
+        data = _mapped+HEADER_SIZE;
+    } else {
+        buffer.resize(tables);
+        if (tables > 0 && SDL_RWread(_source, buffer.data(), tables, 1) != 1) {
+            dispose();
+            return false;
+        }
+        data = buffer.data();
+    }
+
+    _index.resize(count);
+    for(Uint32 ii = 0; ii < count; ii++) {
+        const Uint8* entry = data+ii*ENTRY_SIZE;
+        _index[ii].hash   = readLE64(entry);
+        _index[ii].offset = readLE64(entry+8);
+        _index[ii].size   = readLE32(entry+16);
+        _index[ii].stored = readLE32(entry+20);
+        _index[ii].flags  = readLE32(entry+24);
+        _index[ii].name   = readLE32(entry+28);
+    }
+    _names.assign((const char*)data+count*ENTRY_SIZE, (const char*)data+tables);
+    _names.push_back('\0');
+    return true;
+}
+
+#pragma mark -
+#pragma mark Entry Access
+/**
+ * Returns the index entry for the given path, or nullptr if not present.
+ *
+ * @param path  The path relative to the asset directory
+ *
+ * @return the index entry for the given path, or nullptr if not present.
+ */
+const AssetPack::Entry* AssetPack::find(const std::string& path) const {
+    Uint64 key = hash(path);
+    auto it = std::lower_bound(_index.begin(), _index.end(), key,
+                               [](const Entry& e, Uint64 k) { return e.hash < k; });
+    for(; it != _index.end() && it->hash == key; ++it) {
+        // Verify the name in case of a hash collision
+        const char* name = _names.data()+std::min((size_t)it->name, _names.size()-1);
+        size_t ii = 0;
+        for(; ii < path.size() && name[ii] != '\0'; ii++) {
+            char c = path[ii] == '\\' ? '/' : path[ii];
+            if (c != name[ii]) {
+                break;
+            }
+        }
+        if (ii == path.size() && name[ii] == '\0') {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns a read-only stream for the given path, or nullptr if not present.
+ *
+ * @param path  The path relative to the asset directory
+ *
+ * @return a read-only stream for the given path, or nullptr if not present.
+ */
+SDL_RWops* AssetPack::open(const std::string& path) {
+    const Entry* entry = find(path);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+
+    bool compressed = (entry->flags & COMPRESSED) != 0;
+    if (_mapped != nullptr) {
+        if (entry->offset+entry->stored > _mapsize) {
+            return nullptr;
+        }
+        const Uint8* data = _mapped+entry->offset;
+        if (!compressed) {
+            return SDL_RWFromConstMem(data, (int)entry->size);
+        }
+
+        Uint8* buffer = (Uint8*)SDL_malloc(entry->size);
+        if (decompress(data, entry->stored, buffer, entry->size) != entry->size) {
+            SDL_free(buffer);
+            return nullptr;
+        }
+        return wrapOwned(buffer, entry->size);
+    }
+
+    // Not mapped, so copy the entry out of the stream
+    Uint8* stored = (Uint8*)SDL_malloc(entry->stored);
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_source == nullptr ||
+            SDL_RWseek(_source, (Sint64)entry->offset, RW_SEEK_SET) < 0 ||
+            (entry->stored > 0 && SDL_RWread(_source, stored, entry->stored, 1) != 1)) {
+            SDL_free(stored);
+            return nullptr;
+        }
+    }
+    if (!compressed) {
+        return wrapOwned(stored, entry->size);
+    }
+
+    Uint8* buffer = (Uint8*)SDL_malloc(entry->size);
+    size_t amt = decompress(stored, entry->stored, buffer, entry->size);
+    SDL_free(stored);
+    if (amt != entry->size) {
+        SDL_free(buffer);
+        return nullptr;
+    }
+    return wrapOwned(buffer, entry->size);
+}
+
+#pragma mark -
+#pragma mark Global Mounting
+/**
+ * Mounts the given pack so that {@link openAsset} will search it.
+ *
+ * @param file  The relative path to the pack
+ *
+ * @return true if the pack was successfully mounted
+ */
+bool AssetPack::mount(const std::string& file) {
+    std::shared_ptr<AssetPack> pack = alloc(file);
+    if (pack == nullptr) {
+        return false;
+    }
+    CULog("Mounted asset pack '%s' with %zu entries%s", file.c_str(), pack->size(),
+          pack->isMapped() ? " (mapped)" : "");
+    _mounted.push_back(pack);
+    return true;
+}
+
+/**
+ * Unmounts all asset packs.
+ */
+void AssetPack::unmountAll() {
+    _mounted.clear();
+}
+
+/**
+ * Returns a stream for the given file, searching any mounted packs first.
+ *
+ * @param file  The path to the file
+ * @param mode  The SDL_RWFromFile mode string
+ *
+ * @return a stream for the given file, or nullptr if it cannot be found.
+ */
+SDL_RWops* AssetPack::openAsset(const std::string& file, const char* mode) {
+    if (!_mounted.empty() && mode != nullptr && mode[0] == 'r' && std::strchr(mode, '+') == nullptr) {
+        std::string path = relativize(file);
+        for(auto it = _mounted.begin(); it != _mounted.end(); ++it) {
+            SDL_RWops* result = (*it)->open(path);
+            if (result != nullptr) {
+                return result;
+            }
+        }
+    }
+    return SDL_RWFromFile(file.c_str(), mode);
+}
+
+#pragma mark -
+#pragma mark Utilities
+/**
+ * Returns the 64-bit FNV-1a hash of the given path.
+ *
+ * @param path  The path relative to the asset directory
+ *
+ * @return the 64-bit FNV-1a hash of the given path.
+ */
+Uint64 AssetPack::hash(const std::string& path) {
+    Uint64 result = FNV_OFFSET;
+    for(auto it = path.begin(); it != path.end(); ++it) {
+        char c = *it == '\\' ? '/' : *it;
+        result ^= (Uint8)c;
+        result *= FNV_PRIME;
+    }
+    return result;
+}
+
+/**
+ * Decompresses an LZ4 block into the given buffer.
+ *
+ * @param src       The compressed block
+ * @param srclen    The compressed size
+ * @param dst       The output buffer
+ * @param dstlen    The capacity of the output buffer
+ *
+ * @return the number of bytes written to dst
+ */
+size_t AssetPack::decompress(const Uint8* src, size_t srclen, Uint8* dst, size_t dstlen) {
+    const Uint8* ip = src;
+    const Uint8* iend = src+srclen;
+    Uint8* op = dst;
+    Uint8* oend = dst+dstlen;
+
+    while (ip < iend) {
+        Uint8 token = *ip++;
+
+        // Literals
+        size_t length = token >> 4;
+        if (length == 15) {
+            Uint8 s;
+            do {
+                if (ip >= iend) {
+                    return 0;
+                }
+                s = *ip++;
+                length += s;
+            } while (s == 255);
+        }
+        if (length > (size_t)(iend-ip) || length > (size_t)(oend-op)) {
+            return 0;
+        }
+        std::memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        // The last sequence has no match
+        if (ip >= iend) {
+            break;
+        }
+
+        // Match
+        if (iend-ip < 2) {
+            return 0;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op-dst)) {
+            return 0;
+        }
+        length = token & 15;
+        if (length == 15) {
+            Uint8 s;
+            do {
+                if (ip >= iend) {
+                    return 0;
+                }
+                s = *ip++;
+                length += s;
+            } while (s == 255);
+        }
+        length += 4;
+        if (length > (size_t)(oend-op)) {
+            return 0;
+        }
+
+        // Matches may overlap the output, so copy byte by byte
+        const Uint8* match = op-offset;
+        for(size_t ii = 0; ii < length; ii++) {
+            op[ii] = match[ii];
+        }
+        op += length;
+    }
+    return (size_t)(op-dst);
+}
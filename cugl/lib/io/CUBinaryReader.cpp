@@ -53,6 +53,7 @@
 #include <cugl/io/CUBinaryReader.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/io/CUAssetPack.h>
 #include <cugl/base/CUEndian.h>
 
 using namespace cugl;
@@ -97,7 +98,7 @@ bool BinaryReader::init(const Pathname& file) {
 bool BinaryReader::init(const Pathname& file, unsigned int capacity) {
     CUAssertLog(capacity, "The buffer capacity must be positive");
     _name = file.getAbsoluteName();
-    _stream = SDL_RWFromFile(_name.c_str(), "rb");
+    _stream = AssetPack::openAsset(_name, "rb");
     if (!_stream) {
         return false;
     }
@@ -155,7 +156,7 @@ bool BinaryReader::initWithAsset(const char* file, unsigned int capacity) {
     
     _name = Application::get()->getAssetDirectory();
     _name.append(file);
-    _stream = SDL_RWFromFile(_name.c_str(), "rb");
+    _stream = AssetPack::openAsset(_name, "rb");
     if (!_stream) {
         return false;
     }
@@ -183,7 +184,7 @@ void BinaryReader::reset() {
     if (_stream) {
         close();
     }
-    _stream = SDL_RWFromFile(_name.c_str(), "rb");
+    _stream = AssetPack::openAsset(_name, "rb");
     _ssize  = SDL_RWsize(_stream);
     _buffer = new char[_capacity];
     _bufsize = 0;
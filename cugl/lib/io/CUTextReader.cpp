@@ -49,6 +49,7 @@
 #include <cugl/io/CUTextReader.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/io/CUAssetPack.h>
 #include <utf8/utf8.h>
 #include <cctype>
 
@@ -94,7 +95,7 @@ bool TextReader::init(const Pathname& file) {
 bool TextReader::init(const Pathname& file, unsigned int capacity) {
     CUAssertLog(capacity, "The buffer capacity must be positive");
     _name = file.getAbsoluteName();
-    _stream = SDL_RWFromFile(_name.c_str(), "r");
+    _stream = AssetPack::openAsset(_name, "r");
     if (!_stream) {
         return false;
     }
@@ -160,7 +161,7 @@ bool TextReader::initWithAsset(const char* file, unsigned int capacity) {
 	}
 #endif
 
-    _stream = SDL_RWFromFile(_name.c_str(), "r");
+    _stream = AssetPack::openAsset(_name, "r");
     if (!_stream) {
         return false;
     }
@@ -188,7 +189,7 @@ void TextReader::reset() {
     if (_stream) {
         close();
     }
-    _stream = SDL_RWFromFile(_name.c_str(), "r");
+    _stream = AssetPack::openAsset(_name, "r");
     _ssize  = SDL_RWsize(_stream);
     _cbuffer = new char[_capacity];
     _sbuffer.clear();
@@ -260,6 +260,159 @@ size_t DSPMath::scale_add(float* input1, float* input2, float scalar, float* out
 }
         
         
+#pragma mark -
+#pragma mark Panning Methods
+/**
+ * Spreads a mono input signal into an interleaved stereo output
+ *
+ * Each input sample is multiplied by left for the left channel and by
+ * right for the right channel.  The output is overwritten, not added to.
+ *
+ * The output buffer must hold 2*frames elements. It may not be the same
+ * as the input buffer.
+ *
+ * @param input     The input buffer (mono)
+ * @param left      The left channel gain
+ * @param right     The right channel gain
+ * @param output    The output buffer (interleaved stereo)
+ * @param frames    The number of frames to process
+ *
+ * @return the number of frames successfully processed
+ */
+size_t DSPMath::pan_mono(float* input, float left, float right, float* output, size_t frames) {
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        const __m128 lgain = _mm_set1_ps(left);
+        const __m128 rgain = _mm_set1_ps(right);
+        __m128 data, lchan, rchan;
+        for(int ii = 0; ii < (int)frames-3; ii += 4) {
+            data  = _mm_loadu_ps(input+ii);
+            lchan = _mm_mul_ps(data,lgain);
+            rchan = _mm_mul_ps(data,rgain);
+            _mm_storeu_ps(output+2*ii,  _mm_unpacklo_ps(lchan,rchan));
+            _mm_storeu_ps(output+2*ii+4,_mm_unpackhi_ps(lchan,rchan));
+        }
+        if (frames % 4 != 0) {
+            Uint32 rem = frames % 4;
+            for(int ii = (Uint32)(frames-rem); ii < frames; ii++) {
+                output[2*ii  ] = input[ii]*left;
+                output[2*ii+1] = input[ii]*right;
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        const float32x4_t lgain = vld1q_dup_f32(&left);
+        const float32x4_t rgain = vld1q_dup_f32(&right);
+        float32x4_t data;
+        float32x4x2_t pair;
+        for(int ii = 0; ii < (int)frames-3; ii += 4) {
+            data = vld1q_f32(input+ii);
+            pair.val[0] = vmulq_f32(data,lgain);
+            pair.val[1] = vmulq_f32(data,rgain);
+            vst2q_f32(output+2*ii,pair);
+        }
+        if (frames % 4 != 0) {
+            Uint32 rem = frames % 4;
+            for(int ii = (Uint32)(frames-rem); ii < frames; ii++) {
+                output[2*ii  ] = input[ii]*left;
+                output[2*ii+1] = input[ii]*right;
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        for(int ii = 0; ii < frames; ii++) {
+            output[2*ii  ] = input[ii]*left;
+            output[2*ii+1] = input[ii]*right;
+        }
+    }
+    return frames;
+}
+
+/**
+ * Mixes an interleaved stereo signal through a 2x2 gain matrix
+ *
+ * The matrix is stored by input channel, so that matrix[2*ii+jj] is the
+ * amount of input channel ii sent to output channel jj. This is the same
+ * layout as the channel mapping of {@link AudioPanner}. The output is
+ * overwritten, not added to.
+ *
+ * It is safe for output to be the same as the input buffer.
+ *
+ * @param input     The input buffer (interleaved stereo)
+ * @param matrix    The 2x2 gain matrix
+ * @param output    The output buffer (interleaved stereo)
+ * @param frames    The number of frames to process
+ *
+ * @return the number of frames successfully processed
+ */
+size_t DSPMath::pan_stereo(float* input, float* matrix, float* output, size_t frames) {
+    size_t size = 2*frames;
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        // Two frames per word: (L0 R0 L1 R1)
+        const __m128 lgain = _mm_setr_ps(matrix[0],matrix[1],matrix[0],matrix[1]);
+        const __m128 rgain = _mm_setr_ps(matrix[2],matrix[3],matrix[2],matrix[3]);
+        __m128 data, lchan, rchan;
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            data  = _mm_loadu_ps(input+ii);
+            lchan = _mm_shuffle_ps(data,data,_MM_SHUFFLE(2,2,0,0));
+            rchan = _mm_shuffle_ps(data,data,_MM_SHUFFLE(3,3,1,1));
+            _mm_storeu_ps(output+ii, _mm_fmadd_ps(rchan,rgain,_mm_mul_ps(lchan,lgain)));
+        }
+        if (size % 4 != 0) {
+            float lval = input[size-2];
+            float rval = input[size-1];
+            output[size-2] = lval*matrix[0]+rval*matrix[2];
+            output[size-1] = lval*matrix[1]+rval*matrix[3];
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        // Two frames per word: (L0 R0 L1 R1)
+        const float32x4_t lgain = { matrix[0], matrix[1], matrix[0], matrix[1] };
+        const float32x4_t rgain = { matrix[2], matrix[3], matrix[2], matrix[3] };
+        float32x4_t data, lchan, rchan;
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            data  = vld1q_f32(input+ii);
+            lchan = vtrn1q_f32(data,data);
+            rchan = vtrn2q_f32(data,data);
+            vst1q_f32(output+ii, vmlaq_f32(vmulq_f32(lchan,lgain),rchan,rgain));
+        }
+        if (size % 4 != 0) {
+            float lval = input[size-2];
+            float rval = input[size-1];
+            output[size-2] = lval*matrix[0]+rval*matrix[2];
+            output[size-1] = lval*matrix[1]+rval*matrix[3];
+        }
+    } else {
+#else
+    {
+#endif
+        float lval, rval;
+        for(int ii = 0; ii < size; ii += 2) {
+            lval = input[ii  ];
+            rval = input[ii+1];
+            output[ii  ] = lval*matrix[0]+rval*matrix[2];
+            output[ii+1] = lval*matrix[1]+rval*matrix[3];
+        }
+    }
+    return frames;
+}
+
+        
 #pragma mark -
 #pragma mark Fade-In/Out Methods
 /**
@@ -33,6 +33,7 @@
 #include <SDL/SDL_image.h>
 #include <cugl/renderer/CUTexture.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/io/CUAssetPack.h>
 #include <sstream>
 
 using namespace cugl;
@@ -193,7 +194,8 @@ bool Texture::initWithData(const void *data, int width, int height, Texture::Pix
  * @return true if initialization was successful.
  */
 bool Texture::initWithFile(const std::string& filename) {
-    SDL_Surface* surface = IMG_Load(filename.c_str());
+    const char* ext = strrchr(filename.c_str(),'.');
+    SDL_Surface* surface = IMG_LoadTyped_RW(AssetPack::openAsset(filename,"rb"), 1, ext ? ext+1 : nullptr);
     if (surface == nullptr) {
         return false;
     }
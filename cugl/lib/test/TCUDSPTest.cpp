@@ -0,0 +1,329 @@
+//
+//  TCUDSPTest.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite (and benchmark) for the DSP math kernels
+//  used by the audio graph.  The unit tests check that the vectorized kernels
+//  agree with the scalar ones.  The benchmark reports the cost of each kernel
+//  and of each mixing node in nanoseconds per frame, so that the SSE (x86)
+//  and Neon (ARM) builds can be compared on the same workload.
+//
+//  These test classes only use asserts and have no graphical side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include "TCUDSPTest.h"
+#include <cugl/cugl.h>
+#include <cmath>
+#include <vector>
+
+using namespace cugl;
+using namespace cugl::dsp;
+using namespace cugl::audio;
+
+/** The tolerance when comparing vectorized and scalar results */
+#define DSP_EPSILON 1e-5f
+
+/**
+ * Returns true if the two buffers agree within DSP_EPSILON
+ *
+ * @param a     The first buffer
+ * @param b     The second buffer
+ * @param size  The number of elements to compare
+ *
+ * @return true if the two buffers agree within DSP_EPSILON
+ */
+static bool agree(const std::vector<float>& a, const std::vector<float>& b, size_t size) {
+    for(size_t ii = 0; ii < size; ii++) {
+        if (std::fabs(a[ii]-b[ii]) > DSP_EPSILON) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fills the buffer with a deterministic test signal in [-1,1]
+ *
+ * @param data  The buffer to fill
+ * @param seed  The signal phase
+ */
+static void signal(std::vector<float>& data, float seed) {
+    for(size_t ii = 0; ii < data.size(); ii++) {
+        data[ii] = std::sin(seed+0.37f*ii);
+    }
+}
+
+/**
+ * An audio node producing a fixed block of samples
+ *
+ * This lets the nodes be benchmarked without any decoding cost.
+ */
+class SignalNode : public AudioNode {
+private:
+    /** The samples (one read buffer's worth) */
+    std::vector<float> _data;
+
+public:
+    /**
+     * Initializes a signal for the given format
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in HZ
+     * @param frames    The number of frames per read
+     *
+     * @return true if initialization was successful
+     */
+    bool init(Uint8 channels, Uint32 rate, Uint32 frames) {
+        if (AudioNode::init(channels, rate)) {
+            _data.resize(frames*channels);
+            signal(_data, channels);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Returns a newly allocated signal for the given format
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in HZ
+     * @param frames    The number of frames per read
+     *
+     * @return a newly allocated signal for the given format
+     */
+    static std::shared_ptr<SignalNode> alloc(Uint8 channels, Uint32 rate, Uint32 frames) {
+        std::shared_ptr<SignalNode> result = std::make_shared<SignalNode>();
+        return (result->init(channels, rate, frames) ? result : nullptr);
+    }
+
+    /**
+     * Reads up to the specified number of frames into the given buffer
+     *
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    Uint32 read(float* buffer, Uint32 frames) override {
+        size_t size = std::min((size_t)frames*_channels, _data.size());
+        std::memcpy(buffer, _data.data(), size*sizeof(float));
+        return (Uint32)(size/_channels);
+    }
+};
+
+/**
+ * Logs the time per frame of a measurement
+ *
+ * @param name      The measurement name
+ * @param start     The start time
+ * @param end       The end time
+ * @param frames    The total number of frames processed
+ */
+static void report(const char* name, const Timestamp& start, const Timestamp& end, size_t frames) {
+    double nanos = (double)Timestamp::ellapsedNanos(start, end);
+    CULog("%-24s %8.3f ns/frame", name, nanos/frames);
+}
+
+/**
+ * Returns the number of frames processed reading a node repeatedly
+ *
+ * @param node      The node to read
+ * @param buffer    The output buffer
+ * @param frames    The frames per read
+ * @param rounds    The number of reads
+ *
+ * @return the number of frames processed reading a node repeatedly
+ */
+static size_t pump(const std::shared_ptr<AudioNode>& node, float* buffer, Uint32 frames, int rounds) {
+    size_t total = 0;
+    for(int ii = 0; ii < rounds; ii++) {
+        total += node->read(buffer, frames);
+    }
+    return total;
+}
+
+#pragma mark -
+#pragma mark DSP Math
+/**
+ * Unit test comparing the vectorized DSP kernels to the scalar ones
+ */
+void cugl::testDSPMath() {
+    CULog("Running tests for DSPMath.\n");
+    bool vectorize = DSPMath::VECTORIZE;
+
+    // Odd sizes exercise the scalar tails of the vector loops
+    const size_t sizes[] = { 1, 3, 4, 7, 64, 257 };
+    float matrix[4] = { 0.9f, 0.1f, 0.25f, 0.75f };
+    for(size_t size : sizes) {
+        std::vector<float> mono(size), stereo(2*size);
+        std::vector<float> expect(2*size), actual(2*size);
+        signal(mono, 0.5f);
+        signal(stereo, 1.5f);
+
+#pragma mark Scale-Add Test
+        DSPMath::VECTORIZE = false;
+        DSPMath::scale_add(stereo.data(), stereo.data(), 0.3f, expect.data(), 2*size);
+        DSPMath::VECTORIZE = true;
+        DSPMath::scale_add(stereo.data(), stereo.data(), 0.3f, actual.data(), 2*size);
+        CUAssertAlwaysLog(agree(expect, actual, 2*size), "Scale-add failed for %zu", size);
+
+#pragma mark Mono Pan Test
+        DSPMath::VECTORIZE = false;
+        DSPMath::pan_mono(mono.data(), 0.8f, 0.2f, expect.data(), size);
+        DSPMath::VECTORIZE = true;
+        DSPMath::pan_mono(mono.data(), 0.8f, 0.2f, actual.data(), size);
+        CUAssertAlwaysLog(agree(expect, actual, 2*size), "Mono pan failed for %zu", size);
+        CUAssertAlwaysLog(std::fabs(actual[2*size-1]-0.2f*mono[size-1]) < DSP_EPSILON,
+                          "Mono pan interleave failed for %zu", size);
+
+#pragma mark Stereo Pan Test
+        DSPMath::VECTORIZE = false;
+        DSPMath::pan_stereo(stereo.data(), matrix, expect.data(), size);
+        DSPMath::VECTORIZE = true;
+        DSPMath::pan_stereo(stereo.data(), matrix, actual.data(), size);
+        CUAssertAlwaysLog(agree(expect, actual, 2*size), "Stereo pan failed for %zu", size);
+
+        // In place
+        DSPMath::pan_stereo(stereo.data(), matrix, stereo.data(), size);
+        CUAssertAlwaysLog(agree(expect, stereo, 2*size), "In place stereo pan failed for %zu", size);
+    }
+
+    DSPMath::VECTORIZE = vectorize;
+    CULog("DSPMath tests complete.\n");
+}
+
+#pragma mark -
+#pragma mark Benchmark
+/**
+ * Benchmarks the DSP kernels and the mixing nodes of the audio graph
+ *
+ * @param rounds    The number of buffers to process for each measurement
+ */
+void cugl::benchDSP(int rounds) {
+#if defined CU_MATH_VECTOR_NEON64
+    CULog("DSP benchmark (Neon64)");
+#elif defined CU_MATH_VECTOR_SSE
+    CULog("DSP benchmark (SSE)");
+#else
+    CULog("DSP benchmark (no vectorization)");
+#endif
+    bool started = false;
+    if (AudioManager::get() == nullptr) {
+        AudioManager::start();
+        started = true;
+    }
+    const Uint32 frames = AudioManager::get()->getReadSize();
+    const Uint32 rate = 48000;
+    const size_t total = (size_t)frames*rounds;
+
+    std::vector<float> mono(frames), left(2*frames), rght(2*frames), output(2*frames);
+    signal(mono, 0.5f);
+    signal(left, 1.5f);
+    signal(rght, 2.5f);
+    float matrix[4] = { 0.9f, 0.1f, 0.25f, 0.75f };
+    bool vectorize = DSPMath::VECTORIZE;
+
+#pragma mark Kernel Benchmark
+    for(int pass = 0; pass < 2; pass++) {
+        DSPMath::VECTORIZE = (pass == 0);
+        CULog("Kernels (%s):", DSPMath::VECTORIZE ? "vector" : "scalar");
+
+        Timestamp start;
+        for(int ii = 0; ii < rounds; ii++) {
+            DSPMath::add(left.data(), rght.data(), output.data(), 2*frames);
+        }
+        Timestamp end;
+        report("  add", start, end, total);
+
+        start.mark();
+        for(int ii = 0; ii < rounds; ii++) {
+            DSPMath::scale_add(left.data(), rght.data(), 0.5f, output.data(), 2*frames);
+        }
+        end.mark();
+        report("  scale_add", start, end, total);
+
+        start.mark();
+        for(int ii = 0; ii < rounds; ii++) {
+            DSPMath::pan_mono(mono.data(), 0.8f, 0.2f, output.data(), frames);
+        }
+        end.mark();
+        report("  pan_mono", start, end, total);
+
+        start.mark();
+        for(int ii = 0; ii < rounds; ii++) {
+            DSPMath::pan_stereo(left.data(), matrix, output.data(), frames);
+        }
+        end.mark();
+        report("  pan_stereo", start, end, total);
+    }
+    DSPMath::VECTORIZE = vectorize;
+
+#pragma mark Node Benchmark
+    CULog("Nodes:");
+    std::shared_ptr<AudioMixer> mixer = AudioMixer::alloc(8, 2, rate);
+    for(Uint8 ii = 0; ii < 8; ii++) {
+        mixer->attach(ii, SignalNode::alloc(2, rate, frames));
+    }
+    mixer->setGain(0.5f);
+    Timestamp start;
+    size_t amt = pump(mixer, output.data(), frames, rounds);
+    Timestamp end;
+    report("  AudioMixer (8 inputs)", start, end, amt);
+
+    std::shared_ptr<AudioPanner> panner = AudioPanner::alloc(2, 1, rate);
+    panner->attach(SignalNode::alloc(1, rate, frames));
+    panner->setPan(0, 0, 0.8f);
+    panner->setPan(0, 1, 0.2f);
+    start.mark();
+    amt = pump(panner, output.data(), frames, rounds);
+    end.mark();
+    report("  AudioPanner (mono)", start, end, amt);
+
+    panner = AudioPanner::alloc(2, 2, rate);
+    panner->attach(SignalNode::alloc(2, rate, frames));
+    start.mark();
+    amt = pump(panner, output.data(), frames, rounds);
+    end.mark();
+    report("  AudioPanner (stereo)", start, end, amt);
+
+    std::shared_ptr<AudioResampler> resampler = AudioResampler::alloc(2, rate);
+    resampler->attach(SignalNode::alloc(2, 44100, 2*frames));
+    start.mark();
+    amt = pump(resampler, output.data(), frames, rounds);
+    end.mark();
+    report("  AudioResampler (44.1k)", start, end, amt);
+
+    mixer = nullptr;
+    panner = nullptr;
+    resampler = nullptr;
+    if (started) {
+        AudioManager::stop();
+    }
+}
+
+#pragma mark -
+#pragma mark Complete Test
+/**
+ * Calls all unit tests in this module
+ */
+void cugl::dspUnitTest() {
+    testDSPMath();
+}
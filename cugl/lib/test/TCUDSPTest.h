@@ -0,0 +1,63 @@
+//
+//  TCUDSPTest.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite (and benchmark) for the DSP math kernels
+//  used by the audio graph.  The unit tests check that the vectorized kernels
+//  agree with the scalar ones.  The benchmark reports the cost of each kernel
+//  and of each mixing node in nanoseconds per frame, so that the SSE (x86)
+//  and Neon (ARM) builds can be compared on the same workload.
+//
+//  These test classes only use asserts and have no graphical side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#ifndef __T_CU_DSP_TEST_H__
+#define __T_CU_DSP_TEST_H__
+
+namespace cugl {
+
+/**
+ * Unit test comparing the vectorized DSP kernels to the scalar ones
+ */
+void testDSPMath();
+
+/**
+ * Benchmarks the DSP kernels and the mixing nodes of the audio graph
+ *
+ * Every result is reported in nanoseconds per (stereo) frame.  The kernels
+ * are timed both with and without vectorization.  The nodes are timed on a
+ * synthetic input, reading one audio buffer at a time.  This starts the
+ * audio manager if it is not already active.
+ *
+ * @param rounds    The number of buffers to process for each measurement
+ */
+void benchDSP(int rounds);
+
+/**
+ * Calls all unit tests in this module
+ */
+void dspUnitTest();
+
+}
+
+#endif /* __T_CU_DSP_TEST_H__ */
@@ -0,0 +1,141 @@
+//
+//  TCUIOTest.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite (and benchmark) for the io classes that
+//  support asset loading.  The benchmark compares opening and reading loose
+//  files in the asset directory against reading the same files from a
+//  mounted asset pack.
+//
+//  These test classes only use asserts and have no graphical side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include "TCUIOTest.h"
+#include <cugl/cugl.h>
+#include <SDL/SDL.h>
+
+using namespace cugl;
+
+/**
+ * Returns the number of bytes read from the stream, closing it afterwards
+ *
+ * @param stream    The stream to drain
+ * @param buffer    A scratch buffer
+ *
+ * @return the number of bytes read from the stream
+ */
+static size_t drain(SDL_RWops* stream, std::vector<Uint8>& buffer) {
+    if (stream == nullptr) {
+        return 0;
+    }
+    size_t total = 0;
+    size_t amt = 0;
+    while ((amt = SDL_RWread(stream, buffer.data(), 1, buffer.size())) > 0) {
+        total += amt;
+    }
+    SDL_RWclose(stream);
+    return total;
+}
+
+#pragma mark -
+#pragma mark Asset Pack
+/**
+ * Unit test for the asset pack hashing and decompression
+ */
+void cugl::testAssetPack() {
+    CULog("Running tests for AssetPack.\n");
+
+#pragma mark Hash Test
+    // FNV-1a reference values
+    CUAssertAlwaysLog(AssetPack::hash("") == 0xcbf29ce484222325ULL, "Empty hash failed");
+    CUAssertAlwaysLog(AssetPack::hash("a") == 0xaf63dc4c8601ec8cULL, "Single hash failed");
+    CUAssertAlwaysLog(AssetPack::hash("json\\assets.json") == AssetPack::hash("json/assets.json"),
+                      "Separator normalization failed");
+
+#pragma mark Decompression Test
+    // A literal run, an overlapping match, and trailing literals
+    const Uint8 block[] = { 0x3F, 'a', 'b', 'c', 0x03, 0x00, 0x01, 0x50, 'c', 'a', 'b', 'c', 'a' };
+    const char* expect = "abcabcabcabcabcabcabcabcabca";
+    Uint8 output[64];
+    size_t amt = AssetPack::decompress(block, sizeof(block), output, sizeof(output));
+    CUAssertAlwaysLog(amt == strlen(expect), "Decompression size failed");
+    CUAssertAlwaysLog(memcmp(output, expect, amt) == 0, "Decompression failed");
+
+    // Malformed blocks must fail rather than overrun
+    const Uint8 bad[] = { 0x0F, 0x10, 0x00 };
+    CUAssertAlwaysLog(AssetPack::decompress(bad, sizeof(bad), output, sizeof(output)) == 0,
+                      "Malformed offset accepted");
+    CUAssertAlwaysLog(AssetPack::decompress(block, sizeof(block), output, 8) == 0,
+                      "Output overrun accepted");
+
+    CULog("AssetPack tests complete.\n");
+}
+
+/**
+ * Benchmarks loose files against a mounted asset pack
+ *
+ * @param pack      The pack file (relative to the asset directory)
+ * @param files     The files to read (relative to the asset directory)
+ * @param rounds    The number of times to read each file
+ */
+void cugl::benchAssetPack(const std::string& pack, const std::vector<std::string>& files, int rounds) {
+    std::string root = Application::get()->getAssetDirectory();
+    std::vector<Uint8> buffer(64*1024);
+
+    AssetPack::unmountAll();
+    size_t loose = 0;
+    Timestamp start;
+    for(int ii = 0; ii < rounds; ii++) {
+        for(auto it = files.begin(); it != files.end(); ++it) {
+            loose += drain(AssetPack::openAsset(root+*it, "rb"), buffer);
+        }
+    }
+    Timestamp middle;
+
+    if (!AssetPack::mount(pack)) {
+        CULogError("Could not mount asset pack '%s'", pack.c_str());
+        return;
+    }
+    size_t packed = 0;
+    Timestamp restart;
+    for(int ii = 0; ii < rounds; ii++) {
+        for(auto it = files.begin(); it != files.end(); ++it) {
+            packed += drain(AssetPack::openAsset(root+*it, "rb"), buffer);
+        }
+    }
+    Timestamp end;
+    AssetPack::unmountAll();
+
+    CUAssertAlwaysLog(loose == packed, "Pack contents differ from loose files");
+    CULog("Loose files: %llu us for %zu bytes",
+          (unsigned long long)Timestamp::ellapsedMicros(start, middle), loose);
+    CULog("Asset pack:  %llu us for %zu bytes",
+          (unsigned long long)Timestamp::ellapsedMicros(restart, end), packed);
+}
+
+#pragma mark -
+#pragma mark Complete Test
+/**
+ * Calls all unit tests in this module
+ */
+void cugl::ioUnitTest() {
+    testAssetPack();
+}
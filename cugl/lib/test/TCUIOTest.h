@@ -0,0 +1,64 @@
+//
+//  TCUIOTest.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite (and benchmark) for the io classes that
+//  support asset loading.  The benchmark compares opening and reading loose
+//  files in the asset directory against reading the same files from a
+//  mounted asset pack.
+//
+//  These test classes only use asserts and have no graphical side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef __T_CU_IO_TEST_H__
+#define __T_CU_IO_TEST_H__
+#include <string>
+#include <vector>
+
+namespace cugl {
+
+/**
+ * Unit test for the asset pack hashing and decompression
+ */
+void testAssetPack();
+
+/**
+ * Benchmarks loose files against a mounted asset pack
+ *
+ * Each file is opened and read in full the given number of times, first
+ * from the asset directory and then through the pack.  The pack must be in
+ * the asset directory and contain every file.
+ *
+ * @param pack      The pack file (relative to the asset directory)
+ * @param files     The files to read (relative to the asset directory)
+ * @param rounds    The number of times to read each file
+ */
+void benchAssetPack(const std::string& pack, const std::vector<std::string>& files, int rounds);
+
+/**
+ * Calls all unit tests in this module
+ */
+void ioUnitTest();
+
+}
+
+#endif /* __T_CU_IO_TEST_H__ */
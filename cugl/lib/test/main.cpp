@@ -10,10 +10,13 @@
 #include <stdio.h>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <cugl/cugl.h>
 
 #include "TCUMathTest.h"
 #include "TCU2DTest.h"
+#include "TCUIOTest.h"
+#include "TCUDSPTest.h"
 
 #include <Accelerate/Accelerate.h>
 
@@ -170,6 +173,41 @@ void testThread() {
     pool = nullptr;
 }
 
+void testLockFree() {
+    cugl::LockFreeQueue<int> queue;
+    queue.init(3);
+    CUAssertAlwaysLog(queue.capacity() == 4, "Capacity not rounded to a power of two");
+    for(int ii = 0; ii < 4; ii++) {
+        CUAssertAlwaysLog(queue.push(ii), "Push failed before capacity");
+    }
+    CUAssertAlwaysLog(!queue.push(4) && queue.full(), "Push succeeded past capacity");
+
+    int value = -1;
+    std::thread consumer([&] {
+        for(int ii = 0; ii < 1000; ) {
+            if (queue.pop(value)) {
+                CUAssertAlwaysLog(value == ii, "Queue out of order");
+                ii++;
+            }
+        }
+    });
+    for(int ii = 4; ii < 1000; ) {
+        if (queue.push(ii)) {
+            ii++;
+        }
+    }
+    consumer.join();
+    CUAssertAlwaysLog(queue.isEmpty(), "Queue not drained");
+
+    cugl::LockFreeQueue<std::vector<int>> slots;
+    slots.init(1);
+    slots.prepare()->assign(8, 1);
+    slots.commit();
+    CUAssertAlwaysLog(slots.prepare() == nullptr, "Prepared past capacity");
+    CUAssertAlwaysLog(slots.peek()->size() == 8 && slots.pop(), "In place pop failed");
+    CUAssertAlwaysLog(!slots.pop(), "Popped an empty queue");
+    CUAssertAlwaysLog(slots.prepare()->capacity() >= 8, "In place pop did not keep the slot");
+}
 
 int main(int argc, char * argv[]) {
     cugl::Application app;
@@ -198,9 +236,14 @@ int main(int argc, char * argv[]) {
     cugl::mathUnitTest();
 
     //cugl::sceneUnitTest();
+    cugl::ioUnitTest();
+    //cugl::benchAssetPack("assets.pack", { "json/assets.json", "fonts/Futura.ttf" }, 100);
+    cugl::dspUnitTest();
+    //cugl::benchDSP(10000);
     //testBinary();
     //testFree();
     //testThread();
+    //testLockFree();
     
     app.quit();
     app.onShutdown();
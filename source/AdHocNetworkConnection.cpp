@@ -2,10 +2,16 @@
 
 #include <cugl/cugl.h>
 
+#include <algorithm>
+#include <array>
+#include <random>
 #include <sstream>
 #include <utility>
 
 #include "libraries/SLikeNet/slikenet/peerinterface.h"
+#include "libraries/SLikeNet/slikenet/statistics.h"
+
+#include "Varint.h"
 
 using namespace cugl;
 
@@ -18,11 +24,29 @@ constexpr uint8_t ROOM_LENGTH = 5;
 /** How long to wait before considering ourselves disconnected (ms) */
 constexpr size_t DISCONN_TIME = 5000;
 
-/** How long to wait between reconnection attempts (seconds) */
-constexpr size_t RECONN_GAP = 3;
+/** Delay after the first reconnection attempt, doubled after each further attempt (ms) */
+constexpr unsigned int RECONN_BASE_DELAY = 100;
+
+/** Longest delay between reconnection attempts (ms) */
+constexpr unsigned int RECONN_MAX_DELAY = 3000;
+
+/** Number of reconnection attempts before giving up */
+constexpr unsigned int RECONN_ATTEMPTS = 10;
+
+/** Number of reconnection attempts straight to the host before also punching through again */
+constexpr unsigned int RECONN_DIRECT_ATTEMPTS = 3;
 
-/** How long to wait before giving up on reconnection (seconds) */
-constexpr size_t RECONN_TIMEOUT = 15;
+/** Number of connection requests sent per direct reconnection attempt */
+constexpr unsigned int RECONN_REQUESTS = 4;
+
+/** Time between connection requests in a direct reconnection attempt (ms) */
+constexpr unsigned int RECONN_REQUEST_GAP = 100;
+
+/** How long to wait for a new host before reconnecting to the old one (seconds) */
+constexpr time_t MIGRATION_TIMEOUT = 5;
+
+/** How long a relay is kept open without any traffic through it (ms) */
+constexpr SLNet::TimeMS RELAY_IDLE_TIMEOUT = 10000;
 
 AdHocNetworkConnection::AdHocNetworkConnection(ConnectionConfig config)
 	: status(NetStatus::Pending),
@@ -30,9 +54,13 @@ AdHocNetworkConnection::AdHocNetworkConnection(ConnectionConfig config)
 	  numPlayers(1),
 	  maxPlayers(1),
 	  playerID(0),
-	  config(config) {
+	  hostID(0),
+	  config(config),
+	  reconnAttempts(0) {
 	c0StartupConn();
 	remotePeer = HostPeers(config.maxNumPlayers);
+	// Players that dropped out connect straight back to resume their sessions
+	peer->SetMaximumIncomingConnections(config.maxNumPlayers);
 }
 
 AdHocNetworkConnection::AdHocNetworkConnection(ConnectionConfig config, std::string roomID)
@@ -41,10 +69,13 @@ AdHocNetworkConnection::AdHocNetworkConnection(ConnectionConfig config, std::str
 	  numPlayers(1),
 	  maxPlayers(0),
 	  roomID(roomID),
-	  config(config) {
+	  hostID(0),
+	  config(config),
+	  reconnAttempts(0) {
 	c0StartupConn();
-	remotePeer = ClientPeer(std::move(roomID));
-	peer->SetMaximumIncomingConnections(1);
+	remotePeer = ClientPeer(std::move(roomID), config.maxNumPlayers);
+	// Besides the host, mesh clients accept connections from every other player
+	peer->SetMaximumIncomingConnections(config.mesh ? config.maxNumPlayers : 1);
 }
 
 AdHocNetworkConnection::~AdHocNetworkConnection() {
@@ -53,21 +84,33 @@ AdHocNetworkConnection::~AdHocNetworkConnection() {
 }
 
 /**
- * Read the message from a bitstream into a byte vector.
+ * Write a message in the standard format used by this class.
  *
- * Only works if the BitStream was encoded in the standard format used by this clas.
+ * The length is a varint, so lengths under 128 take a single byte, as they did when the length was
+ * a plain byte. Messages too long for one datagram are split and reassembled by SLikeNet.
  */
-std::vector<uint8_t> readBs(SLNet::BitStream& bts) {
-	uint8_t ignored; // NOLINT
-	bts.Read(ignored);
-	uint8_t length; // NOLINT
-	bts.Read(length);
-
-	std::vector<uint8_t> msgConverted;
-	msgConverted.resize(length, 0);
+static void writeMessage(SLNet::BitStream& bs, uint8_t packetType, const ByteView& msg) {
+	// [ packet type | length (varint) | message ]
+	bs.Write(packetType);
+	std::array<uint8_t, varint::MAX_SIZE> length{};
+	const size_t lengthSize = varint::encode(static_cast<uint32_t>(msg.size()), length.data());
+	bs.WriteAlignedBytes(length.data(), static_cast<unsigned int>(lengthSize));
+	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
+}
 
-	bts.ReadAlignedBytes(msgConverted.data(), length);
-	return msgConverted;
+/**
+ * View the message in a packet without copying it.
+ *
+ * Only works if the packet was encoded in the standard format used by this class. The view is
+ * only valid until the packet is deallocated.
+ */
+static ByteView viewPacket(const SLNet::Packet* packet) {
+	size_t index = 1;
+	const auto length = varint::decode(packet->data, packet->length, index);
+	if (!length.has_value()) {
+		return ByteView();
+	}
+	return ByteView(packet->data + index, std::min<size_t>(*length, packet->length - index));
 }
 
 #pragma region Connection Handshake
@@ -78,14 +121,26 @@ void AdHocNetworkConnection::c0StartupConn() {
 	peer->SetTimeoutTime(DISCONN_TIME, SLNet::UNASSIGNED_SYSTEM_ADDRESS);
 
 	peer->AttachPlugin(&(natPunchthroughClient));
+	if (config.mesh) {
+		// Player 0 stays host; the mesh is only used for its verified join
+		mesh.SetAutoparticipateConnections(false);
+		mesh.SetConnectOnNewRemoteConnection(false, "");
+		peer->AttachPlugin(&mesh);
+	}
 	natPunchServerAddress = std::make_unique<SLNet::SystemAddress>(
 		SLNet::SystemAddress(config.punchthroughServerAddr, config.punchthroughServerPort));
+	if (config.relayServerAddr != nullptr) {
+		proxyClient.SetResultHandler(this);
+		peer->AttachPlugin(&proxyClient);
+		relayCoordinatorAddress = std::make_unique<SLNet::SystemAddress>(
+			SLNet::SystemAddress(config.relayServerAddr, config.relayServerPort));
+	}
 
 	// Use the default socket descriptor
 	// This will make the OS assign us a random port.
 	SLNet::SocketDescriptor socketDescriptor;
-	// Allow connections for each player and one for the NAT server.
-	peer->Startup(config.maxNumPlayers, &socketDescriptor, 1);
+	// Allow connections for each player, one for the NAT server and one for the relay coordinator.
+	peer->Startup(config.maxNumPlayers + 1, &socketDescriptor, 1);
 
 	CULog("Your GUID is: %s",
 		  peer->GetGuidFromSystemAddress(SLNet::UNASSIGNED_SYSTEM_ADDRESS).ToString());
@@ -94,14 +149,27 @@ void AdHocNetworkConnection::c0StartupConn() {
 	CULog("Connecting to punchthrough server");
 	peer->Connect(this->natPunchServerAddress->ToString(false),
 				  this->natPunchServerAddress->GetPort(), nullptr, 0);
+
+	// Hosts must be reachable through the coordinator before anyone asks for a relay to them, so
+	// everyone connects up front rather than after punchthrough fails
+	if (relayCoordinatorAddress != nullptr) {
+		CULog("Connecting to relay coordinator");
+		peer->Connect(relayCoordinatorAddress->ToString(false), relayCoordinatorAddress->GetPort(),
+					  nullptr, 0);
+	}
 }
 
 void cugl::AdHocNetworkConnection::ch1HostConnServer(HostPeers& /*h*/) {
 	CULog("Connected to punchthrough server; awaiting room ID");
 }
 
-void cugl::AdHocNetworkConnection::ch2HostGetRoomID(HostPeers& /*h*/, SLNet::BitStream& bts) {
-	auto msgConverted = readBs(bts);
+void cugl::AdHocNetworkConnection::ch2HostGetRoomID(HostPeers& /*h*/,
+													const ByteView& msgConverted) {
+	if (msgConverted.size() < ROOM_LENGTH) {
+		CULogError("Room ID from server is too short");
+		status = NetStatus::GenericError;
+		return;
+	}
 	std::stringstream newRoomId;
 	for (size_t i = 0; i < ROOM_LENGTH; i++) {
 		newRoomId << static_cast<char>(msgConverted[i]);
@@ -122,14 +190,18 @@ void cugl::AdHocNetworkConnection::cc1ClientConnServer(ClientPeer& c) {
 
 void cugl::AdHocNetworkConnection::cc2ClientPunchSuccess(ClientPeer& c, SLNet::Packet* packet) {
 	c.addr = std::make_unique<SLNet::SystemAddress>(packet->systemAddress);
+	c.hostGuid = packet->guid;
 }
 
-void cugl::AdHocNetworkConnection::cc3HostReceivedPunch(HostPeers& h, SLNet::Packet* packet) {
-	auto p = packet->systemAddress;
+void cugl::AdHocNetworkConnection::cc3HostReceivedPunch(HostPeers& h,
+														const SLNet::SystemAddress& p) {
 	CULog("Host received punchthrough; curr num players %d", peer->NumberOfConnections());
 
 	bool hasRoom = false;
-	if (!h.started || numPlayers < maxPlayers) {
+	if (h.started) {
+		// Players rejoining get their old slot back once they resume their session
+		hasRoom = numPlayers < maxPlayers;
+	} else {
 		for (auto& i : h.peers) {
 			if (i == nullptr) {
 				hasRoom = true;
@@ -155,6 +227,9 @@ void cugl::AdHocNetworkConnection::cc4ClientReceiveHostConnection(ClientPeer& c,
 																  SLNet::Packet* packet) {
 	if (packet->systemAddress == *c.addr) {
 		CULog("Connected to host :D");
+		if (status == NetStatus::Reconnecting) {
+			cr0ClientResume(c);
+		}
 	}
 }
 
@@ -170,21 +245,24 @@ void cugl::AdHocNetworkConnection::cc5HostConfirmClient(HostPeers& h, SLNet::Pac
 		return;
 	}
 
+	if (h.started) {
+		CULog("Player rejoining; awaiting its session token");
+		return;
+	}
+
 	for (uint8_t i = 0; i < h.peers.size(); i++) {
-		if (*h.peers.at(i) == packet->systemAddress) {
+		if (h.peers.at(i) != nullptr && *h.peers.at(i) == packet->systemAddress) {
 			const uint8_t pID = i + 1;
 			CULog("Player %d accepted connection request", pID);
 
-			if (h.started) {
-				// Reconnection attempt
-				directSend({static_cast<uint8_t>(numPlayers + 1), maxPlayers, pID, apiVer},
-						   Reconnect, packet->systemAddress);
-			} else {
-				// New player connection
-				maxPlayers++;
-				directSend({static_cast<uint8_t>(numPlayers + 1), maxPlayers, pID, apiVer},
-						   JoinRoom, packet->systemAddress);
+			maxPlayers++;
+			h.tokens.at(i) = std::random_device()();
+			std::vector<uint8_t> joinMsg = {static_cast<uint8_t>(numPlayers + 1), maxPlayers, pID,
+											apiVer};
+			for (unsigned int b = 0; b < 4; b++) {
+				joinMsg.push_back(static_cast<uint8_t>(h.tokens[i] >> (8 * b)));
 			}
+			directSend(joinMsg, JoinRoom, packet->systemAddress);
 			break;
 		}
 	}
@@ -193,7 +271,7 @@ void cugl::AdHocNetworkConnection::cc5HostConfirmClient(HostPeers& h, SLNet::Pac
 }
 
 void cugl::AdHocNetworkConnection::cc6ClientAssignedID(ClientPeer& c,
-													   const std::vector<uint8_t>& msgConverted) {
+													   const ByteView& msgConverted) {
 	const bool apiMatch = msgConverted[3] == apiVer;
 	if (!apiMatch) {
 		CULogError("API version mismatch; currently %d but host was %d", apiVer, msgConverted[3]);
@@ -205,18 +283,25 @@ void cugl::AdHocNetworkConnection::cc6ClientAssignedID(ClientPeer& c,
 		for (uint8_t i = 0; i < playerID; i++) {
 			connectedPlayers.set(i);
 		}
+		// [ ... | session token (4 bytes) ]
+		for (unsigned int b = 0; b < 4 && 4 + b < msgConverted.size(); b++) {
+			c.sessionToken |= static_cast<uint32_t>(msgConverted[4 + b]) << (8 * b);
+		}
 		status = NetStatus::Connected;
 	}
 
-	peer->CloseConnection(*natPunchServerAddress, true);
+	if (!config.mesh) {
+		// Mesh clients stay on the punchthrough server so later players can punch through to them
+		peer->CloseConnection(*natPunchServerAddress, true);
+	}
 
 	directSend({*playerID, static_cast<uint8_t>(apiMatch ? 1 : 0)}, JoinRoom, *c.addr);
 }
 
 void cugl::AdHocNetworkConnection::cc7HostGetClientData(HostPeers& h, SLNet::Packet* packet,
-														const std::vector<uint8_t>& msgConverted) {
+														const ByteView& msgConverted) {
 	for (uint8_t i = 0; i < h.peers.size(); i++) {
-		if (*h.peers.at(i) == packet->systemAddress) {
+		if (h.peers.at(i) != nullptr && *h.peers.at(i) == packet->systemAddress) {
 			const uint8_t pID = i + 1;
 			CULog("Host verifying player %d connection info", pID);
 
@@ -232,11 +317,20 @@ void cugl::AdHocNetworkConnection::cc7HostGetClientData(HostPeers& h, SLNet::Pac
 				return;
 			}
 
-			CULog("Player id %d was successfully verified; connection handshake complete", pID);
-			connectedPlayers.set(pID);
-			const std::vector<uint8_t> joinMsg = {pID};
-			broadcast(joinMsg, packet->systemAddress, PlayerJoined);
-			numPlayers++;
+			if (connectedPlayers.test(pID)) {
+				CULog("Player id %d resumed without ever dropping out", pID);
+			} else {
+				CULog("Player id %d was successfully verified; connection handshake complete", pID);
+				connectedPlayers.set(pID);
+				const std::vector<uint8_t> joinMsg = {pID};
+				broadcast(joinMsg, packet->systemAddress, PlayerJoined);
+				numPlayers++;
+			}
+
+			// A player resuming over a connection that never dropped is still in the mesh
+			if (config.mesh && !mesh.HasParticipant(packet->guid)) {
+				mesh.StartVerifiedJoin(packet->guid);
+			}
 
 			return;
 		}
@@ -247,17 +341,68 @@ void cugl::AdHocNetworkConnection::cc7HostGetClientData(HostPeers& h, SLNet::Pac
 	peer->CloseConnection(packet->systemAddress, true);
 }
 
+void cugl::AdHocNetworkConnection::cr0ClientResume(ClientPeer& c) {
+	CULog("Reconnection Progress: Resuming session with host");
+	// [ player ID | session token (4 bytes) ]
+	std::vector<uint8_t> msg = {*playerID};
+	for (unsigned int b = 0; b < 4; b++) {
+		msg.push_back(static_cast<uint8_t>(c.sessionToken >> (8 * b)));
+	}
+	directSend(msg, Resume, *c.addr);
+	c.resuming = true;
+}
+
+void cugl::AdHocNetworkConnection::cr0HostResume(HostPeers& h, SLNet::Packet* packet,
+												 const ByteView& msgConverted) {
+	const uint8_t pID = msgConverted.size() < 5 ? 0 : msgConverted[0];
+	uint32_t token = 0;
+	for (unsigned int b = 0; b < 4 && pID != 0; b++) {
+		token |= static_cast<uint32_t>(msgConverted[1 + b]) << (8 * b);
+	}
+	if (!h.started || pID == 0 || pID > h.peers.size() || token != h.tokens.at(pID - 1)) {
+		CULog("Rejecting session resume for player %d", pID);
+		directSend({}, JoinRoomFail, packet->systemAddress);
+		peer->CloseConnection(packet->systemAddress, true);
+		return;
+	}
+
+	auto& slot = h.peers.at(pID - 1);
+	if (slot != nullptr && *slot == packet->systemAddress && connectedPlayers.test(pID)) {
+		// The player timed out on us but its connection never dropped; nobody else saw it leave
+		CULog("Player %d is resuming its session over the same connection", pID);
+		directSend({numPlayers, maxPlayers, pID, apiVer}, Reconnect, packet->systemAddress);
+		return;
+	}
+
+	CULog("Player %d is resuming its session", pID);
+	if (slot != nullptr && !(*slot == packet->systemAddress)) {
+		// We had not noticed the old connection die yet, e.g. the player changed networks
+		peer->CloseConnection(*slot, false);
+	}
+	if (connectedPlayers.test(pID)) {
+		connectedPlayers.reset(pID);
+		numPlayers--;
+		send({pID}, PlayerLeft);
+	}
+	slot = std::make_unique<SLNet::SystemAddress>(packet->systemAddress);
+	directSend({static_cast<uint8_t>(numPlayers + 1), maxPlayers, pID, apiVer}, Reconnect,
+			   packet->systemAddress);
+}
+
 void cugl::AdHocNetworkConnection::cr1ClientReceivedInfo(ClientPeer& c,
-														 const std::vector<uint8_t>& msgConverted) {
+														 const ByteView& msgConverted) {
+	if (status != NetStatus::Reconnecting || !c.resuming) {
+		// A late reply to a resume request we already heard back about
+		CULog("Reconnection Progress: Ignoring stale reply from host");
+		return;
+	}
 	CULog("Reconnection Progress: Received data from host");
+	c.resuming = false;
 
 	bool success = msgConverted[3] == apiVer;
 	if (!success) {
 		CULogError("API version mismatch; currently %d but host was %d", apiVer, msgConverted[3]);
 		status = NetStatus::ApiMismatch;
-	} else if (status != NetStatus::Reconnecting) {
-		CULogError("But we're not trying to reconnect. Failure.");
-		success = false;
 	} else if (playerID != msgConverted[2]) {
 		CULogError("Invalid reconnection target; we are player ID %d but host thought we were %d",
 				   playerID.has_value() ? *playerID : -1, msgConverted[2]);
@@ -269,11 +414,21 @@ void cugl::AdHocNetworkConnection::cr1ClientReceivedInfo(ClientPeer& c,
 		maxPlayers = msgConverted[1];
 		playerID = msgConverted[2];
 		status = NetStatus::Connected;
+		c.started = true;
+		c.hostLost.reset();
 
-		lastReconnAttempt.reset();
+		const auto downtime =
+			std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - *disconnTime);
+		CULog("Session resumed after %lld ms", static_cast<long long>(downtime.count()));
+		nextReconnAttempt.reset();
 		disconnTime.reset();
 	}
-	peer->CloseConnection(*natPunchServerAddress, true);
+	// Resuming straight through to the host never reconnects to the punchthrough server
+	if (!config.mesh &&
+		peer->GetConnectionState(*natPunchServerAddress) == SLNet::IS_CONNECTED) {
+		// Mesh clients stay on the punchthrough server so later players can punch through to them
+		peer->CloseConnection(*natPunchServerAddress, true);
+	}
 
 	directSend({static_cast<uint8_t>(playerID.has_value() ? *playerID : 0),
 				static_cast<uint8_t>(success ? 1 : 0)},
@@ -281,43 +436,325 @@ void cugl::AdHocNetworkConnection::cr1ClientReceivedInfo(ClientPeer& c,
 }
 
 void cugl::AdHocNetworkConnection::cr2HostGetClientResp(HostPeers& h, SLNet::Packet* packet,
-														const std::vector<uint8_t>& msgConverted) {
+														const ByteView& msgConverted) {
 	CULog("Host processing reconnection response");
 	cc7HostGetClientData(h, packet, msgConverted);
 }
 
+bool cugl::AdHocNetworkConnection::cp1ClientRequestRelay(ClientPeer& c) {
+	// The coordinator only knows the host by its real GUID, not by the room ID
+	if (relayCoordinatorAddress == nullptr || c.hostGuid == SLNet::UNASSIGNED_RAKNET_GUID ||
+		peer->GetConnectionState(*relayCoordinatorAddress) != SLNet::IS_CONNECTED) {
+		return false;
+	}
+	CULog("Asking relay coordinator for a relay to %s", c.hostGuid.ToString());
+	if (proxyClient.RequestForwarding(*relayCoordinatorAddress, SLNet::UNASSIGNED_SYSTEM_ADDRESS,
+									  c.hostGuid, RELAY_IDLE_TIMEOUT)) {
+		c.relayed = true;
+	}
+	return c.relayed;
+}
+
+void cugl::AdHocNetworkConnection::OnForwardingSuccess(
+	const char* proxyIPAddress, unsigned short proxyPort, SLNet::SystemAddress /*proxyCoordinator*/,
+	SLNet::SystemAddress /*sourceAddress*/, SLNet::SystemAddress /*targetAddress*/,
+	SLNet::RakNetGUID /*targetGuid*/, SLNet::UDPProxyClient* /*proxyClientPlugin*/) {
+	CULog("Relay to host ready at %s:%d", proxyIPAddress, proxyPort);
+	remotePeer.match([](HostPeers& /*h*/) {},
+					 [&](ClientPeer& c) {
+						 // The host connects to us through the relay, like after punchthrough
+						 c.addr = std::make_unique<SLNet::SystemAddress>(proxyIPAddress, proxyPort);
+					 });
+}
+
+void cugl::AdHocNetworkConnection::OnForwardingNotification(
+	const char* proxyIPAddress, unsigned short proxyPort, SLNet::SystemAddress /*proxyCoordinator*/,
+	SLNet::SystemAddress /*sourceAddress*/, SLNet::SystemAddress /*targetAddress*/,
+	SLNet::RakNetGUID /*targetGuid*/, SLNet::UDPProxyClient* /*proxyClientPlugin*/) {
+	CULog("Client is joining through relay %s:%d", proxyIPAddress, proxyPort);
+	remotePeer.match(
+		[&](HostPeers& h) {
+			cc3HostReceivedPunch(h, SLNet::SystemAddress(proxyIPAddress, proxyPort));
+		},
+		[](ClientPeer& /*c*/) { CULogError("Client was asked to accept a relay?"); });
+}
+
+void cugl::AdHocNetworkConnection::OnForwardingInProgress(
+	const char* proxyIPAddress, unsigned short proxyPort, SLNet::SystemAddress proxyCoordinator,
+	SLNet::SystemAddress sourceAddress, SLNet::SystemAddress targetAddress,
+	SLNet::RakNetGUID targetGuid, SLNet::UDPProxyClient* proxyClientPlugin) {
+	OnForwardingSuccess(proxyIPAddress, proxyPort, proxyCoordinator, sourceAddress, targetAddress,
+						targetGuid, proxyClientPlugin);
+}
+
+void cugl::AdHocNetworkConnection::OnNoServersOnline(
+	SLNet::SystemAddress /*proxyCoordinator*/, SLNet::SystemAddress /*sourceAddress*/,
+	SLNet::SystemAddress /*targetAddress*/, SLNet::RakNetGUID /*targetGuid*/,
+	SLNet::UDPProxyClient* /*proxyClientPlugin*/) {
+	CULogError("No relay servers are online");
+	if (status != NetStatus::Reconnecting) {
+		status = NetStatus::GenericError;
+	}
+}
+
+void cugl::AdHocNetworkConnection::OnRecipientNotConnected(
+	SLNet::SystemAddress /*proxyCoordinator*/, SLNet::SystemAddress /*sourceAddress*/,
+	SLNet::SystemAddress /*targetAddress*/, SLNet::RakNetGUID /*targetGuid*/,
+	SLNet::UDPProxyClient* /*proxyClientPlugin*/) {
+	CULogError("Host is not connected to the relay coordinator");
+	if (status != NetStatus::Reconnecting) {
+		status = NetStatus::GenericError;
+	}
+}
+
+void cugl::AdHocNetworkConnection::OnAllServersBusy(
+	SLNet::SystemAddress /*proxyCoordinator*/, SLNet::SystemAddress /*sourceAddress*/,
+	SLNet::SystemAddress /*targetAddress*/, SLNet::RakNetGUID /*targetGuid*/,
+	SLNet::UDPProxyClient* /*proxyClientPlugin*/) {
+	CULogError("Every relay server is busy");
+	if (status != NetStatus::Reconnecting) {
+		status = NetStatus::GenericError;
+	}
+}
+
+void cugl::AdHocNetworkConnection::cm1ClientStartMesh(ClientPeer& c, SLNet::Packet* packet) {
+	DataStructures::List<SLNet::SystemAddress> addresses;
+	DataStructures::List<SLNet::RakNetGUID> guids;
+	DataStructures::List<SLNet::BitStream*> userData;
+	mesh.GetVerifiedJoinRequiredProcessingList(packet->guid, addresses, guids, userData);
+
+	CULog("Joining mesh; punching through to %d players", guids.Size());
+	for (unsigned int i = 0; i < guids.Size(); i++) {
+		c.meshJoining.insert(guids[i].g);
+		natPunchthroughClient.OpenNAT(guids[i], *natPunchServerAddress);
+	}
+}
+
+void cugl::AdHocNetworkConnection::cm2ClientPunchPeer(ClientPeer& c, SLNet::Packet* packet) {
+	if (c.meshJoining.erase(packet->guid.g) > 0) {
+		// As with the host in cc3, whoever was punched to makes the connection
+		CULog("Punched through to a peer; awaiting its connection");
+		return;
+	}
+	CULog("A joining peer punched through; connecting to it now");
+	peer->Connect(packet->systemAddress.ToString(false), packet->systemAddress.GetPort(), nullptr,
+				  0);
+}
+
+void cugl::AdHocNetworkConnection::cm3ClientPeerConnected(ClientPeer& /*c*/,
+														  SLNet::Packet* packet) {
+	directSend({*playerID}, MeshHello, packet->systemAddress);
+}
+
+void cugl::AdHocNetworkConnection::cm4ClientPeerIdentified(ClientPeer& c, SLNet::Packet* packet,
+														   const ByteView& msgConverted) {
+	const uint8_t pID = msgConverted[0];
+	if (pID == 0 || pID >= c.meshPeers.size()) {
+		CULogError("Peer claimed invalid player ID %d; disconnecting", pID);
+		peer->CloseConnection(packet->systemAddress, true);
+		return;
+	}
+	CULog("Directly connected to player %d", pID);
+	c.meshPeers.at(pID) = std::make_unique<SLNet::SystemAddress>(packet->systemAddress);
+}
+
+uint8_t cugl::AdHocNetworkConnection::hostSuccessor() const {
+	for (uint8_t pID = 0; pID < *playerID; pID++) {
+		if (pID != hostID && connectedPlayers.test(pID)) {
+			return pID;
+		}
+	}
+	return *playerID;
+}
+
+bool cugl::AdHocNetworkConnection::cx1ClientLostHost(ClientPeer& c) {
+	CULog("Lost connection to host %d; electing a new host", hostID);
+	if (connectedPlayers.test(hostID)) {
+		connectedPlayers.reset(hostID);
+		numPlayers--;
+	}
+	c.migrationStart = time(nullptr);
+	c.hostLost.set(*playerID);
+	for (const auto& p : c.meshPeers) {
+		if (p != nullptr) {
+			directSend({*playerID, hostID}, HostLost, *p);
+		}
+	}
+
+	const uint8_t successor = hostSuccessor();
+	if (successor != *playerID && c.meshPeers.at(successor) == nullptr) {
+		// We would never hear the new host; the old host might still take us back
+		CULog("No direct connection to player %d; reconnecting instead", successor);
+		c.migrationStart.reset();
+		c.hostLost.reset();
+		startReconnecting();
+		return false;
+	}
+	CULog("Player %d should take over as host", successor);
+	return cx2ClientPeerLostHost(c, ByteView());
+}
+
+bool cugl::AdHocNetworkConnection::cx2ClientPeerLostHost(ClientPeer& c,
+														 const ByteView& msgConverted) {
+	// [ sender | host it lost ], or empty for our own report
+	if (!msgConverted.empty()) {
+		// Reports only count while we have lost the host ourselves
+		if (msgConverted.size() < 2 || msgConverted[1] != hostID ||
+			!c.migrationStart.has_value()) {
+			return false;
+		}
+		const uint8_t sender = msgConverted[0];
+		if (sender < c.meshPeers.size() && c.meshPeers[sender] != nullptr &&
+			!c.hostLost.test(sender)) {
+			// The sender may have ignored our report if it came before it lost the host too
+			directSend({*playerID, hostID}, HostLost, *c.meshPeers[sender]);
+		}
+		c.hostLost.set(sender);
+	}
+	if (!c.migrationStart.has_value() || hostSuccessor() != *playerID) {
+		return false;
+	}
+
+	// Either someone else agrees the host is gone, or there is no one else left
+	std::bitset<ONE_BYTE> others = connectedPlayers;
+	others.reset(*playerID);
+	return c.hostLost.count() > 1 || others.none();
+}
+
+void cugl::AdHocNetworkConnection::cx3ClientBecomeHost() {
+	auto& c = remotePeer.get<ClientPeer>();
+	const uint8_t oldHost = hostID;
+
+	HostPeers h(config.maxNumPlayers);
+	h.started = true;
+	if (c.tokens.size() == h.tokens.size()) {
+		// Carry every player's token over, so they can still resume their sessions with us
+		h.tokens = c.tokens;
+	}
+	for (uint8_t pID = 1; pID < c.meshPeers.size(); pID++) {
+		if (pID == *playerID) {
+			// Hold our own slot so no one joining is given our ID
+			h.peers.at(pID - 1) =
+				std::make_unique<SLNet::SystemAddress>(SLNet::UNASSIGNED_SYSTEM_ADDRESS);
+		} else {
+			h.peers.at(pID - 1) = std::move(c.meshPeers[pID]);
+		}
+	}
+	if (c.addr != nullptr && peer->GetConnectionState(*c.addr) == SLNet::IS_CONNECTED) {
+		peer->CloseConnection(*c.addr, true);
+	}
+
+	CULog("Taking over as host from player %d", oldHost);
+	hostID = *playerID;
+	remotePeer = std::move(h);
+	send({hostID}, HostClaim);
+}
+
+void cugl::AdHocNetworkConnection::cx4ClientFollowHost(ClientPeer& c, SLNet::Packet* packet,
+													   const ByteView& msgConverted) {
+	const uint8_t newHost = msgConverted[0];
+	if (newHost >= c.meshPeers.size() || c.meshPeers[newHost] == nullptr ||
+		!(*c.meshPeers[newHost] == packet->systemAddress)) {
+		CULogError("Player %d claimed to be host over an unknown connection", newHost);
+		return;
+	}
+
+	CULog("Player %d took over as host from player %d", newHost, hostID);
+	if (connectedPlayers.test(hostID)) {
+		connectedPlayers.reset(hostID);
+		numPlayers--;
+	}
+	if (c.addr != nullptr && peer->GetConnectionState(*c.addr) == SLNet::IS_CONNECTED) {
+		// The old host is still there for us, but the rest of the game moved on
+		peer->CloseConnection(*c.addr, true);
+	}
+	c.addr = std::move(c.meshPeers[newHost]);
+	hostID = newHost;
+	c.migrationStart.reset();
+	c.hostLost.reset();
+	status = NetStatus::Connected;
+	nextReconnAttempt.reset();
+	disconnTime.reset();
+}
+
 #pragma endregion
 
-void AdHocNetworkConnection::broadcast(const std::vector<uint8_t>& msg,
-									   SLNet::SystemAddress& ignore, CustomDataPackets packetType) {
+void AdHocNetworkConnection::broadcast(const ByteView& msg, const SLNet::SystemAddress& ignore,
+									   CustomDataPackets packetType) {
 	SLNet::BitStream bs;
-	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType));
-	bs.Write(static_cast<uint8_t>(msg.size()));
-	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
-	peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, ignore, true);
+	writeMessage(bs, static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType), msg);
+
+	// A RakNet broadcast can only skip one address, and neither server may get game traffic
+	DataStructures::List<SLNet::SystemAddress> addresses;
+	DataStructures::List<SLNet::RakNetGUID> guids;
+	peer->GetSystemList(addresses, guids);
+	for (unsigned int i = 0; i < addresses.Size(); i++) {
+		const SLNet::SystemAddress& addr = addresses[i];
+		if (addr == ignore || addr == *natPunchServerAddress ||
+			(relayCoordinatorAddress != nullptr && addr == *relayCoordinatorAddress)) {
+			continue;
+		}
+		peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, addr, false);
+	}
+}
+
+void AdHocNetworkConnection::send(const std::vector<uint8_t>& msg) {
+	if (config.mesh) {
+		remotePeer.match([&](HostPeers& /*h*/) { send(msg, Standard); },
+						 [&](ClientPeer& c) { meshSend(c, msg); });
+		return;
+	}
+	send(msg, Standard);
+}
+
+void cugl::AdHocNetworkConnection::meshSend(ClientPeer& c, const std::vector<uint8_t>& msg) {
+	// [ one bit per player reached directly | message ]
+	std::vector<uint8_t> relayed(meshMaskSize(), 0);
+	bool reachedAny = false;
+	for (uint8_t pID = 0; pID < c.meshPeers.size(); pID++) {
+		if (c.meshPeers[pID] != nullptr) {
+			directSend(msg, MeshDirect, *c.meshPeers[pID]);
+			relayed[pID / CHAR_BIT] |= 1 << (pID % CHAR_BIT);
+			reachedAny = true;
+		}
+	}
+
+	if (!reachedAny) {
+		send(msg, Standard);
+		return;
+	}
+	relayed.insert(relayed.end(), msg.begin(), msg.end());
+	send(relayed, MeshRelay);
 }
 
-void AdHocNetworkConnection::send(const std::vector<uint8_t>& msg) { send(msg, Standard); }
+void cugl::AdHocNetworkConnection::meshRelay(HostPeers& h, const ByteView& msg,
+											 const ByteView& reached,
+											 const SLNet::SystemAddress& sender) {
+	SLNet::BitStream bs;
+	writeMessage(bs, static_cast<uint8_t>(ID_USER_PACKET_ENUM + Standard), msg);
+
+	for (uint8_t i = 0; i < h.peers.size(); i++) {
+		const uint8_t pID = i + 1;
+		if (h.peers[i] == nullptr || *h.peers[i] == sender || !connectedPlayers.test(pID) ||
+			(reached[pID / CHAR_BIT] & (1 << (pID % CHAR_BIT))) != 0) {
+			continue;
+		}
+		peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, *h.peers[i], false);
+	}
+}
 
 void cugl::AdHocNetworkConnection::sendOnlyToHost(const std::vector<uint8_t>& msg) {
 	remotePeer.match([&](HostPeers& /*h*/) {}, [&](ClientPeer& /*c*/) { send(msg, DirectToHost); });
 }
 
 void AdHocNetworkConnection::send(const std::vector<uint8_t>& msg, CustomDataPackets packetType) {
-	SLNet::BitStream bs;
-	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType));
-	bs.Write(static_cast<uint8_t>(msg.size()));
-	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
-
 	remotePeer.match(
-		[&](HostPeers& /*h*/) {
-			peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, *natPunchServerAddress, true);
-		},
+		[&](HostPeers& /*h*/) { broadcast(msg, SLNet::UNASSIGNED_SYSTEM_ADDRESS, packetType); },
 		[&](ClientPeer& c) {
 			if (c.addr == nullptr) {
 				return;
 			}
-			peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, *c.addr, false);
+			directSend(msg, packetType, *c.addr);
 		});
 }
 
@@ -325,50 +762,86 @@ void cugl::AdHocNetworkConnection::directSend(const std::vector<uint8_t>& msg,
 											  CustomDataPackets packetType,
 											  SLNet::SystemAddress dest) {
 	SLNet::BitStream bs;
-	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType));
-	bs.Write(static_cast<uint8_t>(msg.size()));
-	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
+	writeMessage(bs, static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType), msg);
 	peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, dest, false);
 }
 
+void cugl::AdHocNetworkConnection::startReconnecting() {
+	status = NetStatus::Reconnecting;
+	disconnTime = Clock::now();
+	nextReconnAttempt = disconnTime;
+	reconnAttempts = 0;
+}
+
 void cugl::AdHocNetworkConnection::attemptReconnect() {
-	CUAssertLog(disconnTime.has_value(), "No time for disconnect??");
+	CUAssertLog(nextReconnAttempt.has_value(), "No time for next reconnection attempt??");
 
-	time_t now = time(nullptr);
-	if (now - *disconnTime > RECONN_TIMEOUT) {
+	const auto now = Clock::now();
+	if (now < *nextReconnAttempt) {
+		return;
+	}
+	if (reconnAttempts >= RECONN_ATTEMPTS) {
 		CULog("Reconnection timed out; giving up");
 		status = NetStatus::Disconnected;
 		return;
 	}
 
-	if (lastReconnAttempt.has_value()) {
-		if (now - *lastReconnAttempt < RECONN_GAP) {
-			// Too soon after last attempt; abort
-			return;
-		}
-	}
-
-	CULog("Attempting reconnection");
-
-	peer->Shutdown(0);
-	SLNet::RakPeerInterface::DestroyInstance(peer.release());
+	const unsigned int delay = std::min(RECONN_MAX_DELAY, RECONN_BASE_DELAY << reconnAttempts);
+	nextReconnAttempt = now + std::chrono::milliseconds(delay);
+	reconnAttempts++;
 
-	lastReconnAttempt = now;
-	peer = nullptr;
+	remotePeer.match(
+		[](HostPeers& /*h*/) {},
+		[&](ClientPeer& c) {
+			if (c.addr == nullptr) {
+				return;
+			}
+			c.meshJoining.clear();
+
+			// Our socket and connection object survive; try the host's last known address first
+			switch (peer->GetConnectionState(*c.addr)) {
+				case SLNet::IS_CONNECTED:
+					// The link itself is fine (e.g. we timed out on the host ourselves); the
+					// host answers each request, so only keep one in flight
+					if (!c.resuming) {
+						cr0ClientResume(c);
+					}
+					break;
+				case SLNet::IS_NOT_CONNECTED:
+				case SLNet::IS_DISCONNECTED:
+				case SLNet::IS_SILENTLY_DISCONNECTING:
+					// Any request sent over the old connection went down with it
+					c.resuming = false;
+					CULog("Attempting reconnection %d straight to host", reconnAttempts);
+					peer->Connect(c.addr->ToString(false), c.addr->GetPort(), nullptr, 0, nullptr,
+								  0, RECONN_REQUESTS, RECONN_REQUEST_GAP);
+					break;
+				default:
+					// An attempt is still in flight
+					break;
+			}
 
-	c0StartupConn();
-	peer->SetMaximumIncomingConnections(1);
+			// The host's NAT may only let punched through traffic in, or our address changed
+			if (reconnAttempts > RECONN_DIRECT_ATTEMPTS) {
+				if (c.relayed) {
+					// Punchthrough never worked for us, and the old relay may have timed out
+					cp1ClientRequestRelay(c);
+				} else if (peer->GetConnectionState(*natPunchServerAddress) ==
+						   SLNet::IS_CONNECTED) {
+					cc1ClientConnServer(c);
+				} else {
+					CULog("Reconnecting to punchthrough server");
+					peer->Connect(natPunchServerAddress->ToString(false),
+								  natPunchServerAddress->GetPort(), nullptr, 0);
+				}
+			}
+		});
 }
 
-void AdHocNetworkConnection::receive(
-	const std::function<void(const std::vector<uint8_t>&)>& dispatcher) {
+void AdHocNetworkConnection::receive(const std::function<void(const ByteView&)>& dispatcher) {
 	switch (status) {
 		case NetStatus::Reconnecting:
 			attemptReconnect();
-			if (peer == nullptr) {
-				CULog("Peer null");
-				return;
-			}
 			break;
 		case NetStatus::Disconnected:
 		case NetStatus::GenericError:
@@ -380,6 +853,17 @@ void AdHocNetworkConnection::receive(
 			break;
 	}
 
+	remotePeer.match([](HostPeers& /*h*/) {},
+					 [&](ClientPeer& c) {
+						 if (c.migrationStart.has_value() &&
+							 time(nullptr) - *c.migrationStart > MIGRATION_TIMEOUT) {
+							 CULog("No new host took over; reconnecting to the old one");
+							 c.migrationStart.reset();
+							 c.hostLost.reset();
+							 startReconnecting();
+						 }
+					 });
+
 	SLNet::Packet* packet = nullptr;
 	for (packet = peer->Receive(); packet != nullptr;
 		 peer->DeallocatePacket(packet), packet = peer->Receive()) {
@@ -392,10 +876,22 @@ void AdHocNetworkConnection::receive(
 					// Punchthrough server
 					remotePeer.match([&](HostPeers& h) { ch1HostConnServer(h); },
 									 [&](ClientPeer& c) { cc1ClientConnServer(c); });
+				} else if (relayCoordinatorAddress != nullptr &&
+						   packet->systemAddress == *relayCoordinatorAddress) {
+					CULog("Connected to relay coordinator");
 				} else {
 					remotePeer.match(
 						[&](HostPeers& h) { cc5HostConfirmClient(h, packet); },
-						[&](ClientPeer& /*c*/) {
+						[&](ClientPeer& c) {
+							if (inMesh()) {
+								cm3ClientPeerConnected(c, packet);
+								return;
+							}
+							if (status == NetStatus::Reconnecting && c.addr != nullptr &&
+								packet->systemAddress == *c.addr) {
+								cr0ClientResume(c);
+								return;
+							}
 							CULogError(
 								"A connection request you sent was accepted despite being client?");
 						});
@@ -404,23 +900,45 @@ void AdHocNetworkConnection::receive(
 			case ID_NEW_INCOMING_CONNECTION: // Someone connected to you
 				CULog("A peer connected");
 				remotePeer.match(
-					[&](HostPeers& /*h*/) { CULogError("How did that happen? You're the host"); },
-					[&](ClientPeer& c) { cc4ClientReceiveHostConnection(c, packet); });
+					[&](HostPeers& /*h*/) { CULog("Awaiting session token from the peer"); },
+					[&](ClientPeer& c) {
+						if (inMesh()) {
+							cm3ClientPeerConnected(c, packet);
+						} else {
+							cc4ClientReceiveHostConnection(c, packet);
+						}
+					});
 				break;
 			case ID_NAT_PUNCHTHROUGH_SUCCEEDED: // Punchthrough succeeded
 				CULog("Punchthrough success");
 
-				remotePeer.match([&](HostPeers& h) { cc3HostReceivedPunch(h, packet); },
-								 [&](ClientPeer& c) { cc2ClientPunchSuccess(c, packet); });
+				remotePeer.match(
+					[&](HostPeers& h) { cc3HostReceivedPunch(h, packet->systemAddress); },
+								 [&](ClientPeer& c) {
+									 if (inMesh()) {
+										 cm2ClientPunchPeer(c, packet);
+									 } else {
+										 cc2ClientPunchSuccess(c, packet);
+									 }
+								 });
 				break;
 			case ID_NAT_TARGET_NOT_CONNECTED:
+				if (inMesh()) {
+					CULog("Mesh peer is not on the punchthrough server; relaying through host");
+					break;
+				}
+				if (status == NetStatus::Reconnecting) {
+					CULog("Host is not on the punchthrough server; still trying to reconnect");
+					break;
+				}
 				status = NetStatus::GenericError;
 				break;
 			case ID_REMOTE_DISCONNECTION_NOTIFICATION:
 			case ID_REMOTE_CONNECTION_LOST:
 			case ID_DISCONNECTION_NOTIFICATION:
-			case ID_CONNECTION_LOST:
+			case ID_CONNECTION_LOST: {
 				CULog("Received disconnect notification");
+				bool promote = false;
 				remotePeer.match(
 					[&](HostPeers& h) {
 						for (uint8_t i = 0; i < h.peers.size(); i++) {
@@ -450,16 +968,27 @@ void AdHocNetworkConnection::receive(
 						if (packet->systemAddress == *natPunchServerAddress) {
 							CULog("Successfully disconnected from Punchthrough server");
 						}
+						for (uint8_t pID = 0; pID < c.meshPeers.size(); pID++) {
+							if (c.meshPeers[pID] != nullptr &&
+								*c.meshPeers[pID] == packet->systemAddress) {
+								CULog("Lost direct connection to player %d; relaying through host",
+									  pID);
+								c.meshPeers[pID] = nullptr;
+							}
+						}
 						if (packet->systemAddress == *c.addr) {
+							if (inMesh() && c.started) {
+								promote = cx1ClientLostHost(c);
+								return;
+							}
 							CULog("Lost connection to host");
-							connectedPlayers.reset(0);
+							connectedPlayers.reset(hostID);
 							switch (status) {
 								case NetStatus::Pending:
 									status = NetStatus::GenericError;
 									return;
 								case NetStatus::Connected:
-									status = NetStatus::Reconnecting;
-									disconnTime = time(nullptr);
+									startReconnecting();
 									return;
 								case NetStatus::Reconnecting:
 								case NetStatus::Disconnected:
@@ -471,12 +1000,52 @@ void AdHocNetworkConnection::receive(
 						}
 					});
 
+				if (promote) {
+					cx3ClientBecomeHost();
+				}
 				break;
+			}
 			case ID_NAT_PUNCHTHROUGH_FAILED:
 			case ID_CONNECTION_ATTEMPT_FAILED:
 			case ID_NAT_TARGET_UNRESPONSIVE: {
+				if (inMesh()) {
+					// Only a direct link failed; messages to that player go through the host
+					CULog("Mesh punchthrough failure %d", packet->data[0]); // NOLINT
+					break;
+				}
+				if (status == NetStatus::Reconnecting) {
+					CULog("Reconnection attempt failed %d; retrying", packet->data[0]); // NOLINT
+					break;
+				}
+				if (relayCoordinatorAddress != nullptr &&
+					packet->systemAddress == *relayCoordinatorAddress) {
+					// Only matters if punchthrough fails too, in which case that reports the error
+					CULog("Could not reach relay coordinator");
+					break;
+				}
 				CULogError("Punchthrough failure %d", packet->data[0]); // NOLINT
 
+				const bool handled = remotePeer.match(
+					[&](HostPeers& /*h*/) {
+						// A player that could not punch through to us may still join via a relay
+						return packet->data[0] != ID_CONNECTION_ATTEMPT_FAILED || // NOLINT
+							   !(packet->systemAddress == *natPunchServerAddress);
+					},
+					[&](ClientPeer& c) {
+						// Failures from the punchthrough server name the host by its real GUID
+						if (packet->data[0] == ID_NAT_PUNCHTHROUGH_FAILED) { // NOLINT
+							c.hostGuid = packet->guid;
+						} else if (packet->data[0] == ID_NAT_TARGET_UNRESPONSIVE) { // NOLINT
+							SLNet::BitStream failure(packet->data, packet->length, false);
+							failure.IgnoreBytes(sizeof(SLNet::MessageID));
+							failure.Read(c.hostGuid);
+						}
+						return !c.relayed && cp1ClientRequestRelay(c);
+					});
+				if (handled) {
+					break;
+				}
+
 				status = NetStatus::GenericError;
 				bts.IgnoreBytes(sizeof(SLNet::MessageID));
 				SLNet::RakNetGUID recipientGuid;
@@ -491,7 +1060,7 @@ void AdHocNetworkConnection::receive(
 
 			// Begin Non-SLikeNet Reported Codes
 			case ID_USER_PACKET_ENUM + Standard: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 				dispatcher(msgConverted);
 
 				remotePeer.match(
@@ -501,7 +1070,7 @@ void AdHocNetworkConnection::receive(
 				break;
 			}
 			case ID_USER_PACKET_ENUM + DirectToHost: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 
 				remotePeer.match([&](HostPeers& /*h*/) { dispatcher(msgConverted); },
 								 [&](ClientPeer& /*c*/) {
@@ -512,13 +1081,13 @@ void AdHocNetworkConnection::receive(
 			}
 			case ID_USER_PACKET_ENUM + AssignedRoom: {
 				remotePeer.match(
-					[&](HostPeers& h) { ch2HostGetRoomID(h, bts); },
+					[&](HostPeers& h) { ch2HostGetRoomID(h, viewPacket(packet)); },
 					[&](ClientPeer& /*c*/) { CULog("Assigned room ID but ignoring"); });
 
 				break;
 			}
 			case ID_USER_PACKET_ENUM + JoinRoom: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 
 				remotePeer.match(
 					[&](HostPeers& h) { cc7HostGetClientData(h, packet, msgConverted); },
@@ -526,12 +1095,25 @@ void AdHocNetworkConnection::receive(
 				break;
 			}
 			case ID_USER_PACKET_ENUM + JoinRoomFail: {
+				if (status == NetStatus::Reconnecting) {
+					CULog("Host refused to resume our session");
+					status = NetStatus::Disconnected;
+					break;
+				}
 				CULog("Failed to join room");
 				status = NetStatus::RoomNotFound;
 				break;
 			}
+			case ID_USER_PACKET_ENUM + Resume: {
+				const auto msgConverted = viewPacket(packet);
+
+				remotePeer.match(
+					[&](HostPeers& h) { cr0HostResume(h, packet, msgConverted); },
+					[&](ClientPeer& /*c*/) { CULogError("Received session resume as client"); });
+				break;
+			}
 			case ID_USER_PACKET_ENUM + Reconnect: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 
 				remotePeer.match(
 					[&](HostPeers& h) { cr2HostGetClientResp(h, packet, msgConverted); },
@@ -540,7 +1122,7 @@ void AdHocNetworkConnection::receive(
 				break;
 			}
 			case ID_USER_PACKET_ENUM + PlayerJoined: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 
 				remotePeer.match(
 					[&](HostPeers& /*h*/) { CULogError("Received player joined message as host"); },
@@ -553,7 +1135,7 @@ void AdHocNetworkConnection::receive(
 				break;
 			}
 			case ID_USER_PACKET_ENUM + PlayerLeft: {
-				auto msgConverted = readBs(bts);
+				const auto msgConverted = viewPacket(packet);
 
 				remotePeer.match(
 					[&](HostPeers& /*h*/) { CULogError("Received player left message as host"); },
@@ -564,9 +1146,96 @@ void AdHocNetworkConnection::receive(
 				break;
 			}
 			case ID_USER_PACKET_ENUM + StartGame: {
+				const auto msgConverted = viewPacket(packet);
+				remotePeer.match([](HostPeers& /*h*/) {},
+								 [&](ClientPeer& c) {
+									 // [ session token of each player but the host (4 bytes) ]
+									 c.tokens.assign(msgConverted.size() / 4, 0);
+									 for (size_t i = 0; i < c.tokens.size(); i++) {
+										 for (unsigned int b = 0; b < 4; b++) {
+											 const uint32_t byte = msgConverted[4 * i + b];
+											 c.tokens[i] |= byte << (8 * b);
+										 }
+									 }
+								 });
 				startGame();
 				break;
 			}
+			case ID_USER_PACKET_ENUM + MeshDirect: {
+				// A host only gets these from clients that have not heard it took over yet
+				dispatcher(viewPacket(packet));
+				break;
+			}
+			case ID_USER_PACKET_ENUM + MeshRelay: {
+				const auto msgConverted = viewPacket(packet);
+				const size_t maskSize = meshMaskSize();
+				if (msgConverted.size() < maskSize) {
+					break;
+				}
+				const auto msg = msgConverted.from(maskSize);
+				remotePeer.match(
+					[&](HostPeers& h) {
+						dispatcher(msg);
+						meshRelay(h, msg, msgConverted, packet->systemAddress);
+					},
+					[&](ClientPeer& /*c*/) { CULogError("Received mesh relay as client"); });
+				break;
+			}
+			case ID_USER_PACKET_ENUM + MeshHello: {
+				const auto msgConverted = viewPacket(packet);
+				if (msgConverted.empty()) {
+					break;
+				}
+				remotePeer.match(
+					[&](HostPeers& /*h*/) { CULogError("Received mesh hello as host"); },
+					[&](ClientPeer& c) { cm4ClientPeerIdentified(c, packet, msgConverted); });
+				break;
+			}
+			case ID_USER_PACKET_ENUM + HostLost: {
+				bool promote = false;
+				remotePeer.match([&](HostPeers& /*h*/) {},
+								 [&](ClientPeer& c) {
+									 promote = cx2ClientPeerLostHost(c, viewPacket(packet));
+								 });
+				if (promote) {
+					cx3ClientBecomeHost();
+				}
+				break;
+			}
+			case ID_USER_PACKET_ENUM + HostClaim: {
+				const auto msgConverted = viewPacket(packet);
+				if (msgConverted.empty()) {
+					break;
+				}
+				remotePeer.match(
+					[&](HostPeers& /*h*/) { CULogError("Another player claimed to be host"); },
+					[&](ClientPeer& c) { cx4ClientFollowHost(c, packet, msgConverted); });
+				break;
+			}
+			case ID_FCM2_VERIFIED_JOIN_START:
+				remotePeer.match(
+					[&](HostPeers& /*h*/) { CULogError("Asked to join mesh as host"); },
+					[&](ClientPeer& c) { cm1ClientStartMesh(c, packet); });
+				break;
+			case ID_FCM2_VERIFIED_JOIN_CAPABLE:
+				// The joining client reached every other client in the mesh
+				remotePeer.match(
+					[&](HostPeers& /*h*/) {
+						mesh.RespondOnVerifiedJoinCapable(packet, true, nullptr);
+					},
+					[&](ClientPeer& /*c*/) {});
+				break;
+			case ID_FCM2_VERIFIED_JOIN_ACCEPTED:
+				CULog("Mesh join complete");
+				break;
+			case ID_FCM2_VERIFIED_JOIN_FAILED:
+			case ID_FCM2_VERIFIED_JOIN_REJECTED:
+				// Whatever direct connections were made stay up; the rest go through the host
+				CULog("Could not reach every player directly; relaying through host");
+				break;
+			case ID_FCM2_NEW_HOST:
+				// Player 0 is always the host, whoever the mesh thinks has been up longest
+				break;
 			default:
 				CULog("Received unknown message: %d", packet->data[0]); // NOLINT
 				break;
@@ -575,8 +1244,7 @@ void AdHocNetworkConnection::receive(
 }
 
 void cugl::AdHocNetworkConnection::manualDisconnect() {
-	status = NetStatus::Reconnecting;
-	disconnTime = time(nullptr);
+	startReconnecting();
 }
 
 void AdHocNetworkConnection::startGame() {
@@ -584,14 +1252,58 @@ void AdHocNetworkConnection::startGame() {
 	remotePeer.match(
 		[&](HostPeers& h) {
 			h.started = true;
-			// NOLINTNEXTLINE
-			auto& a = const_cast<SLNet::SystemAddress&>(SLNet::UNASSIGNED_SYSTEM_ADDRESS);
-			broadcast({}, a, StartGame);
+			// In a mesh, everyone learns every token in case they have to take over as host
+			std::vector<uint8_t> msg;
+			for (size_t i = 0; config.mesh && i < h.tokens.size(); i++) {
+				for (unsigned int b = 0; b < 4; b++) {
+					msg.push_back(static_cast<uint8_t>(h.tokens[i] >> (8 * b)));
+				}
+			}
+			broadcast(msg, SLNet::UNASSIGNED_SYSTEM_ADDRESS, StartGame);
 		},
-		[&](ClientPeer& c) {});
+		[&](ClientPeer& c) { c.started = true; });
 	maxPlayers = numPlayers;
 }
 
 cugl::AdHocNetworkConnection::NetStatus cugl::AdHocNetworkConnection::getStatus() const {
 	return status;
 }
+
+tl::optional<NetworkConnection::LinkStats> AdHocNetworkConnection::getLinkStats() const {
+	// Only links to other players count; the servers are not on the game's path
+	std::vector<const SLNet::SystemAddress*> links;
+	remotePeer.match(
+		[&](const HostPeers& h) {
+			for (const auto& p : h.peers) {
+				links.push_back(p.get());
+			}
+		},
+		[&](const ClientPeer& c) {
+			links.push_back(c.addr.get());
+			for (const auto& p : c.meshPeers) {
+				links.push_back(p.get());
+			}
+		});
+
+	tl::optional<LinkStats> result;
+	SLNet::RakNetStatistics rns;
+	for (const auto* addr : links) {
+		if (addr == nullptr || peer->GetConnectionState(*addr) != SLNet::IS_CONNECTED ||
+			peer->GetStatistics(*addr, &rns) == nullptr) {
+			continue;
+		}
+		if (!result.has_value()) {
+			result = LinkStats();
+		}
+		const int ping = peer->GetAveragePing(*addr);
+		if (ping > 0) {
+			result->rtt = std::max(result->rtt, static_cast<uint32_t>(ping));
+		}
+		result->loss = std::max(result->loss, rns.packetlossLastSecond);
+		for (const double bytes : rns.bytesInSendBuffer) {
+			result->queuedBytes += static_cast<uint64_t>(bytes);
+		}
+		result->queuedBytes += rns.bytesInResendBuffer;
+	}
+	return result;
+}
@@ -19,10 +19,15 @@
 #ifndef ADHOC_NETWORK_CONNECTION_H
 #define ADHOC_NETWORK_CONNECTION_H
 
+#include <chrono>
+#include <climits>
+
 #include "CUNetworkConnection.h"
 #include "libraries/SLikeNet/slikenet/BitStream.h"
+#include "libraries/SLikeNet/slikenet/FullyConnectedMesh2.h"
 #include "libraries/SLikeNet/slikenet/MessageIdentifiers.h"
 #include "libraries/SLikeNet/slikenet/NatPunchthroughClient.h"
+#include "libraries/SLikeNet/slikenet/UDPProxyClient.h"
 
 // Forward declarations
 namespace SLNet {
@@ -33,7 +38,8 @@ namespace cugl {
 /**
  * Network connection to other players with an adhoc implementation.
  */
-class AdHocNetworkConnection : public NetworkConnection {
+class AdHocNetworkConnection : public NetworkConnection,
+							   private SLNet::UDPProxyClientResultHandler {
    public:
 #pragma region Setup
 	explicit AdHocNetworkConnection(ConnectionConfig config);
@@ -48,7 +54,7 @@ class AdHocNetworkConnection : public NetworkConnection {
 
 	void sendOnlyToHost(const std::vector<uint8_t>& msg) override;
 
-	void receive(const std::function<void(const std::vector<uint8_t>&)>& dispatcher) override;
+	void receive(const std::function<void(const ByteView&)>& dispatcher) override;
 
 	void manualDisconnect() override;
 #pragma endregion
@@ -69,6 +75,10 @@ class AdHocNetworkConnection : public NetworkConnection {
 	uint8_t getNumPlayers() const override { return numPlayers; }
 
 	uint8_t getTotalPlayers() const override { return maxPlayers; }
+
+	uint8_t getHostID() const override { return hostID; }
+
+	tl::optional<LinkStats> getLinkStats() const override;
 #pragma endregion
 
    private:
@@ -93,6 +103,8 @@ class AdHocNetworkConnection : public NetworkConnection {
 	std::string roomID;
 	/** Which players are active */
 	std::bitset<ONE_BYTE> connectedPlayers;
+	/** Current host player ID; only changes if the host drops out of a mesh game */
+	uint8_t hostID;
 #pragma endregion
 
 #pragma region Punchthrough
@@ -102,6 +114,18 @@ class AdHocNetworkConnection : public NetworkConnection {
 	SLNet::NatPunchthroughClient natPunchthroughClient;
 #pragma endregion
 
+#pragma region Relay
+	/** Address of the relay coordinator, or null if there is none */
+	std::unique_ptr<SLNet::SystemAddress> relayCoordinatorAddress;
+	/** Relay client; only attached if the config has a relay coordinator */
+	SLNet::UDPProxyClient proxyClient;
+#pragma endregion
+
+#pragma region Mesh
+	/** Mesh plugin; only attached if the config asks for a mesh */
+	SLNet::FullyConnectedMesh2 mesh;
+#pragma endregion
+
 #pragma region Connection Data Structures
 	struct HostPeers {
 		/** Whether the game has started */
@@ -112,16 +136,20 @@ class AdHocNetworkConnection : public NetworkConnection {
 		std::vector<std::unique_ptr<SLNet::SystemAddress>> peers;
 		/** Addresses of all players to reject */
 		std::unordered_set<std::string> toReject;
+		/** Session tokens of all players, for resuming their sessions after dropping out */
+		std::vector<uint32_t> tokens;
 
 		HostPeers() : started(false), maxPlayers(DEFAULT_MAX_PLAYERS) {
 			for (uint8_t i = 0; i < DEFAULT_MAX_PLAYERS - 1; i++) {
 				peers.push_back(nullptr);
 			}
+			tokens.resize(peers.size());
 		};
 		explicit HostPeers(uint32_t max) : started(false), maxPlayers(max) {
 			for (uint8_t i = 0; i < max - 1; i++) {
 				peers.push_back(nullptr);
 			}
+			tokens.resize(peers.size());
 		};
 	};
 
@@ -129,9 +157,40 @@ class AdHocNetworkConnection : public NetworkConnection {
 	struct ClientPeer {
 		std::unique_ptr<SLNet::SystemAddress> addr;
 		std::string room;
+		/** Addresses of the players connected directly in a mesh, by player ID */
+		std::vector<std::unique_ptr<SLNet::SystemAddress>> meshPeers;
+		/** GUIDs of the players this client asked to punch through to while joining the mesh */
+		std::unordered_set<uint64_t> meshJoining;
+		/** Whether the game has started */
+		bool started;
+		/** Time the connection to the host was lost, if electing a new one */
+		tl::optional<time_t> migrationStart;
+		/** Which players reported losing the old host */
+		std::bitset<ONE_BYTE> hostLost;
+		/** Token the host gave us to resume our session after dropping out */
+		uint32_t sessionToken;
+		/**
+		 * Session tokens of all players but the host, which the host shares when a mesh game
+		 * starts so that whoever takes over can still let players resume
+		 */
+		std::vector<uint32_t> tokens;
+		/** Whether we asked for a relay to the host, because punchthrough to it failed */
+		bool relayed;
+		/** Whether a request to resume our session is awaiting the host's reply */
+		bool resuming;
+		/** GUID of the host, once the punchthrough server has named it; the room ID is an alias */
+		SLNet::RakNetGUID hostGuid;
 
 		// NOLINTNEXTLINE
-		explicit ClientPeer(std::string roomID) : room(std::move(roomID)) {}
+		ClientPeer(std::string roomID, uint32_t maxPlayers)
+			: room(std::move(roomID)),
+			  started(false),
+			  sessionToken(0),
+			  relayed(false),
+			  resuming(false),
+			  hostGuid(SLNet::UNASSIGNED_RAKNET_GUID) {
+			meshPeers.resize(maxPlayers);
+		}
 	};
 
 	/**
@@ -151,7 +210,19 @@ class AdHocNetworkConnection : public NetworkConnection {
 		PlayerJoined,
 		PlayerLeft,
 		StartGame,
-		DirectToHost
+		DirectToHost,
+		// Mesh only: a message sent straight from one client to another
+		MeshDirect,
+		// Mesh only: a message for the host to relay to the players the sender could not reach
+		MeshRelay,
+		// Mesh only: a client introducing itself over a new direct connection
+		MeshHello,
+		// Mesh only: a client lost its connection to the host
+		HostLost,
+		// Mesh only: a client took over as host
+		HostClaim,
+		// Request to resume a session with its token
+		Resume
 	};
 
 #pragma region Connection Handshake
@@ -180,6 +251,53 @@ class AdHocNetworkConnection : public NetworkConnection {
 	cc5		Request Accepted -------------------------->
 	cc6												Join Room
 
+	If punchthrough to the host fails, the client asks the relay coordinator for a relay server to
+	forward UDP between the two, and the handshake carries on through the relay from cc2. The
+	coordinator knows the host by its GUID, which the punchthrough server's replies carry in place
+	of the room ID:
+
+			Host		Relay Coordinator			Client
+			====		=================			======
+	cp1							 <----------------- Request relay to host
+	cp2		  <---------- Relay Ready ------------------>
+	cc3		Connect (to the relay) -------------------->
+			...
+
+	A client that dropped out reuses its connection object and first connects straight back to the
+	host's last known address, only punching through again if that keeps failing:
+
+			Host		Punchthrough Server			Client
+			====		===================			======
+	cr0		  <------------------------------------ Connect (or punch through, as above)
+			  <------------------------------------ Resume with session token
+			Reconnect Info ---------------------------->
+	cr1												Confirm Info
+	cr2		Connection Finished
+
+	In mesh mode, the handshake continues once the host has verified the client (cc7):
+
+			Host				Joining Client				Other Client
+			====				==============				============
+	cc7		Start Verified Join -->
+	cm1							Punch to each other client -------->
+	cm2							Wait for connection		Connect
+	cm3							  <-------------------- Connection accepted
+	cm4							  <---------- Exchange player IDs ---------->
+			  <------------ Join Capable
+			Accept Join ----------------------------------------------->
+
+	If the host drops out of a mesh game, the remaining clients elect the lowest active player ID
+	as the new host. The successor promotes itself once a second client confirms the host is gone
+	(or nobody else is left), so one client's flaky link to the host cannot split the game.
+
+			Successor			Other Clients
+			=========			=============
+	cx1		Lost host			Lost host
+			  <---------- Host Lost ---------->
+	cx2		Heard Host Lost
+	cx3		Host Claim -------------------->
+	cx4								Follow new host
+
 	*/
 
 	/** Step 0: Connect to punchthrough server (both client and host) */
@@ -188,34 +306,122 @@ class AdHocNetworkConnection : public NetworkConnection {
 	/** Host Step 1: Server connection established */
 	void ch1HostConnServer(HostPeers& h);
 	/** Host Step 2: Server gave room ID to host; awaiting incoming connections */
-	void ch2HostGetRoomID(HostPeers& h, SLNet::BitStream& bts);
+	void ch2HostGetRoomID(HostPeers& h, const ByteView& msgConverted);
 
 	/** Client Step 1: Server connection established; request punchthrough to host from server */
 	void cc1ClientConnServer(ClientPeer& c);
 	/** Client Step 2: Client received successful punchthrough from server */
 	void cc2ClientPunchSuccess(ClientPeer& c, SLNet::Packet* packet);
-	/** Client Step 3: Host received successful punchthrough request passed through from server */
-	void cc3HostReceivedPunch(HostPeers& h, SLNet::Packet* packet);
+	/** Client Step 3: Host received successful punchthrough (or a relay) to the given address */
+	void cc3HostReceivedPunch(HostPeers& h, const SLNet::SystemAddress& p);
 	/** Client Step 4: Client received direct connection request from host */
 	void cc4ClientReceiveHostConnection(ClientPeer& c, SLNet::Packet* packet);
 	/** Client Step 5: Host received confirmation of connection from client */
 	void cc5HostConfirmClient(HostPeers& h, SLNet::Packet* packet);
 	/** Client Step 6: Client received player ID from host and API */
-	void cc6ClientAssignedID(ClientPeer& c, const std::vector<uint8_t>& msgConverted);
+	void cc6ClientAssignedID(ClientPeer& c, const ByteView& msgConverted);
 	/** Client Step 7: Host received confirmation of game data from client; connection finished */
-	void cc7HostGetClientData(HostPeers& h, SLNet::Packet* packet,
-							  const std::vector<uint8_t>& msgConverted);
+	void cc7HostGetClientData(HostPeers& h, SLNet::Packet* packet, const ByteView& msgConverted);
 
-	/** Reconnect Step 1: Picks up after client step 5; host sent reconn data to client */
-	void cr1ClientReceivedInfo(ClientPeer& c, const std::vector<uint8_t>& msgConverted);
+	/**
+	 * Relay Step 1: Client could not punch through to the host; ask for a relay
+	 *
+	 * @returns Whether a relay was requested
+	 */
+	bool cp1ClientRequestRelay(ClientPeer& c);
+
+	/** Relay Step 2: Client got a relay to the host */
+	void OnForwardingSuccess(const char* proxyIPAddress, unsigned short proxyPort,
+							 SLNet::SystemAddress proxyCoordinator,
+							 SLNet::SystemAddress sourceAddress,
+							 SLNet::SystemAddress targetAddress, SLNet::RakNetGUID targetGuid,
+							 SLNet::UDPProxyClient* proxyClientPlugin) override;
+	/** Relay Step 2: Host was told a client is coming through a relay */
+	void OnForwardingNotification(const char* proxyIPAddress, unsigned short proxyPort,
+								  SLNet::SystemAddress proxyCoordinator,
+								  SLNet::SystemAddress sourceAddress,
+								  SLNet::SystemAddress targetAddress,
+								  SLNet::RakNetGUID targetGuid,
+								  SLNet::UDPProxyClient* proxyClientPlugin) override;
+	/** Relay Step 2: A relay to the host is already set up */
+	void OnForwardingInProgress(const char* proxyIPAddress, unsigned short proxyPort,
+								SLNet::SystemAddress proxyCoordinator,
+								SLNet::SystemAddress sourceAddress,
+								SLNet::SystemAddress targetAddress, SLNet::RakNetGUID targetGuid,
+								SLNet::UDPProxyClient* proxyClientPlugin) override;
+	/** Relay failure: no relay servers are running */
+	void OnNoServersOnline(SLNet::SystemAddress proxyCoordinator,
+						   SLNet::SystemAddress sourceAddress, SLNet::SystemAddress targetAddress,
+						   SLNet::RakNetGUID targetGuid,
+						   SLNet::UDPProxyClient* proxyClientPlugin) override;
+	/** Relay failure: the host is not connected to the relay coordinator */
+	void OnRecipientNotConnected(SLNet::SystemAddress proxyCoordinator,
+								 SLNet::SystemAddress sourceAddress,
+								 SLNet::SystemAddress targetAddress, SLNet::RakNetGUID targetGuid,
+								 SLNet::UDPProxyClient* proxyClientPlugin) override;
+	/** Relay failure: every relay server is full */
+	void OnAllServersBusy(SLNet::SystemAddress proxyCoordinator,
+						  SLNet::SystemAddress sourceAddress, SLNet::SystemAddress targetAddress,
+						  SLNet::RakNetGUID targetGuid,
+						  SLNet::UDPProxyClient* proxyClientPlugin) override;
+
+	/** Reconnect Step 0: Client is connected to the host again; send it our session token */
+	void cr0ClientResume(ClientPeer& c);
+	/** Reconnect Step 0: Host received a session token from a client resuming its session */
+	void cr0HostResume(HostPeers& h, SLNet::Packet* packet, const ByteView& msgConverted);
+	/** Reconnect Step 1: Client received reconn data from the host */
+	void cr1ClientReceivedInfo(ClientPeer& c, const ByteView& msgConverted);
 	/** Reconnect Step 2: Host received confirmation of game data from client */
-	void cr2HostGetClientResp(HostPeers& h, SLNet::Packet* packet,
-							  const std::vector<uint8_t>& msgConverted);
+	void cr2HostGetClientResp(HostPeers& h, SLNet::Packet* packet, const ByteView& msgConverted);
+
+	/** Mesh Step 1: Client was told by host which other clients to punch through to */
+	void cm1ClientStartMesh(ClientPeer& c, SLNet::Packet* packet);
+	/** Mesh Step 2: Client punched through to another client */
+	void cm2ClientPunchPeer(ClientPeer& c, SLNet::Packet* packet);
+	/** Mesh Step 3: Client is directly connected to another client */
+	void cm3ClientPeerConnected(ClientPeer& c, SLNet::Packet* packet);
+	/** Mesh Step 4: Client learned the player ID of a directly connected client */
+	void cm4ClientPeerIdentified(ClientPeer& c, SLNet::Packet* packet,
+								 const ByteView& msgConverted);
+
+	/**
+	 * Migration Step 1: Client lost its connection to the host mid game
+	 *
+	 * @returns Whether this client should take over as host now
+	 */
+	bool cx1ClientLostHost(ClientPeer& c);
+	/**
+	 * Migration Step 2: Client heard that another client lost the host
+	 *
+	 * Reports are ignored unless this client lost the host too, so a single flaky link to the
+	 * host cannot split the game. Each new report is answered with our own, in case the sender
+	 * ignored ours for arriving too early.
+	 *
+	 * @returns Whether this client should take over as host now
+	 */
+	bool cx2ClientPeerLostHost(ClientPeer& c, const ByteView& msgConverted);
+	/**
+	 * Migration Step 3: Client becomes the host.
+	 *
+	 * Replaces remotePeer, so this must not be called from inside a match on it.
+	 */
+	void cx3ClientBecomeHost();
+	/** Migration Step 4: Client follows a peer that took over as host */
+	void cx4ClientFollowHost(ClientPeer& c, SLNet::Packet* packet, const ByteView& msgConverted);
+
+	/** The player to take over from a lost host; the lowest ID still active (or this player) */
+	uint8_t hostSuccessor() const;
+
+	/** Whether this is a client already in a game, so new connections belong to the mesh */
+	bool inMesh() const {
+		return config.mesh && status == NetStatus::Connected && remotePeer.is<ClientPeer>();
+	}
 
 #pragma endregion
 
 	/**
-	 * Broadcast a message to everyone except the specified connection.
+	 * Broadcast a message to every player except the specified connection. The punchthrough
+	 * server and relay coordinator never get it.
 	 *
 	 * PRECONDITION: This player MUST be the host
 	 *
@@ -223,11 +429,36 @@ class AdHocNetworkConnection : public NetworkConnection {
 	 * @param msg The message to send
 	 * @param ignore The address to not send to
 	 */
-	void broadcast(const std::vector<uint8_t>& msg, SLNet::SystemAddress& ignore,
+	void broadcast(const ByteView& msg, const SLNet::SystemAddress& ignore,
 				   CustomDataPackets packetType = Standard);
 
 	void send(const std::vector<uint8_t>& msg, CustomDataPackets packetType);
 
+	/**
+	 * Send a message straight to every player this client is connected to, and through the host
+	 * to everyone else.
+	 *
+	 * PRECONDITION: This player MUST be a client
+	 *
+	 * @param msg The message to send
+	 */
+	void meshSend(ClientPeer& c, const std::vector<uint8_t>& msg);
+
+	/**
+	 * Relay a message from a mesh client to every player it could not reach itself.
+	 *
+	 * PRECONDITION: This player MUST be the host
+	 *
+	 * @param msg The message to relay
+	 * @param reached One bit per player ID; set for every player the sender reached
+	 * @param sender The address of the sender
+	 */
+	void meshRelay(HostPeers& h, const ByteView& msg, const ByteView& reached,
+				   const SLNet::SystemAddress& sender);
+
+	/** Number of bytes needed for one bit per player */
+	size_t meshMaskSize() const { return (config.maxNumPlayers + CHAR_BIT - 1) / CHAR_BIT; }
+
 	/**
 	 * Send a message to just one connection.
 	 *
@@ -238,13 +469,21 @@ class AdHocNetworkConnection : public NetworkConnection {
 	void directSend(const std::vector<uint8_t>& msg, CustomDataPackets packetType,
 					SLNet::SystemAddress dest);
 
-	/** Last reconnection attempt time, or none if n/a */
-	tl::optional<time_t> lastReconnAttempt;
+	/** Clock for reconnection timing */
+	using Clock = std::chrono::steady_clock;
+
+	/** Time of the next reconnection attempt, or none if n/a */
+	tl::optional<Clock::time_point> nextReconnAttempt;
+	/** Number of reconnection attempts since disconnecting */
+	unsigned int reconnAttempts;
 	/** Time when disconnected, or none if connected */
-	tl::optional<time_t> disconnTime;
+	tl::optional<Clock::time_point> disconnTime;
+
+	/** Lose the connection to the host, and start trying to get it back */
+	void startReconnecting();
 
 	/**
-	 * Attempt to reconnect to the host.
+	 * Attempt to reconnect to the host, backing off exponentially between attempts.
 	 *
 	 * PRECONDITION: Must be called by client when in reconnecting phase.
 	 * A successful connection must have previously been established.
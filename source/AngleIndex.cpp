@@ -0,0 +1,138 @@
+#include "AngleIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+void AngleIndex::clear(float size) {
+	this->size = size;
+	pending.clear();
+	blocked.clear();
+	free.clear();
+	freeEnd.clear();
+}
+
+void AngleIndex::add(float start, float end) {
+	if (end > start) {
+		pending.push_back({start, end - start});
+	}
+}
+
+void AngleIndex::block(float angle, float radius) {
+	if (size <= 0 || radius < 0) {
+		return;
+	}
+	if (2 * radius >= size) {
+		add(0, size);
+		return;
+	}
+	angle = std::fmod(angle, size);
+	if (angle < 0) {
+		angle += size;
+	}
+	const float start = angle - radius;
+	const float end = angle + radius;
+	if (start < 0) {
+		add(start + size, size);
+		add(0, end);
+	} else if (end > size) {
+		add(start, size);
+		add(0, end - size);
+	} else {
+		add(start, end);
+	}
+}
+
+void AngleIndex::build() {
+	std::sort(pending.begin(), pending.end(),
+			  [](const Arc& a, const Arc& b) { return a.start < b.start; });
+
+	blocked.clear();
+	for (const auto& arc : pending) {
+		if (!blocked.empty() && arc.start <= blocked.back().start + blocked.back().length) {
+			Arc& last = blocked.back();
+			last.length = std::max(last.length, arc.start + arc.length - last.start);
+		} else {
+			blocked.push_back(arc);
+		}
+	}
+
+	free.clear();
+	freeEnd.clear();
+	float cursor = 0;
+	float total = 0;
+	for (const auto& arc : blocked) {
+		if (arc.start > cursor) {
+			free.push_back({cursor, arc.start - cursor});
+			total += arc.start - cursor;
+			freeEnd.push_back(total);
+		}
+		cursor = std::max(cursor, arc.start + arc.length);
+	}
+	if (cursor < size) {
+		free.push_back({cursor, size - cursor});
+		total += size - cursor;
+		freeEnd.push_back(total);
+	}
+}
+
+float AngleIndex::distance(float angle) const {
+	if (blocked.empty()) {
+		return size / 2;
+	}
+	angle = std::fmod(angle, size);
+	if (angle < 0) {
+		angle += size;
+	}
+
+	// The first blocked arc starting after this angle, and the one before it
+	const auto next = std::upper_bound(blocked.begin(), blocked.end(), angle,
+									   [](float a, const Arc& arc) { return a < arc.start; });
+	const Arc& after = next == blocked.end() ? blocked.front() : *next;
+	const Arc& before = next == blocked.begin() ? blocked.back() : *(next - 1);
+
+	float ahead = after.start - angle;
+	if (ahead < 0) {
+		ahead += size;
+	}
+	float behind = angle - (before.start + before.length);
+	if (next == blocked.begin()) {
+		behind += size;
+	}
+	if (behind <= 0) {
+		return 0;
+	}
+	return std::min(ahead, behind);
+}
+
+float AngleIndex::sample(float fraction) const {
+	if (freeEnd.empty() || freeEnd.back() <= 0) {
+		return -1;
+	}
+	const float target = fraction * freeEnd.back();
+	auto it = std::upper_bound(freeEnd.begin(), freeEnd.end(), target);
+	if (it == freeEnd.end()) {
+		it--;
+	}
+	const auto i = static_cast<size_t>(it - freeEnd.begin());
+	const float offset = target - (i == 0 ? 0 : freeEnd[i - 1]);
+	const float angle = free[i].start + std::min(std::max(offset, 0.0f), free[i].length);
+	return angle >= size ? angle - size : angle;
+}
+
+AngleIndex::Arc AngleIndex::widest() const {
+	Arc best = {0, 0};
+	for (const auto& arc : free) {
+		if (arc.length > best.length) {
+			best = arc;
+		}
+	}
+	// Free space on both sides of zero is really one arc
+	if (free.size() > 1 && free.front().start <= 0 &&
+		free.back().start + free.back().length >= size) {
+		const float length = free.front().length + free.back().length;
+		if (length > best.length) {
+			best = {free.back().start, length};
+		}
+	}
+	return best;
+}
@@ -0,0 +1,123 @@
+#ifndef ANGLE_INDEX_H
+#define ANGLE_INDEX_H
+
+#include <vector>
+
+/**
+ * A circular interval index over the angle space of the ship.
+ *
+ * Callers block out arcs around the objects they want to keep clear of (e.g. every active breach
+ * plus some padding), then {@link build} the index. The blocked arcs are kept as a sorted ring of
+ * disjoint intervals, and the free space between them as a list of arcs with running lengths.
+ * After building, finding the distance to the nearest blocked arc and sampling a uniformly random
+ * free angle are both a binary search, so placement never needs to guess and retry.
+ *
+ * To look for room for something of width w, block each object with an extra radius of w/2.
+ */
+class AngleIndex {
+   public:
+	/** An arc of the ship, running counterclockwise from start */
+	struct Arc {
+		/** The start angle of the arc, in [0, size) */
+		float start;
+		/** The length of the arc */
+		float length;
+	};
+
+   private:
+	/** The size of the ship */
+	float size;
+	/** Blocked arcs, possibly overlapping, in the order they were added */
+	std::vector<Arc> pending;
+	/** Blocked arcs, disjoint and sorted by start angle; none cross zero */
+	std::vector<Arc> blocked;
+	/** Free arcs, disjoint and sorted by start angle; none cross zero */
+	std::vector<Arc> free;
+	/** The total length of all free arcs up to and including each free arc */
+	std::vector<float> freeEnd;
+
+	/**
+	 * Adds a blocked arc that does not cross zero.
+	 *
+	 * @param start The start angle, in [0, size)
+	 * @param end   The end angle, in (start, size]
+	 */
+	void add(float start, float end);
+
+   public:
+	/**
+	 * Creates a new, empty index for a ship of the given size.
+	 *
+	 * @param size The size of the ship
+	 */
+	explicit AngleIndex(float size = 0) : size(size) {}
+
+	/**
+	 * Removes all blocked arcs and resizes the index.
+	 *
+	 * @param size The size of the ship
+	 */
+	void clear(float size);
+
+	/**
+	 * Blocks the arc within radius of the given angle.
+	 *
+	 * Nothing is visible to queries until the next call to {@link build}.
+	 *
+	 * @param angle  The center of the arc
+	 * @param radius The distance to block on either side
+	 */
+	void block(float angle, float radius);
+
+	/**
+	 * Merges the blocked arcs and computes the free space between them.
+	 *
+	 * This is O(n log n) in the number of blocked arcs.
+	 */
+	void build();
+
+	/**
+	 * Returns the distance from the given angle to the nearest blocked arc, or 0 if it is blocked.
+	 *
+	 * If nothing is blocked, this returns half the ship size.
+	 *
+	 * @param angle The angle to check
+	 */
+	float distance(float angle) const;
+
+	/**
+	 * Returns whether the given angle is outside every blocked arc.
+	 *
+	 * @param angle The angle to check
+	 */
+	bool isFree(float angle) const { return distance(angle) > 0; }
+
+	/**
+	 * Returns the total length of free space.
+	 */
+	float freeLength() const { return freeEnd.empty() ? 0 : freeEnd.back(); }
+
+	/**
+	 * Returns the free angle at the given fraction of the total free space.
+	 *
+	 * Passing a uniform random number in [0, 1) samples a uniformly random free angle. Returns -1
+	 * if there is no free space.
+	 *
+	 * @param fraction A number in [0, 1)
+	 */
+	float sample(float fraction) const;
+
+	/**
+	 * Returns the longest free arc, or an arc of length 0 if there is no free space.
+	 *
+	 * Free space wrapping around zero is counted as one arc.
+	 */
+	Arc widest() const;
+
+	/**
+	 * Returns the free arcs, sorted by start angle. Free space around zero is split in two.
+	 */
+	const std::vector<Arc>& getFree() const { return free; }
+};
+
+#endif /* ANGLE_INDEX_H */
@@ -11,19 +11,20 @@
  * @return  true if the obstacle is initialized properly, false otherwise.
  */
 bool BreachModel::init(float a, uint8_t health, uint8_t p, float time) {
-	angle = a;
-	this->health = health;
-	player = p;
-	timeCreated = time;
-	isActive = true;
-	needSpriteUpdate = true;
+	store->angle[id] = a;
+	store->health[id] = health;
+	store->player[id] = p;
+	store->timeCreated[id] = time;
+	store->setActive(id, true);
+	store->needSpriteUpdate[id] = 1;
 	return true;
 }
 
 void BreachModel::decHealth(unsigned int value) {
+	uint8_t& health = store->health[id];
 	if (value >= health) {
 		health = 0;
-		isActive = false;
+		store->setActive(id, false);
 	} else {
 		health -= value;
 	}
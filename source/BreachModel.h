@@ -1,49 +1,105 @@
 ﻿#ifndef BREACH_MODEL_H
 #define BREACH_MODEL_H
 #include <cugl/cugl.h>
+
+#include <vector>
+
+#include "FreeSlots.h"
+
+/**
+ * Packed storage for every breach on the ship.
+ *
+ * Each field lives in its own array, indexed by breach id, so loops that touch one field of every
+ * breach (e.g. the health drain) walk contiguous memory. {@link BreachModel} is a view of one slot.
+ */
+struct BreachStore {
+	/** The angle at which each breach exists */
+	std::vector<float> angle;
+	/** Time at which each breach was created */
+	std::vector<float> timeCreated;
+	/** The health of each breach: 0 means its resolved */
+	std::vector<uint8_t> health;
+	/** Which player can clear each breach */
+	std::vector<uint8_t> player;
+	/** Whether or not each breach is active; only change through setActive */
+	std::vector<uint8_t> active;
+	/** Whether the player is currently on each breach */
+	std::vector<uint8_t> playerOn;
+	/** Whether each breach sprite needs to be updated */
+	std::vector<uint8_t> needSpriteUpdate;
+	/** The ids of the inactive breaches */
+	FreeSlots slots;
+
+	/**
+	 * Creates storage for the given number of inactive breaches.
+	 *
+	 * @param size The number of breaches
+	 */
+	explicit BreachStore(size_t size = 0)
+		: angle(size, 0),
+		  timeCreated(size, 0),
+		  health(size, 0),
+		  player(size, 0),
+		  active(size, 0),
+		  playerOn(size, 0),
+		  needSpriteUpdate(size, 0),
+		  slots(size) {}
+
+	/** Returns the number of breaches */
+	size_t size() const { return angle.size(); }
+
+	/**
+	 * Activates or deactivates a breach, keeping the free ids up to date.
+	 *
+	 * @param id    The breach id
+	 * @param value Whether the breach is active
+	 */
+	void setActive(uint8_t id, bool value) {
+		active[id] = value ? 1 : 0;
+		if (value) {
+			slots.acquire(id);
+		} else {
+			slots.release(id);
+		}
+	}
+};
+
+/**
+ * A single breach, viewed through its slot in a {@link BreachStore}.
+ */
 class BreachModel {
    private:
-   protected:
-	/** The angle at which the breach exists */
-	float angle;
-	/** The state of the breach in health: 0 means its resolved */
-	uint8_t health;
-	/** Whether the player is currently on this breach */
-	bool playerOn;
-	/** Which player can clear this breach */
-	uint8_t player;
-	/** Set to true if sprite needs to be updated */
-	bool needSpriteUpdate;
-	/** Time at which breach was created */
-	float timeCreated;
-	/** Whether or not this object is active */
-	bool isActive;
+	/** The storage holding this breach */
+	std::shared_ptr<BreachStore> store;
+	/** The index of this breach in the store */
+	uint8_t id;
 
    public:
 	/** Default Max Health of a Breach*/
 	static constexpr uint8_t HEALTH_DEFAULT = 3;
 #pragma mark Constructors
 	/*
-	 * Creates a new breach at angle 0.
+	 * Creates a new breach at angle 0, with storage of its own.
 	 *
 	 * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a model on
 	 * the heap, use one of the static constructors instead.
 	 */
-	BreachModel()
-		: angle(0),
-		  health(0),
-		  playerOn(false),
-		  player(0),
-		  needSpriteUpdate(false),
-		  timeCreated(0),
-		  isActive(false) {}
+	BreachModel() : BreachModel(std::make_shared<BreachStore>(1), 0) {}
+
+	/**
+	 * Creates a view of the breach in the given slot of a store.
+	 *
+	 * @param store The storage holding the breach
+	 * @param id    The index of the breach in the store
+	 */
+	BreachModel(std::shared_ptr<BreachStore> store, uint8_t id) : store(std::move(store)), id(id) {}
 
 	BreachModel(const BreachModel&) = delete;
 
 	/**
 	 * Destroys this breach, releasing all resources.
 	 */
-	virtual ~BreachModel() { dispose(); }
+	~BreachModel() { dispose(); }
 
 	/**
 	 * Disposes all resources and assets of this breach
@@ -62,7 +118,7 @@ class BreachModel {
 	 *
 	 * @return true if the obstacle is initialized properly, false otherwise.
 	 */
-	virtual bool init() { return init(0.0f, 0, 0, 0); }
+	bool init() { return init(0.0f, 0, 0, 0); }
 
 	/**
 	 * Initializes a new breach with the given angle
@@ -75,7 +131,7 @@ class BreachModel {
 	 *
 	 * @return true if the obstacle is initialized properly, false otherwise.
 	 */
-	virtual bool init(const float a) { return init(a, 0, 0, 0); };
+	bool init(const float a) { return init(a, 0, 0, 0); };
 
 	/**
 	 * Initializes a new breach with the given angle and max health
@@ -91,7 +147,7 @@ class BreachModel {
 	 *
 	 * @return true if the obstacle is initialized properly, false otherwise.
 	 */
-	virtual bool init(float a, uint8_t health, uint8_t player, float time);
+	bool init(float a, uint8_t health, uint8_t player, float time);
 
 	/**
 	 * Inits the breach upon recycling.
@@ -105,13 +161,13 @@ class BreachModel {
 	 * Resets this breach
 	 */
 	void reset() {
-		angle = 0;
-		health = 0;
-		playerOn = false;
-		player = 0;
-		needSpriteUpdate = false;
-		timeCreated = 0;
-		isActive = false;
+		store->angle[id] = 0;
+		store->health[id] = 0;
+		store->playerOn[id] = 0;
+		store->player[id] = 0;
+		store->needSpriteUpdate[id] = 0;
+		store->timeCreated[id] = 0;
+		store->setActive(id, false);
 	}
 
 #pragma mark -
@@ -121,42 +177,42 @@ class BreachModel {
 	 *
 	 * @return the current angle of the breach in degrees.
 	 */
-	float getAngle() const { return angle; }
+	float getAngle() const { return store->angle[id]; }
 
 	/**
 	 * Returns the current health of the breach.
 	 *
 	 * @return the current health of the breach.
 	 */
-	uint8_t getHealth() const { return health; }
+	uint8_t getHealth() const { return store->health[id]; }
 
 	/**
 	 * Returns whether the player is currently on the breach.
 	 *
 	 * @return whether the player is currently on the breach.
 	 */
-	bool isPlayerOn() const { return playerOn; }
+	bool isPlayerOn() const { return store->playerOn[id] != 0; }
 
 	/**
 	 * Returns whether the breach is currently active.
 	 *
 	 * @return whether the breach is currently active.
 	 */
-	bool getIsActive() const { return isActive; }
+	bool getIsActive() const { return store->active[id] != 0; }
 
 	/**
 	 * Sets the current angle of the breach in degrees.
 	 *
 	 * @param value The breach angle in degrees
 	 */
-	void setAngle(float value) { angle = value; }
+	void setAngle(float value) { store->angle[id] = value; }
 
 	/**
 	 * Sets the current health of the breach.
 	 *
 	 * @param health New breach health.
 	 */
-	void setHealth(unsigned int value) { health = value; }
+	void setHealth(unsigned int value) { store->health[id] = static_cast<uint8_t>(value); }
 
 	/**
 	 * Decrements the current health of the breach by value.
@@ -170,44 +226,51 @@ class BreachModel {
 	 *
 	 * @param b Whether the player is currently on the breach.
 	 */
-	void setIsPlayerOn(bool b) { playerOn = b; }
+	void setIsPlayerOn(bool b) { store->playerOn[id] = b ? 1 : 0; }
 
 	/**
 	 * Gets which player is assigned to this breach.
 	 *
 	 * @return Which player is assigned to this breach.
 	 */
-	uint8_t getPlayer() const { return player; }
+	uint8_t getPlayer() const { return store->player[id]; }
 
 	/**
 	 * Sets which player is assigned to this breach.
 	 *
 	 * @param p The player to assign to the breach.
 	 */
-	void setPlayer(uint8_t p) { player = p; }
+	void setPlayer(uint8_t p) { store->player[id] = p; }
 
 	/**
 	 * Gets the needSpriteUpdate field.
 	 * @return
 	 */
-	bool getNeedSpriteUpdate() const { return needSpriteUpdate; }
+	bool getNeedSpriteUpdate() const { return store->needSpriteUpdate[id] != 0; }
 
 	/**
 	 * Sets the needSpriteUpdate field.
 	 * @param b
 	 */
-	void setNeedSpriteUpdate(bool b) { needSpriteUpdate = b; }
+	void setNeedSpriteUpdate(bool b) { store->needSpriteUpdate[id] = b ? 1 : 0; }
 
 	/**
 	 * Sets the time breach was created.
 	 * @param time	time at which breach was created
 	 */
-	void setTimeCreated(float time) { timeCreated = time; }
+	void setTimeCreated(float time) { store->timeCreated[id] = time; }
 
 	/**
 	 * Gets the time at which breach was created.
 	 * @return time at which breach was created
 	 */
-	float getTimeCreated() const { return timeCreated; }
+	float getTimeCreated() const { return store->timeCreated[id]; }
+
+	/**
+	 * Returns the index of this breach in its store.
+	 *
+	 * @return the index of this breach in its store.
+	 */
+	uint8_t getID() const { return id; }
 };
 #endif /* __BREACH_MODEL_H__ */
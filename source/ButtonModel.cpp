@@ -1,7 +1,5 @@
 ﻿#include "ButtonModel.h"
 
-#include <utility>
-
 #include "Globals.h"
 
 #pragma region Animation Constants
@@ -18,12 +16,12 @@ constexpr unsigned int DOWN_DURATION = 45;
 constexpr unsigned int I_FRAMES = 10;
 #pragma endregion
 
-bool ButtonModel::init(const float a, std::shared_ptr<ButtonModel> pair, uint8_t pairID) {
+bool ButtonModel::init(const float a, const std::shared_ptr<ButtonModel>& pair, uint8_t pairID) {
 	reset();
-	angle = a;
-	pairButton = std::move(pair);
-	this->pairID = pairID;
-	isActive = true;
+	store->angle[id] = a;
+	pairButton = pair;
+	store->pairID[id] = pairID;
+	store->setActive(id, true);
 	return true;
 };
 
@@ -36,10 +34,13 @@ int ButtonModel::getSection() const {
 }
 
 void ButtonModel::update() {
-	if (!jumped) {
+	uint8_t& jumped = store->jumped[id];
+	if (jumped == 0) {
 		return;
 	}
 
+	unsigned int& frame = store->frame[id];
+	float& height = store->height[id];
 	frame++;
 
 	if (frame < DOWN_ANIMATION_DURATION) {
@@ -52,24 +53,26 @@ void ButtonModel::update() {
 		height = 1.0f - height;
 	} else {
 		height = 0.0f;
-		jumped = false;
+		jumped = 0;
 		frame = 0;
 	}
 }
 
 bool ButtonModel::trigger() {
-	if (jumped && frame < I_FRAMES) {
+	uint8_t& jumped = store->jumped[id];
+	unsigned int& frame = store->frame[id];
+	if (jumped != 0 && frame < I_FRAMES) {
 		return false;
 	}
-	frame = jumped ? DOWN_ANIMATION_DURATION : 0;
-	jumped = true;
+	frame = jumped != 0 ? DOWN_ANIMATION_DURATION : 0;
+	jumped = 1;
 	return true;
 }
 
 void ButtonModel::reset() {
-	jumped = false;
-	height = 0;
-	angle = -1;
-	isActive = false;
-	frame = 0;
+	store->jumped[id] = 0;
+	store->height[id] = 0;
+	store->angle[id] = -1;
+	store->setActive(id, false);
+	store->frame[id] = 0;
 }
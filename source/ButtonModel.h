@@ -3,25 +3,77 @@
 #include <cugl/cugl.h>
 
 #include <bitset>
+#include <vector>
 
+#include "FreeSlots.h"
 #include "Globals.h"
 
+/**
+ * Packed storage for every button on the ship.
+ *
+ * Each field lives in its own array, indexed by button id. {@link ButtonModel} is a view of one
+ * slot.
+ */
+struct ButtonStore {
+	/** The angle at which each button exists */
+	std::vector<float> angle;
+	/** The height of each button, as percentage down (0 = fully up) */
+	std::vector<float> height;
+	/** The current frame of animation of each button */
+	std::vector<unsigned int> frame;
+	/** ID of the pair of each button */
+	std::vector<uint8_t> pairID;
+	/** Whether each button is jumped on */
+	std::vector<uint8_t> jumped;
+	/** Whether each button is active; only change through setActive */
+	std::vector<uint8_t> active;
+	/** The ids of the unused buttons */
+	FreeSlots slots;
+
+	/**
+	 * Creates storage for the given number of unused buttons.
+	 *
+	 * @param size The number of buttons
+	 */
+	explicit ButtonStore(size_t size = 0)
+		: angle(size, -1),
+		  height(size, 0),
+		  frame(size, 0),
+		  pairID(size, static_cast<uint8_t>(-1)),
+		  jumped(size, 0),
+		  active(size, 0),
+		  slots(size) {}
+
+	/** Returns the number of buttons */
+	size_t size() const { return angle.size(); }
+
+	/**
+	 * Activates or deactivates a button, keeping the free ids up to date.
+	 *
+	 * @param id    The button id
+	 * @param value Whether the button is active
+	 */
+	void setActive(uint8_t id, bool value) {
+		active[id] = value ? 1 : 0;
+		if (value) {
+			slots.acquire(id);
+		} else {
+			slots.release(id);
+		}
+	}
+};
+
+/**
+ * A single button, viewed through its slot in a {@link ButtonStore}.
+ */
 class ButtonModel {
    private:
-	/** The height of the button, as percentage down (0 = fully up) */
-	float height = 0;
-	/** The current frame of animation */
-	unsigned int frame = 0;
-	/** The angle at which the button exists */
-	float angle;
+	/** The storage holding this button */
+	std::shared_ptr<ButtonStore> store;
+	/** The index of this button in the store */
+	uint8_t id;
 	/** Pointer to the pair of this button */
-	std::shared_ptr<ButtonModel> pairButton;
-	/** ID of the pair of this button */
-	uint8_t pairID;
-	/** Whether this button is jumped on */
-	bool jumped;
-	/** Whether this model is active */
-	bool isActive;
+	std::weak_ptr<ButtonModel> pairButton;
 
    public:
 #pragma region Constructors
@@ -31,7 +83,15 @@ class ButtonModel {
 	 * Do not call this constructor using new. These models should exclusively be allocated into an
 	 * object pool by {@code ShipModel} and accessed from there.
 	 */
-	ButtonModel() : angle(-1), pairID(-1), jumped(false), isActive(false) {}
+	ButtonModel() : ButtonModel(std::make_shared<ButtonStore>(1), 0) {}
+
+	/**
+	 * Creates a view of the button in the given slot of a store.
+	 *
+	 * @param store The storage holding the button
+	 * @param id    The index of the button in the store
+	 */
+	ButtonModel(std::shared_ptr<ButtonStore> store, uint8_t id) : store(std::move(store)), id(id) {}
 
 	ButtonModel(const ButtonModel&) = delete;
 
@@ -44,17 +104,17 @@ class ButtonModel {
 	 *
 	 * @return true if the obstacle is initialized properly, false otherwise.
 	 */
-	bool init(float a, std::shared_ptr<ButtonModel> pair, uint8_t pairID);
+	bool init(float a, const std::shared_ptr<ButtonModel>& pair, uint8_t pairID);
 
 #pragma endregion
 #pragma region Accessors
 	/** Returns whether this model is active */
-	bool getIsActive() const { return isActive; }
+	bool getIsActive() const { return store->active[id] != 0; }
 
 	/**
 	 * Returns the current angle of the button in degrees.
 	 */
-	float getAngle() const { return angle; }
+	float getAngle() const { return store->angle[id]; }
 
 	/**
 	 * Returns the section of the ship containing this button.
@@ -65,22 +125,27 @@ class ButtonModel {
 	 * Returns the current height of the button, as percentage down, where 0 = fully up and 1 =
 	 * fully down
 	 */
-	float getHeight() const { return height; }
+	float getHeight() const { return store->height[id]; }
 
 	/**
 	 * Returns whether any players are jumping on this button.
 	 */
-	bool isJumpedOn() const { return jumped; }
+	bool isJumpedOn() const { return store->jumped[id] != 0; }
 
 	/**
 	 * Return a pointer to the pair of this button
 	 */
-	std::shared_ptr<ButtonModel> getPair() { return pairButton; }
+	std::shared_ptr<ButtonModel> getPair() { return pairButton.lock(); }
 
 	/**
 	 * Return the ID of the pair of this button
 	 */
-	uint8_t getPairID() const { return pairID; }
+	uint8_t getPairID() const { return store->pairID[id]; }
+
+	/**
+	 * Return the index of this button in its store
+	 */
+	uint8_t getID() const { return id; }
 
 #pragma endregion
 #pragma region Mutators
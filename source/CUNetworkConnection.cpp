@@ -42,7 +42,7 @@ class HostWrapperNetworkConnection : public NetworkConnection {
 		conn = std::make_unique<AdHocNetworkConnection>(config);
 	}
 
-	void receive(const std::function<void(const std::vector<uint8_t>&)>& dispatcher) override {
+	void receive(const std::function<void(const ByteView&)>& dispatcher) override {
 		conn->receive(dispatcher);
 
 		if (!hasConn) {
@@ -88,6 +88,8 @@ class HostWrapperNetworkConnection : public NetworkConnection {
 
 	uint8_t getTotalPlayers() const override { return conn->getTotalPlayers(); }
 
+	uint8_t getHostID() const override { return conn->getHostID(); }
+
    private:
 	bool hasConn;
 	bool isAdHoc;
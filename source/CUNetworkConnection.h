@@ -36,6 +36,53 @@ class RakPeerInterface;
 }; // namespace SLNet
 
 namespace cugl {
+/**
+ * A read-only view of a received message: a pointer and a length.
+ *
+ * Views handed to a receive() dispatcher point straight into the transport's own buffers and are
+ * only valid for the duration of the callback. Copy the message (see {@link toVector}) to keep it
+ * any longer. Vectors convert implicitly, so anything that takes a view also takes a vector.
+ */
+class ByteView {
+   private:
+	/** The first byte of the message */
+	const uint8_t* ptr;
+	/** The number of bytes in the message */
+	size_t len;
+
+   public:
+	/** Create an empty view */
+	constexpr ByteView() noexcept : ptr(nullptr), len(0) {}
+
+	/** Create a view of the given bytes */
+	constexpr ByteView(const uint8_t* data, size_t size) noexcept : ptr(data), len(size) {}
+
+	/** Create a view of the given vector, valid until the vector is modified */
+	ByteView(const std::vector<uint8_t>& vec) noexcept // NOLINT Implicit by design
+		: ptr(vec.data()), len(vec.size()) {}
+
+	/** Returns a pointer to the first byte */
+	constexpr const uint8_t* data() const noexcept { return ptr; }
+	/** Returns the number of bytes */
+	constexpr size_t size() const noexcept { return len; }
+	/** Returns whether this view has no bytes */
+	constexpr bool empty() const noexcept { return len == 0; }
+
+	/** Returns the byte at the given index, which must be less than size() */
+	constexpr uint8_t operator[](size_t index) const noexcept { return ptr[index]; }
+
+	constexpr const uint8_t* begin() const noexcept { return ptr; }
+	constexpr const uint8_t* end() const noexcept { return ptr + len; }
+
+	/** Returns the view of the bytes from the given offset on; empty if it is past the end */
+	constexpr ByteView from(size_t offset) const noexcept {
+		return offset >= len ? ByteView() : ByteView(ptr + offset, len - offset);
+	}
+
+	/** Returns a copy of the bytes that outlives this view */
+	std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(begin(), end()); }
+};
+
 /**
  * Network connection to other players with a peer-to-peer interface.
  *
@@ -50,14 +97,19 @@ namespace cugl {
  * by the host to all other players too, so the interface appears peer-to-peer.
  *
  * You can instead choose to use this as a true client-server by just checking the player ID.
- * Player ID 0 is the host, and all others are clients connected to the host. Calling send()
+ * Player ID 0 starts as the host, and all others are clients connected to the host. Calling send()
  * from the host works as usual; as a client, you may use sendOnlyToHost() in lieu of send()
  * to only send a message to the host that will not be broadcast to other players. Both the host
  * and clients receive messages via receive() as usual. Note that the host on the receiving end
  * does not know if a message was sent via send() or sendOnlyToHost().
  *
- * This class does support automatic reconnections, but does NOT support host migration.
- * If the host drops offline, the connection is closed.
+ * Connections may optionally form a mesh (see ConnectionConfig::mesh), in which case clients
+ * open direct connections to each other once they have joined, and only fall back to the host's
+ * relay for players they could not reach. This is invisible to users of this class.
+ *
+ * This class does support automatic reconnections. Host migration is only supported by a mesh:
+ * if the host of a mesh drops offline mid game, the lowest active player ID takes over and
+ * getHostID() changes. Otherwise, if the host drops offline, the connection is closed.
  */
 class NetworkConnection {
    public:
@@ -67,6 +119,7 @@ class NetworkConnection {
 	 *
 	 * To setup a NAT punchthrough server of your own, see:
 	 * https://github.com/mt-xing/nat-punchthrough-server
+	 * For a local one to test against, see tooling/room-server.cpp.
 	 */
 	struct ConnectionConfig {
 		/** Address of the NAT Punchthrough server */
@@ -83,15 +136,35 @@ class NetworkConnection {
 		 * time a backwards incompatible API change happens.
 		 */
 		uint8_t apiVersion;
+		/**
+		 * Whether clients should connect directly to each other, so that messages between clients
+		 * skip the hop through the host. Clients punch through to every other player as they
+		 * join; messages to any player that could not be reached are still relayed by the host.
+		 * Only used by the ad-hoc connection. Every player must agree on this setting.
+		 */
+		bool mesh;
+		/**
+		 * Address of the UDP relay coordinator, or nullptr for none. When punchthrough to the
+		 * host fails, the ad-hoc connection asks it for a relay server to forward its traffic
+		 * instead of giving up. See tooling/relay-server.cpp for a local relay.
+		 */
+		const char* relayServerAddr;
+		/** Port to connect on the UDP relay coordinator */
+		uint16_t relayServerPort;
 
 		constexpr ConnectionConfig(const char* punchthroughServerAddr,
 								   uint16_t punchthroughServerPort, uint16_t fallbackServerPort,
-								   uint32_t maxPlayers, uint8_t apiVer) noexcept
+								   uint32_t maxPlayers, uint8_t apiVer, bool mesh = false,
+								   const char* relayServerAddr = nullptr,
+								   uint16_t relayServerPort = 0) noexcept
 			: punchthroughServerAddr(punchthroughServerAddr),
 			  punchthroughServerPort(punchthroughServerPort),
 			  fallbackServerPort(fallbackServerPort),
 			  maxNumPlayers(maxPlayers),
-			  apiVersion(apiVer) {}
+			  apiVersion(apiVer),
+			  mesh(mesh),
+			  relayServerAddr(relayServerAddr),
+			  relayServerPort(relayServerPort) {}
 	};
 
 	/**
@@ -172,10 +245,11 @@ class NetworkConnection {
 	 * Otherwise, the library has no way to receive and process incoming connections
 	 *
 	 * @param dispatcher Function that will be called on every received byte array since the last
-	 * call to receive(). However, if the original message was sent using NetworkSerializer,
-	 * you should be using NetworkDeserializer to deserialize it.
+	 * call to receive(). The view points into the connection's receive buffers and is only valid
+	 * until the dispatcher returns; copy it to keep it. However, if the original message was sent
+	 * using NetworkSerializer, you should be using NetworkDeserializer to deserialize it.
 	 */
-	virtual void receive(const std::function<void(const std::vector<uint8_t>&)>& dispatcher) = 0;
+	virtual void receive(const std::function<void(const ByteView&)>& dispatcher) = 0;
 
 	/**
 	 * Manually disconnect from the server, while keeping the initialization state.
@@ -257,6 +331,29 @@ class NetworkConnection {
 	/** Return the number of players present when the game was started
 	 *  (including players that may have disconnected) */
 	virtual uint8_t getTotalPlayers() const = 0;
+
+	/** Return the player ID of the current host; 0 unless the host migrated */
+	virtual uint8_t getHostID() const = 0;
+
+	/** Measured quality of this player's links to the other players */
+	struct LinkStats {
+		/** Average round trip time on the slowest link, in milliseconds */
+		uint32_t rtt = 0;
+		/** Fraction of packets lost over the last second on the worst link, from 0 to 1 */
+		float loss = 0;
+		/** Bytes queued to send or waiting for an ack, across all links */
+		uint64_t queuedBytes = 0;
+
+		bool operator==(const LinkStats& other) const {
+			return rtt == other.rtt && loss == other.loss && queuedBytes == other.queuedBytes;
+		}
+	};
+
+	/**
+	 * Return the measured quality of the links to the other players, or empty if this connection
+	 * cannot measure it or has no other players to measure.
+	 */
+	virtual tl::optional<LinkStats> getLinkStats() const { return tl::nullopt; }
 #pragma endregion
 };
 }; // namespace cugl
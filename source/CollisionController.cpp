@@ -1,5 +1,6 @@
 #include "CollisionController.h"
 
+#include "DonutKinematics.h"
 #include "MagicInternetBox.h"
 #include "SoundEffectController.h"
 
@@ -13,64 +14,104 @@ constexpr float DOOR_ACTIVE_ANGLE = 15.0f;
 /** Jump height to trigger button press */
 constexpr float BUTTON_JUMP_HEIGHT = 0.1f;
 
-void breachCollisions(ShipModel& ship, uint8_t playerID) {
+/** What a collision pass over one donut may do */
+struct Pass {
+	/** Whether the donut is this player's, so its physics, face and sounds are driven here */
+	bool local;
+	/** Whether this device writes object state and broadcasts the changes */
+	bool write;
+	/** Whether the host is the only writer of object state */
+	bool authoritative;
+};
+
+/** Scratch space for the signed difference from each object of one kind to the donut */
+static std::vector<float> diffs;
+
+/**
+ * Fills diffs with the signed difference from each of the given angles to the donut.
+ *
+ * @param angles The angles of the objects
+ * @param ship   The ship the objects are on
+ * @param donut  The angle of the donut
+ */
+static void computeDiffs(const std::vector<float>& angles, const ShipModel& ship, float donut) {
+	diffs.resize(angles.size());
+	DonutKinematics::differences(angles.data(), angles.size(), donut, ship.getSize(),
+								 diffs.data());
+}
+
+void breachCollisions(ShipModel& ship, uint8_t playerID, const Pass& pass) {
 	const auto& donutModel = ship.getDonuts().at(playerID);
 	const auto& soundEffects = SoundEffectController::getInstance();
-	for (uint8_t i = 0; i < ship.getBreaches().size(); i++) {
-		auto& breach = ship.getBreaches()[i];
-		if (breach == nullptr || !breach->getIsActive()) {
+	const BreachStore& breaches = ship.getBreachStore();
+	computeDiffs(breaches.angle, ship, donutModel->getAngle());
+	for (uint8_t i = 0; i < breaches.size(); i++) {
+		if (breaches.active[i] == 0) {
 			continue;
 		}
+		auto& breach = ship.getBreaches()[i];
 
-		const float diff = ship.getAngleDifference(donutModel->getAngle(), breach->getAngle());
+		const float diff = abs(diffs[i]);
 
 		// Rolling over other player's breach
 		if (!donutModel->isJumping() && playerID != breach->getPlayer() &&
 			diff < globals::BREACH_WIDTH && breach->getHealth() != 0) {
-			soundEffects->startEvent(SoundEffectController::SLOW, i);
-			donutModel->setFriction(OTHER_BREACH_FRICTION);
-			donutModel->transitionFaceState(DonutModel::FaceState::Dizzy);
+			if (pass.local) {
+				soundEffects->startEvent(SoundEffectController::SLOW, i);
+				donutModel->setFriction(OTHER_BREACH_FRICTION);
+				donutModel->transitionFaceState(DonutModel::FaceState::Dizzy);
+			}
 
 			// Rolling over own breach
 		} else if (playerID == breach->getPlayer() && diff < EPSILON_ANGLE &&
 				   donutModel->getJumpOffset() == 0.0f && breach->getHealth() > 0) {
 			if (!breach->isPlayerOn()) {
-				soundEffects->startEvent(SoundEffectController::FIX, i);
-				breach->decHealth(1);
+				if (pass.local) {
+					soundEffects->startEvent(SoundEffectController::FIX, i);
+				}
+				if (pass.write) {
+					breach->decHealth(1);
+					MagicInternetBox::getInstance().resolveBreach(i);
+				}
 				breach->setIsPlayerOn(true);
-				MagicInternetBox::getInstance().resolveBreach(i);
 			}
-			donutModel->transitionFaceState(DonutModel::FaceState::Working);
+			if (pass.local) {
+				donutModel->transitionFaceState(DonutModel::FaceState::Working);
+			}
 
-			// Clearing breach flag
-		} else if (breach->isPlayerOn() && diff > EPSILON_ANGLE) {
+			// Clearing breach flag; with several donuts in play only the owner may clear it
+		} else if (breach->isPlayerOn() && diff > EPSILON_ANGLE &&
+				   (!pass.authoritative || playerID == breach->getPlayer())) {
 			breach->setIsPlayerOn(false);
-			if (playerID == breach->getPlayer()) {
+			if (pass.local && playerID == breach->getPlayer()) {
 				soundEffects->endEvent(SoundEffectController::FIX, i);
-			} else {
+			} else if (pass.local) {
 				soundEffects->endEvent(SoundEffectController::SLOW, i);
 			}
 		}
 	}
 }
 
-void doorCollisions(ShipModel& ship, uint8_t playerID) {
+void doorCollisions(ShipModel& ship, uint8_t playerID, const Pass& pass) {
 	const auto& donutModel = ship.getDonuts().at(playerID);
 	const auto& soundEffects = SoundEffectController::getInstance();
 
 	// Normal Door
-	for (int i = 0; i < ship.getDoors().size(); i++) {
+	const DoorStore& doors = ship.getDoorStore();
+	computeDiffs(doors.angle, ship, donutModel->getAngle());
+	for (int i = 0; i < doors.size(); i++) {
+		if (doors.active[i] == 0) {
+			continue;
+		}
 		auto& door = ship.getDoors()[i];
-		if (door == nullptr || door->halfOpen() || !door->getIsActive()) {
+		if (door->halfOpen()) {
 			continue;
 		}
 
-		float diff = donutModel->getAngle() - door->getAngle();
-		const float a = diff + ship.getSize() / 2;
-		diff = a - floor(a / ship.getSize()) * ship.getSize() - ship.getSize() / 2;
+		const float diff = diffs[i];
 
-		// Stop donut and push it out if inside
-		if (abs(diff) < globals::DOOR_WIDTH) {
+		// Stop donut and push it out if inside; remote donuts push themselves out
+		if (pass.local && abs(diff) < globals::DOOR_WIDTH) {
 			soundEffects->startEvent(SoundEffectController::DOOR, i);
 			donutModel->setVelocity(0);
 			if (diff < 0) {
@@ -80,22 +121,37 @@ void doorCollisions(ShipModel& ship, uint8_t playerID) {
 				const float proposedAngle = door->getAngle() + globals::DOOR_WIDTH;
 				donutModel->setAngle(proposedAngle >= ship.getSize() ? 0 : proposedAngle);
 			}
+			// The donut moved, so the remaining doors must be measured from its new angle
+			computeDiffs(doors.angle, ship, donutModel->getAngle());
 		}
 
 		// Active Door
 		if (abs(diff) < DOOR_ACTIVE_ANGLE) {
-			door->addPlayer(playerID);
-			MagicInternetBox::getInstance().flagDualTask(i, playerID, 1);
-			donutModel->transitionFaceState(DonutModel::FaceState::Colliding);
+			if (pass.write) {
+				door->addPlayer(playerID);
+				MagicInternetBox::getInstance().flagDualTask(i, playerID, 1);
+			}
+			if (pass.local) {
+				donutModel->transitionFaceState(DonutModel::FaceState::Colliding);
+			}
 
 			// Inactive Door
 		} else if (door->isPlayerOn(playerID)) {
-			soundEffects->endEvent(SoundEffectController::DOOR, i);
-			door->removePlayer(playerID);
-			MagicInternetBox::getInstance().flagDualTask(i, playerID, 0);
+			if (pass.local) {
+				soundEffects->endEvent(SoundEffectController::DOOR, i);
+			}
+			if (pass.write) {
+				door->removePlayer(playerID);
+				MagicInternetBox::getInstance().flagDualTask(i, playerID, 0);
+			}
 		}
 	}
 
+	// Unopenable doors hold no shared state, so only the local donut needs them
+	if (!pass.local) {
+		return;
+	}
+
 	// Unopenable Door
 	for (int i = 0; i < ship.getUnopenable().size(); i++) {
 		auto& door = ship.getUnopenable()[i];
@@ -129,23 +185,20 @@ void doorCollisions(ShipModel& ship, uint8_t playerID) {
 	}
 }
 
-void buttonCollisions(ShipModel& ship, uint8_t playerID) {
+void buttonCollisions(ShipModel& ship, uint8_t playerID, const Pass& pass) {
 	const auto& donutModel = ship.getDonuts().at(playerID);
-	for (int i = 0; i < ship.getButtons().size(); i++) {
-		auto& button = ship.getButtons().at(i);
-
-		if (button == nullptr || !button->getIsActive()) {
+	const ButtonStore& buttons = ship.getButtonStore();
+	computeDiffs(buttons.angle, ship, donutModel->getAngle());
+	for (int i = 0; i < buttons.size(); i++) {
+		if (buttons.active[i] == 0) {
 			continue;
 		}
 
-		button->update();
-
-		float diff = donutModel->getAngle() - button->getAngle();
-		const float shipSize = ship.getSize();
-		const float a = diff + shipSize / 2;
-		diff = a - floor(a / shipSize) * shipSize - shipSize / 2;
+		if (pass.local) {
+			ship.getButtons()[i]->update();
+		}
 
-		if (abs(diff) > globals::BUTTON_ACTIVE_ANGLE) {
+		if (!pass.write || abs(diffs[i]) > globals::BUTTON_ACTIVE_ANGLE) {
 			continue;
 		}
 
@@ -155,7 +208,7 @@ void buttonCollisions(ShipModel& ship, uint8_t playerID) {
 
 		if (ship.flagButton(i)) {
 			MagicInternetBox::getInstance().flagButton(i);
-			if (button->getPair()->isJumpedOn()) {
+			if (buttons.jumped[buttons.pairID[i]] != 0) {
 				CULog("Resolving button");
 				ship.resolveButton(i);
 				MagicInternetBox::getInstance().resolveButton(i);
@@ -164,8 +217,26 @@ void buttonCollisions(ShipModel& ship, uint8_t playerID) {
 	}
 }
 
-void CollisionController::updateCollisions(ShipModel& ship, uint8_t playerID) {
-	breachCollisions(ship, playerID);
-	doorCollisions(ship, playerID);
-	buttonCollisions(ship, playerID);
+void CollisionController::updateCollisions(ShipModel& ship, uint8_t playerID, bool authoritative,
+										   bool host) {
+	const Pass local = {true, !authoritative || host, authoritative};
+	breachCollisions(ship, playerID, local);
+	doorCollisions(ship, playerID, local);
+	buttonCollisions(ship, playerID, local);
+
+	if (!authoritative || !host) {
+		return;
+	}
+
+	// As the single writer, the host also resolves every other donut at its reported position
+	const Pass remote = {false, true, true};
+	const auto& donuts = ship.getDonuts();
+	for (uint8_t i = 0; i < donuts.size(); i++) {
+		if (i == playerID || !donuts[i]->getIsActive()) {
+			continue;
+		}
+		breachCollisions(ship, i, remote);
+		doorCollisions(ship, i, remote);
+		buttonCollisions(ship, i, remote);
+	}
 }
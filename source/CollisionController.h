@@ -7,6 +7,20 @@
 
 class CollisionController {
    public:
-	static void updateCollisions(ShipModel& ship, uint8_t playerID);
+	/**
+	 * Runs collisions between this player's donut and every object on the ship.
+	 *
+	 * Normally each player resolves the objects under its own donut and broadcasts the result. In
+	 * authoritative mode the host is the only writer of object state: it resolves collisions for
+	 * every active donut from its reported position, while other players only drive the physics,
+	 * face and sounds of their own donut and wait for the host's broadcasts.
+	 *
+	 * @param ship          The ship
+	 * @param playerID      This player's ID
+	 * @param authoritative Whether the host is the only writer of object state
+	 * @param host          Whether this player is the host
+	 */
+	static void updateCollisions(ShipModel& ship, uint8_t playerID, bool authoritative = false,
+								 bool host = false);
 };
 #endif // COLLISION_CONTROLLER
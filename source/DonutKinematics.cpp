@@ -0,0 +1,94 @@
+#include "DonutKinematics.h"
+
+#include <cmath>
+
+DonutKinematics::DonutKinematics() : count(0) {
+	angle.fill(0);
+	velocity.fill(0);
+	active.fill(0);
+}
+
+void DonutKinematics::gather(const std::vector<std::shared_ptr<DonutModel>>& donuts) {
+	count = donuts.size() < LANES ? donuts.size() : LANES;
+	for (size_t i = 0; i < count; i++) {
+		const auto& donut = donuts[i];
+		angle[i] = donut->getAngle();
+		velocity[i] = donut->getVelocity();
+		active[i] = donut->getIsActive() ? 1.0f : 0.0f;
+	}
+	for (size_t i = count; i < LANES; i++) {
+		angle[i] = 0;
+		velocity[i] = 0;
+		active[i] = 0;
+	}
+}
+
+bool DonutKinematics::allRolling(bool left) const {
+	// A donut fails if it is active and its velocity is not strictly in the right direction
+	const float sign = left ? -1.0f : 1.0f;
+#if defined(CU_MATH_VECTOR_SSE)
+	const __m128 dir = _mm_set1_ps(sign);
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = 0; i < LANES; i += 4) {
+		const __m128 speed = _mm_mul_ps(_mm_load_ps(velocity.data() + i), dir);
+		const __m128 on = _mm_cmpgt_ps(_mm_load_ps(active.data() + i), zero);
+		const __m128 fail = _mm_and_ps(_mm_cmple_ps(speed, zero), on);
+		if (_mm_movemask_ps(fail) != 0) {
+			return false;
+		}
+	}
+	return true;
+#elif defined(CU_MATH_VECTOR_NEON64)
+	const float32x4_t dir = vdupq_n_f32(sign);
+	const float32x4_t zero = vdupq_n_f32(0);
+	for (size_t i = 0; i < LANES; i += 4) {
+		const float32x4_t speed = vmulq_f32(vld1q_f32(velocity.data() + i), dir);
+		const uint32x4_t on = vcgtq_f32(vld1q_f32(active.data() + i), zero);
+		const uint32x4_t fail = vandq_u32(vcleq_f32(speed, zero), on);
+		if (vmaxvq_u32(fail) != 0) {
+			return false;
+		}
+	}
+	return true;
+#else
+	bool fail = false;
+	for (size_t i = 0; i < LANES; i++) {
+		fail |= active[i] > 0 && velocity[i] * sign <= 0;
+	}
+	return !fail;
+#endif
+}
+
+void DonutKinematics::differences(const float* angles, size_t count, float from, float size,
+								  float* out) {
+	// Shift by half the ship so that floor wraps the difference into [-size/2, size/2)
+	const float half = size / 2;
+	const float shift = from + half;
+	const float inv = 1 / size;
+	size_t i = 0;
+#if defined(CU_MATH_VECTOR_SSE)
+	const __m128 vshift = _mm_set1_ps(shift);
+	const __m128 vhalf = _mm_set1_ps(half);
+	const __m128 vsize = _mm_set1_ps(size);
+	const __m128 vinv = _mm_set1_ps(inv);
+	for (; i + 4 <= count; i += 4) {
+		const __m128 a = _mm_sub_ps(vshift, _mm_loadu_ps(angles + i));
+		const __m128 wraps = _mm_floor_ps(_mm_mul_ps(a, vinv));
+		_mm_storeu_ps(out + i, _mm_sub_ps(_mm_sub_ps(a, _mm_mul_ps(wraps, vsize)), vhalf));
+	}
+#elif defined(CU_MATH_VECTOR_NEON64)
+	const float32x4_t vshift = vdupq_n_f32(shift);
+	const float32x4_t vhalf = vdupq_n_f32(half);
+	const float32x4_t vsize = vdupq_n_f32(size);
+	const float32x4_t vinv = vdupq_n_f32(inv);
+	for (; i + 4 <= count; i += 4) {
+		const float32x4_t a = vsubq_f32(vshift, vld1q_f32(angles + i));
+		const float32x4_t wraps = vrndmq_f32(vmulq_f32(a, vinv));
+		vst1q_f32(out + i, vsubq_f32(vsubq_f32(a, vmulq_f32(wraps, vsize)), vhalf));
+	}
+#endif
+	for (; i < count; i++) {
+		const float a = shift - angles[i];
+		out[i] = a - std::floor(a * inv) * size - half;
+	}
+}
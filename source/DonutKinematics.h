@@ -0,0 +1,82 @@
+#ifndef DONUT_KINEMATICS_H
+#define DONUT_KINEMATICS_H
+#include <cugl/cugl.h>
+
+#include <array>
+
+#include "DonutModel.h"
+#include "Globals.h"
+
+/**
+ * The angle, velocity and activity of every donut, packed into aligned float arrays.
+ *
+ * This is gathered from the donut models once per frame, so that predicates over all donuts (e.g.
+ * whether every active donut is rolling one way) run as a few vector instructions instead of a
+ * walk through shared pointers. The same file holds the batch angle kernels used for collisions.
+ *
+ * The kernels use SSE or NEON when cugl enables them (see CU_MATH_VECTOR_SSE and
+ * CU_MATH_VECTOR_NEON64), and fall back to plain loops otherwise.
+ */
+class DonutKinematics {
+   public:
+	/** The number of lanes, which is MAX_PLAYERS rounded up to a whole number of vectors */
+	static constexpr size_t LANES = (globals::MAX_PLAYERS + 3) / 4 * 4;
+
+   private:
+	/** The angle of each donut */
+	alignas(16) std::array<float, LANES> angle;
+	/** The velocity of each donut */
+	alignas(16) std::array<float, LANES> velocity;
+	/** 1 for each active donut, 0 for inactive donuts and unused lanes */
+	alignas(16) std::array<float, LANES> active;
+	/** The number of donuts */
+	size_t count;
+
+   public:
+	/**
+	 * Creates an empty batch with no donuts.
+	 */
+	DonutKinematics();
+
+	/**
+	 * Copies the state of the given donuts into this batch.
+	 *
+	 * Donuts past {@link LANES} are ignored.
+	 *
+	 * @param donuts The donuts to gather
+	 */
+	void gather(const std::vector<std::shared_ptr<DonutModel>>& donuts);
+
+	/**
+	 * Returns the number of donuts in this batch.
+	 */
+	size_t size() const { return count; }
+
+	/**
+	 * Returns whether every active donut is rolling in the given direction.
+	 *
+	 * A donut that is standing still is not rolling either way. This is true if no donut is
+	 * active.
+	 *
+	 * @param left Whether to check for rolling left (negative velocity) rather than right
+	 */
+	bool allRolling(bool left) const;
+
+	/**
+	 * Computes the signed difference from each of the given angles to one angle, wrapped into
+	 * [-size/2, size/2).
+	 *
+	 * out[i] is positive if from is counterclockwise of angles[i]. The arrays may be unaligned and
+	 * of any length; out may alias angles.
+	 *
+	 * @param angles The angles to measure from
+	 * @param count  The number of angles
+	 * @param from   The angle to measure to
+	 * @param size   The size of the ship
+	 * @param out    The array to store the differences
+	 */
+	static void differences(const float* angles, size_t count, float from, float size,
+							float* out);
+};
+
+#endif /* DONUT_KINEMATICS_H */
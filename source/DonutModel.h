@@ -170,6 +170,15 @@ class DonutModel {
 	 */
 	virtual void setAngle(float value) { angle = value; }
 
+	/**
+	 * Sets the number of frames between network updates of this donut.
+	 *
+	 * Donuts moved over the network ease towards each update over this many frames.
+	 *
+	 * @param frames The number of frames until the next update is expected
+	 */
+	virtual void setNetworkTick(unsigned int /*frames*/) {}
+
 	/**
 	 * Sets the angle after teleportation in degrees.
 	 * @param a
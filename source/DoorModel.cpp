@@ -8,8 +8,8 @@ constexpr unsigned int HALF_OPEN = 400;
 constexpr unsigned int SPEED = 20;
 
 bool DoorModel::init(float a) {
-	this->angle = a;
-	isActive = true;
+	store->angle[id] = a;
+	store->setActive(id, true);
 	return true;
 }
 
@@ -22,14 +22,14 @@ bool DoorModel::init(float a) {
 void DoorModel::dispose() {}
 
 void DoorModel::reset() {
-	playersOn.reset();
-	height = 0;
-	isActive = false;
+	store->playersOn[id].reset();
+	store->height[id] = 0;
+	store->setActive(id, false);
 }
 
 void DoorModel::removePlayer(uint8_t id) {
 	if (!resolved()) {
-		playersOn.reset(id);
+		store->playersOn[this->id].reset(id);
 	}
 }
 
@@ -41,6 +41,7 @@ void DoorModel::update(float timestep) { // NOLINT assuming 60fps
 		return;
 	}
 
+	unsigned int& height = store->height[id];
 	if (height < MAX_HEIGHT) {
 		height += SPEED;
 	}
@@ -49,6 +50,6 @@ void DoorModel::update(float timestep) { // NOLINT assuming 60fps
 	}
 }
 
-bool DoorModel::halfOpen() const { return height >= HALF_OPEN; }
+bool DoorModel::halfOpen() const { return store->height[id] >= HALF_OPEN; }
 
-bool DoorModel::resolvedAndRaised() const { return resolved() && height >= MAX_HEIGHT; }
+bool DoorModel::resolvedAndRaised() const { return resolved() && store->height[id] >= MAX_HEIGHT; }
@@ -3,38 +3,89 @@
 #include <cugl/cugl.h>
 
 #include <bitset>
+#include <vector>
 
+#include "FreeSlots.h"
 #include "Globals.h"
 
+/**
+ * Packed storage for every door on the ship.
+ *
+ * Each field lives in its own array, indexed by door id. {@link DoorModel} is a view of one slot.
+ */
+struct DoorStore {
+	/** The angle at which each door exists */
+	std::vector<float> angle;
+	/** The height of each door */
+	std::vector<unsigned int> height;
+	/** The players on each door */
+	std::vector<std::bitset<globals::MAX_PLAYERS>> playersOn;
+	/** Whether or not each door is active; only change through setActive */
+	std::vector<uint8_t> active;
+	/** The ids of the inactive doors */
+	FreeSlots slots;
+
+	/**
+	 * Creates storage for the given number of inactive doors.
+	 *
+	 * @param size The number of doors
+	 */
+	explicit DoorStore(size_t size = 0)
+		: angle(size, 0), height(size, 0), playersOn(size), active(size, 0), slots(size) {}
+
+	/** Returns the number of doors */
+	size_t size() const { return angle.size(); }
+
+	/**
+	 * Activates or deactivates a door, keeping the free ids up to date.
+	 *
+	 * @param id    The door id
+	 * @param value Whether the door is active
+	 */
+	void setActive(uint8_t id, bool value) {
+		active[id] = value ? 1 : 0;
+		if (value) {
+			slots.acquire(id);
+		} else {
+			slots.release(id);
+		}
+	}
+};
+
+/**
+ * A single door, viewed through its slot in a {@link DoorStore}.
+ */
 class DoorModel {
    private:
-	/** The height of the door */
-	unsigned int height = 0;
-	/** Whether or not this object is active */
-	bool isActive;
-
-   protected:
-	/** The angle at which the door exists */
-	float angle;
-	/** The state of the door */
-	std::bitset<globals::MAX_PLAYERS> playersOn;
+	/** The storage holding this door */
+	std::shared_ptr<DoorStore> store;
+	/** The index of this door in the store */
+	uint8_t id;
 
    public:
 #pragma mark Constructors
 	/*
-	 * Creates a new door at angle 0.
+	 * Creates a new door at angle 0, with storage of its own.
 	 *
 	 * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a model on
 	 * the heap, use one of the static constructors instead.
 	 */
-	DoorModel() : isActive(false), angle(0) {}
+	DoorModel() : DoorModel(std::make_shared<DoorStore>(1), 0) {}
+
+	/**
+	 * Creates a view of the door in the given slot of a store.
+	 *
+	 * @param store The storage holding the door
+	 * @param id    The index of the door in the store
+	 */
+	DoorModel(std::shared_ptr<DoorStore> store, uint8_t id) : store(std::move(store)), id(id) {}
 
 	DoorModel(const DoorModel&) = delete;
 
 	/**
 	 * Destroys this door, releasing all resources.
 	 */
-	virtual ~DoorModel() { dispose(); }
+	~DoorModel() { dispose(); }
 
 	/**
 	 * Disposes all resources and assets of this door
@@ -55,7 +106,7 @@ class DoorModel {
 	 *
 	 * @return true if the obstacle is initialized properly, false otherwise.
 	 */
-	virtual bool init(float a);
+	bool init(float a);
 
 #pragma mark -
 #pragma mark Accessors
@@ -64,33 +115,33 @@ class DoorModel {
 	 *
 	 * @return the current angle of the door in degrees.
 	 */
-	float getAngle() const { return angle; }
+	float getAngle() const { return store->angle[id]; }
 
 	/**
 	 * Returns whether the breach is currently active.
 	 *
 	 * @return whether the breach is currently active.
 	 */
-	bool getIsActive() const { return isActive; }
+	bool getIsActive() const { return store->active[id] != 0; }
 
 	/**
 	 * Returns the current height of the door.
 	 *
 	 * @return the current height of the door.
 	 */
-	unsigned int getHeight() const { return height; }
+	unsigned int getHeight() const { return store->height[id]; }
 
 	/**
 	 * Returns the number of players in range of the door.
 	 *
 	 * @return the number of players in range of the door.
 	 */
-	uint8_t getPlayersOn() const { return static_cast<uint8_t>(playersOn.count()); }
+	uint8_t getPlayersOn() const { return static_cast<uint8_t>(store->playersOn[id].count()); }
 
 	/**
 	 * Adds the given player's flag from the door.
 	 */
-	void addPlayer(uint8_t id) { playersOn.set(id); }
+	void addPlayer(uint8_t id) { store->playersOn[this->id].set(id); }
 
 	/**
 	 * Removes the given player's flag from the door. Requires that this player is on the door
@@ -115,7 +166,7 @@ class DoorModel {
 	/**
 	 * Returns whether this player is on the door.
 	 */
-	bool isPlayerOn(uint8_t id) const { return playersOn.test(id); }
+	bool isPlayerOn(uint8_t id) const { return store->playersOn[this->id].test(id); }
 
 	/**
 	 * Returns whether this door is resolved.
@@ -126,5 +177,10 @@ class DoorModel {
 	 * Resets this door.
 	 */
 	void reset();
+
+	/**
+	 * Returns the index of this door in its store.
+	 */
+	uint8_t getID() const { return id; }
 };
 #endif /* DOOR_MODEL_H */
@@ -10,7 +10,8 @@ constexpr float END_DONUT = 1.0f - BEG_DONUT;
 bool ExternalDonutModel::init(const cugl::Vec2& pos, float shipSize) {
 	const bool ret = DonutModel::init(pos, shipSize);
 	// Initialize with finished interpolation
-	networkMove.framesSinceUpdate = globals::NETWORK_TICK;
+	networkMove.tick = globals::NETWORK_TICK;
+	networkMove.framesSinceUpdate = networkMove.tick;
 	return ret;
 }
 
@@ -21,12 +22,18 @@ void ExternalDonutModel::setAngle(float value) {
 	networkMove.angle = newAngle;
 }
 
+void ExternalDonutModel::setNetworkTick(unsigned int frames) {
+	if (frames > 0) {
+		networkMove.tick = frames;
+	}
+}
+
 void ExternalDonutModel::update(float timestep) {
 	networkMove.framesSinceUpdate++;
-	if (networkMove.framesSinceUpdate < globals::NETWORK_TICK) {
+	if (networkMove.framesSinceUpdate < networkMove.tick) {
 		// Interpolate position
 		const float percent =
-			static_cast<float>(networkMove.framesSinceUpdate) / globals::NETWORK_TICK;
+			static_cast<float>(networkMove.framesSinceUpdate) / networkMove.tick;
 		networkMove.oldAngle += velocity;
 		networkMove.angle += velocity;
 
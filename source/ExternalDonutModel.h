@@ -12,10 +12,15 @@ class ExternalDonutModel : public DonutModel {
 	struct NetworkMovementData {
 		/**
 		 * Number of frames passed since the last network update.
-		 * If greater than or equal to NETWORK_TICK, then position should be aligned.
+		 * If greater than or equal to tick, then position should be aligned.
 		 */
 		unsigned int framesSinceUpdate;
 
+		/**
+		 * Number of frames between network updates, as reported by the owner of the donut.
+		 */
+		unsigned int tick;
+
 		/**
 		 * The actual angle of the donut, computed from the last network update position.
 		 */
@@ -80,6 +85,8 @@ class ExternalDonutModel : public DonutModel {
 
 	void setAngle(float value) override;
 
+	void setNetworkTick(unsigned int frames) override;
+
 	/**
 	 * Updates the state of the model
 	 *
@@ -0,0 +1,99 @@
+#ifndef FREE_SLOTS_H
+#define FREE_SLOTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The set of unused ids in a pool of ship objects.
+ *
+ * Objects mark themselves used or free as they are activated and deactivated, so the set is
+ * always current without ever rescanning the pool. Every operation is O(1).
+ */
+class FreeSlots {
+   private:
+	/** The free ids, in no particular order */
+	std::vector<uint8_t> ids;
+	/** The position of each id in ids, or -1 if it is in use */
+	std::vector<int> position;
+
+   public:
+	/**
+	 * Creates a set in which all of the given number of ids are free.
+	 *
+	 * @param size The number of ids
+	 */
+	explicit FreeSlots(size_t size = 0) { reset(size); }
+
+	/**
+	 * Marks all of the given number of ids as free.
+	 *
+	 * Ids are handed out by {@link take} lowest first until some are released.
+	 *
+	 * @param size The number of ids
+	 */
+	void reset(size_t size) {
+		ids.clear();
+		position.assign(size, -1);
+		for (size_t i = size; i > 0; i--) {
+			position[i - 1] = static_cast<int>(ids.size());
+			ids.push_back(static_cast<uint8_t>(i - 1));
+		}
+	}
+
+	/**
+	 * Marks the given id as free. Does nothing if it is already free.
+	 *
+	 * @param id The id to release
+	 */
+	void release(uint8_t id) {
+		if (position[id] < 0) {
+			position[id] = static_cast<int>(ids.size());
+			ids.push_back(id);
+		}
+	}
+
+	/**
+	 * Marks the given id as in use. Does nothing if it is already in use.
+	 *
+	 * @param id The id to acquire
+	 */
+	void acquire(uint8_t id) {
+		const int pos = position[id];
+		if (pos < 0) {
+			return;
+		}
+		const uint8_t last = ids.back();
+		ids[pos] = last;
+		position[last] = pos;
+		ids.pop_back();
+		position[id] = -1;
+	}
+
+	/**
+	 * Acquires and returns a free id, or -1 if there are none.
+	 */
+	int take() {
+		if (ids.empty()) {
+			return -1;
+		}
+		const uint8_t id = ids.back();
+		acquire(id);
+		return id;
+	}
+
+	/**
+	 * Returns whether the given id is free.
+	 *
+	 * @param id The id to check
+	 */
+	bool isFree(uint8_t id) const { return position[id] >= 0; }
+
+	/**
+	 * Returns the number of free ids.
+	 */
+	size_t size() const { return ids.size(); }
+};
+
+#endif /* FREE_SLOTS_H */
@@ -1,5 +1,6 @@
 ﻿#include "GLaDOS.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace cugl;
@@ -11,8 +12,23 @@ constexpr float STABILIZER_TIMEOUT = 10.0f;
 /** Time to wait until sending the first stabilizer, in tutorial. */
 constexpr float STABILIZER_START = 2.0f;
 
-/** Time to wait until sending another stabilizer, in tutorial. */
-constexpr int MAX_ATTEMPTS = 120;
+/** The frame rate the per-frame event probabilities in level files were tuned for */
+constexpr float EVENT_FRAMERATE = 60.0f;
+
+/** Maximum number of due events waiting to be placed */
+constexpr size_t MAX_READY = 16;
+
+/** Maximum number of times to try placing a repeating event before giving up on it */
+constexpr int MAX_RETRIES = 4;
+
+/** Delay before retrying a blocked event, doubled after each further failure */
+constexpr float RETRY_DELAY = 0.25f;
+
+/** Size of the start of a checkpoint: random draws, custom event counter, and ready count */
+constexpr size_t CHECKPOINT_HEADER = 6;
+
+/** Size of each ready event in a checkpoint: event index and attempts */
+constexpr size_t CHECKPOINT_READY = 3;
 #pragma mark -
 #pragma mark GM
 /**
@@ -23,8 +39,6 @@ constexpr int MAX_ATTEMPTS = 120;
  */
 GLaDOS::GLaDOS()
 	: active(false),
-	  // NOLINTNEXTLINE This ain't the NSA; we don't need better security than this
-	  rand(static_cast<unsigned int>(time(nullptr))),
 	  mib(MagicInternetBox::getInstance()),
 	  maxEvents(0),
 	  levelNum(0),
@@ -65,23 +79,12 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship,
 	blocks = level->getBlocks();
 	events = level->getEvents();
 	readyQueue.clear();
-	std::queue<int> empty1;
-	std::queue<int> empty2;
-	std::queue<int> empty3;
-	std::swap(breachFree, empty1);
-	std::swap(doorFree, empty2);
-	std::swap(buttonFree, empty3);
-
-	for (int i = 0; i < maxEvents; i++) {
-		breachFree.push(i);
-	}
-	for (int i = 0; i < maxDoors; i++) {
-		doorFree.push(i);
-	}
-	for (int i = 0; i < maxButtons; i++) {
-		buttonFree.push(i);
+	stats = SchedulerStats();
+	const float now = ship->timePassedIgnoringFreeze();
+	scheduler.clear(now);
+	for (int i = 0; i < events.size(); i++) {
+		scheduleEvent(i, now);
 	}
-
 	active = success;
 	return success;
 }
@@ -97,6 +100,9 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship,
 bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship, const int levelNum) {
 	const bool success = true;
 	readyQueue.clear();
+	events.clear();
+	scheduler.clear();
+	stats = SchedulerStats();
 	this->ship = ship;
 	this->levelNum = levelNum;
 	CULog("Starting level %d", levelNum);
@@ -114,22 +120,6 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship, const int levelNum) {
 	ship->setTimeless(true);
 	ship->initTimer(1);
 	ship->setLevelNum(levelNum);
-	std::queue<int> empty1;
-	std::queue<int> empty2;
-	std::queue<int> empty3;
-	std::swap(breachFree, empty1);
-	std::swap(doorFree, empty2);
-	std::swap(buttonFree, empty3);
-	for (int i = 0; i < maxEvents; i++) {
-		breachFree.push(i);
-	}
-	for (int i = 0; i < maxDoors; i++) {
-		doorFree.push(i);
-	}
-	for (int i = 0; i < maxButtons; i++) {
-		buttonFree.push(i);
-	}
-
 	active = success;
 	if (unop > 0 || levelNum == tutorial::DOOR_LEVEL) {
 		ship->separateDonuts();
@@ -144,9 +134,7 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship, const int levelNum) {
 			for (int i = 0; i < maxDoors; i++) {
 				const float angle = size / (static_cast<float>(maxDoors) * 2) +
 									(size * static_cast<float>(i)) / static_cast<float>(maxDoors);
-				const int j = doorFree.front();
-				doorFree.pop();
-				ship->createDoor(angle, j);
+				ship->createDoor(angle, ship->getFreeDoors().take());
 			}
 			break;
 		case tutorial::BUTTON_LEVEL:
@@ -154,10 +142,8 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship, const int levelNum) {
 				const float angle = size / (static_cast<float>(unop) * 2) +
 									(size * static_cast<float>(i)) / static_cast<float>(unop);
 				// Find usable button IDs
-				const int k = buttonFree.front();
-				buttonFree.pop();
-				const int j = buttonFree.front();
-				buttonFree.pop();
+				const int k = ship->getFreeButtons().take();
+				const int j = ship->getFreeButtons().take();
 
 				// Dispatch challenge creation
 				ship->createButton(angle + tutorial::BUTTON_PADDING, k,
@@ -173,6 +159,94 @@ bool GLaDOS::init(const std::shared_ptr<ShipModel>& ship, const int levelNum) {
 	return success;
 }
 
+bool GLaDOS::resume(const std::shared_ptr<ShipModel>& ship,
+					const std::shared_ptr<LevelModel>& level, const cugl::ByteView& checkpoint) {
+	this->ship = ship;
+	levelNum = mib.getLevelNum().value();
+	maxEvents = static_cast<int>(ship->getBreaches().size());
+	maxDoors = static_cast<int>(ship->getDoors().size());
+	maxButtons = static_cast<int>(ship->getButtons().size());
+	blocks = level->getBlocks();
+	events = level->getEvents();
+	stats = SchedulerStats();
+	restore(checkpoint);
+
+	// Event arrivals are memoryless, so scheduling every event afresh from now loses nothing
+	const float now = ship->timePassedIgnoringFreeze();
+	scheduler.clear(now);
+	for (int i = 0; i < events.size(); i++) {
+		const bool ready =
+			std::any_of(readyQueue.begin(), readyQueue.end(),
+						[i](const TimingWheel::Timer& timer) { return timer.id == i; });
+		if (!ready) {
+			scheduleEvent(i, now);
+		}
+	}
+	CULog("Resumed GM with %zu events ready", readyQueue.size());
+	active = true;
+	return true;
+}
+
+bool GLaDOS::resume(const std::shared_ptr<ShipModel>& ship, const int levelNum,
+					const cugl::ByteView& checkpoint) {
+	events.clear();
+	scheduler.clear();
+	stats = SchedulerStats();
+	this->ship = ship;
+	this->levelNum = levelNum;
+	// Sections were laid out for everyone present at the start, including the old host
+	sections = static_cast<int>(tutorial::SECTIONED.at(levelNum)) *
+			   static_cast<int>(mib.getMaxNumPlayers());
+	customEventCtr = static_cast<int>(tutorial::CUSTOM_EVENTS.at(levelNum));
+	stabilizerStart = -STABILIZER_TIMEOUT;
+	restore(checkpoint);
+	CULog("Resumed tutorial level %d", levelNum);
+	active = true;
+	return true;
+}
+
+void GLaDOS::checkpoint(std::vector<uint8_t>& data) const {
+	// [ draws (4 bytes) | custom event counter | ready count | (event (2 bytes) | attempts)* ]
+	const uint32_t draws = rand.getDraws();
+	for (unsigned int i = 0; i < 4; i++) {
+		data.push_back(static_cast<uint8_t>(draws >> (8 * i)));
+	}
+	data.push_back(static_cast<uint8_t>(static_cast<int8_t>(customEventCtr)));
+	data.push_back(static_cast<uint8_t>(readyQueue.size()));
+	for (const auto& timer : readyQueue) {
+		data.push_back(static_cast<uint8_t>(timer.id));
+		data.push_back(static_cast<uint8_t>(timer.id >> 8));
+		data.push_back(static_cast<uint8_t>(timer.attempts));
+	}
+}
+
+void GLaDOS::restore(const cugl::ByteView& checkpoint) {
+	readyQueue.clear();
+	if (checkpoint.size() < CHECKPOINT_HEADER) {
+		CULog("No GM checkpoint; starting from a fresh random stream");
+		return;
+	}
+	uint32_t draws = 0;
+	for (unsigned int i = 0; i < 4; i++) {
+		draws |= static_cast<uint32_t>(checkpoint[i]) << (8 * i);
+	}
+	rand.skipTo(draws);
+	customEventCtr = static_cast<int8_t>(checkpoint[4]);
+
+	const float now = ship->timePassedIgnoringFreeze();
+	const size_t ready = checkpoint[5];
+	for (size_t i = 0; i < ready; i++) {
+		const size_t offset = CHECKPOINT_HEADER + i * CHECKPOINT_READY;
+		if (offset + CHECKPOINT_READY > checkpoint.size()) {
+			break;
+		}
+		const int id = checkpoint[offset] | (checkpoint[offset + 1] << 8);
+		if (id < events.size()) {
+			readyQueue.push_back({id, checkpoint[offset + 2], now});
+		}
+	}
+}
+
 /**
  * Places an object in the game. Requires that enough resources are present.
  *
@@ -203,56 +277,25 @@ void GLaDOS::placeObject(BuildingBlockModel::Object obj, float zeroAngle, int p)
 	}
 	switch (obj.type) {
 		case BuildingBlockModel::Breach:
-			i = breachFree.front();
-			breachFree.pop();
+			i = ship->getFreeBreaches().take();
 			ship->createBreach(objAngle, p, i);
 			mib.createBreach(objAngle, p, i);
 			break;
 		case BuildingBlockModel::Door:
-			i = doorFree.front();
-			doorFree.pop();
+			i = ship->getFreeDoors().take();
 			ship->createDoor(objAngle, i);
 			mib.createDualTask(objAngle, i);
 			break;
 		case BuildingBlockModel::Button: {
-			// Roll for pair's angle
-			const float origAngle = objAngle;
-			float pairAngle = 0;
-			int attempts = 0;
-			bool goodAngle = false;
-			do {
-				pairAngle = static_cast<float>(rand() % static_cast<int>(ship->getSize()));
-				goodAngle = ship->getAngleDifference(pairAngle, origAngle) >= globals::BUTTON_WIDTH;
-				for (unsigned int k = 0; goodAngle && k < ship->getBreaches().size(); k++) {
-					const float breachAngle = ship->getBreaches()[k]->getAngle();
-					const float diff = ship->getAngleDifference(breachAngle, pairAngle);
-					if (ship->getBreaches()[k]->getIsActive() &&
-						diff < globals::BUTTON_ACTIVE_ANGLE) {
-						goodAngle = false;
-						break;
-					}
-				}
-
-				for (unsigned int k = 0; goodAngle && k < ship->getDoors().size(); k++) {
-					const float doorAngle = ship->getDoors()[k]->getAngle();
-					const float diff = ship->getAngleDifference(doorAngle, pairAngle);
-					if (ship->getDoors()[k]->getIsActive() && diff < globals::BUTTON_WIDTH) {
-						goodAngle = false;
-						break;
-					}
-				}
-				for (unsigned int k = 0; goodAngle && k < ship->getButtons().size(); k++) {
-					const float buttonAngle = ship->getButtons()[k]->getAngle();
-					const float diff = ship->getAngleDifference(buttonAngle, pairAngle);
-					if (ship->getButtons()[k]->getIsActive() && diff < globals::BUTTON_WIDTH) {
-						goodAngle = false;
-						break;
-					}
-				}
-				attempts++;
-			} while (attempts < MAX_ATTEMPTS && !goodAngle);
-			if (goodAngle) {
-				placeButtons(origAngle, pairAngle);
+			// Pick the pair's angle from the free space left on the ship
+			ship->indexObjects(freeSpace, globals::BUTTON_ACTIVE_ANGLE, globals::BUTTON_WIDTH,
+							   globals::BUTTON_WIDTH);
+			freeSpace.block(objAngle, globals::BUTTON_WIDTH);
+			freeSpace.build();
+			const float pairAngle =
+				freeSpace.sample(std::uniform_real_distribution<float>(0, 1)(rand));
+			if (pairAngle >= 0) {
+				placeButtons(objAngle, pairAngle);
 			}
 			break;
 		}
@@ -273,10 +316,8 @@ void GLaDOS::placeObject(BuildingBlockModel::Object obj, float zeroAngle, int p)
 
 void GLaDOS::placeButtons(float angle1, float angle2) {
 	// Find usable button IDs
-	const int i = buttonFree.front();
-	buttonFree.pop();
-	const int j = buttonFree.front();
-	buttonFree.pop();
+	const int i = ship->getFreeButtons().take();
+	const int j = ship->getFreeButtons().take();
 
 	// Dispatch challenge creation
 	ship->createButton(angle1, i, angle2, j);
@@ -291,7 +332,7 @@ void GLaDOS::placeButtons(float angle1, float angle2) {
 void GLaDOS::update(float dt) { // NOLINT
 
 	// Check if this is the host
-	if (mib.getPlayerID() != 0) {
+	if (!mib.isHost()) {
 		CULogError("WARNING: GLaDOS called from non-host");
 		return;
 	}
@@ -300,46 +341,10 @@ void GLaDOS::update(float dt) { // NOLINT
 	//  BELOW THIS LINE, ALL ACTIONS ARE HOST-ONLY
 	// ============================================
 
-	// Removing breaches that have 0 health left
-	std::queue<int>().swap(breachFree);
-	for (int i = 0; i < maxEvents; i++) {
-		const std::shared_ptr<BreachModel>& breach = ship->getBreaches().at(i);
-		if (breach == nullptr) {
-			continue;
-		}
-
-		// check if the assigned player is inactive
-		if (!ship->getDonuts().at(breach->getPlayer())->getIsActive()) {
-			while (breach->getHealth() > 0) {
-				breach->decHealth(1);
-				mib.resolveBreach(i);
-			}
-		}
-
-		if (!breach->getIsActive()) {
-			breachFree.push(i);
-		}
-	}
-
-	std::queue<int>().swap(doorFree);
-	for (int i = 0; i < maxDoors; i++) {
-		const std::shared_ptr<DoorModel> door = ship->getDoors().at(i);
-		if (door == nullptr) {
-			continue;
-		}
-		if (!door->getIsActive()) {
-			doorFree.push(i);
-		}
-	}
-
-	std::queue<int>().swap(buttonFree);
-	for (int i = 0; i < maxButtons; i++) {
-		auto& btn = ship->getButtons().at(i);
-		if (btn == nullptr) {
-			continue;
-		}
-		if (!btn->getIsActive()) {
-			buttonFree.push(i);
+	// Breaches belonging to players who have left can never be fixed, so resolve them all at once
+	for (uint8_t p = 0; p < ship->getDonuts().size(); p++) {
+		if (!ship->getDonuts()[p]->getIsActive() && ship->resolvePlayerBreaches(p)) {
+			mib.resolvePlayerBreaches(p);
 		}
 	}
 
@@ -350,134 +355,179 @@ void GLaDOS::update(float dt) { // NOLINT
 		return;
 	}
 
-	for (int i = 0; i < events.size(); i++) {
-		const std::shared_ptr<EventModel> event = events.at(i);
-		int spawnRate =
-			static_cast<int>(globals::MIN_PLAYERS /
-							 (event->getProbability() * static_cast<float>(mib.getNumPlayers())));
-		if (spawnRate < 1) {
-			spawnRate = 1;
+	const float now = ship->timePassedIgnoringFreeze();
+	fired.clear();
+	scheduler.advance(now, fired);
+	for (const auto& timer : fired) {
+		if (timer.attempts == 0) {
+			stats.fired++;
 		}
-		if (event->isActive(static_cast<int>(ship->timePassedIgnoringFreeze())) &&
-			rand() % spawnRate <= 1) {
-			// ready up the event
-			readyQueue.push_back(event);
-			if (event->isOneTime()) {
-				// If it's a one time event, we don't want to add it again next frame
-				events.erase(events.begin() + i);
-				i--;
+		if (readyQueue.size() >= MAX_READY) {
+			if (events.at(timer.id)->isOneTime()) {
+				retryEvent(timer, now);
+			} else {
+				stats.dropped++;
+				scheduleEvent(timer.id, now);
 			}
-		}
-	}
-	for (int i = 0; i < readyQueue.size(); i++) {
-		// assign the relative player ids
-		vector<int> ids;
-		ids.reserve(ship->getDonuts().size());
-		for (int j = 0; j < ship->getDonuts().size(); j++) {
-			ids.push_back(j);
-		}
-		// NOLINTNEXTLINE It's fine that this shuffle algorithm isn't perfect
-		random_shuffle(ids.begin(), ids.end());
-		const shared_ptr<EventModel> event = readyQueue.at(i);
-		const shared_ptr<BuildingBlockModel> block = blocks.at(event->getBlock());
-		const vector<BuildingBlockModel::Object> objects = block->getObjects();
-		const int breachesNeeded = block->getBreachesNeeded();
-		const int doorsNeeded = block->getDoorsNeeded();
-		const int buttonsNeeded = block->getButtonsNeeded();
-
-		// If we don't have enough resources for this event, they're probably already fucked
-		if (doorsNeeded > doorFree.size() || breachesNeeded > breachFree.size() ||
-			buttonsNeeded > buttonFree.size()) {
-			readyQueue.erase(readyQueue.begin() + i);
-			i--;
 			continue;
 		}
-		// the ids we actually use
-		vector<int> neededIds;
-		for (const auto& object : objects) {
-			const int id = object.player;
-			if (id != -1) {
-				ids.push_back(id);
-			}
-		}
-		float angle = 0;
-		int padding = 0;
-		switch (block->getType()) {
-			case BuildingBlockModel::MinDist: {
-				angle = static_cast<float>(rand() % static_cast<int>(ship->getSize()));
-				padding = block->getDistance();
-				break;
-			}
-			case BuildingBlockModel::SpecificPlayer: {
-				const int id = ids.at(block->getPlayer());
-				angle =
-					ship->getDonuts().at(id)->getAngle() + static_cast<float>(block->getDistance());
-				break;
-			}
-			case BuildingBlockModel::Random: {
-				angle = static_cast<float>(rand() % static_cast<int>(ship->getSize()));
+		readyQueue.push_back(timer);
+	}
+	stats.peakReady = std::max(stats.peakReady, readyQueue.size());
+
+	// Place at most one event per frame; blocked events back off and try again later
+	bool placed = false;
+	for (size_t n = readyQueue.size(); !placed && n > 0; n--) {
+		TimingWheel::Timer timer = readyQueue.front();
+		readyQueue.pop_front();
+		const shared_ptr<EventModel> event = events.at(timer.id);
+		switch (placeBlock(blocks.at(event->getBlock()))) {
+			case Placed:
+				stats.placed++;
+				scheduleEvent(timer.id, now);
+				placed = true;
 				break;
-			}
-		}
-		bool goodAngle = true;
-		for (int j = 0; goodAngle && j < ship->getDonuts().size(); j++) {
-			const float diff = ship->getAngleDifference(ship->getDonuts().at(j)->getAngle(), angle);
-			const float dist = find(neededIds.begin(), neededIds.end(), j) != neededIds.end()
-								   ? 0
-								   : static_cast<float>(padding);
-			if (diff < dist + static_cast<float>(block->getRange()) / 2) {
-				goodAngle = false;
+			case Exhausted:
+				if (event->isOneTime()) {
+					retryEvent(timer, now);
+				} else {
+					stats.dropped++;
+					stats.exhausted++;
+					scheduleEvent(timer.id, now);
+				}
 				break;
-			}
-		}
-		// Make sure it's not too close to other breaches
-		for (unsigned int k = 0; goodAngle && k < ship->getBreaches().size(); k++) {
-			const float breachAngle = ship->getBreaches()[k]->getAngle();
-			const float diff = ship->getAngleDifference(breachAngle, angle);
-			if (ship->getBreaches()[k]->getIsActive() &&
-				diff < static_cast<float>(block->getRange()) / 2) {
-				goodAngle = false;
+			case Blocked:
+				retryEvent(timer, now);
 				break;
-			}
 		}
+	}
+}
 
-		for (unsigned int k = 0; goodAngle && k < ship->getDoors().size(); k++) {
-			const float doorAngle = ship->getDoors()[k]->getAngle();
-			const float diff = ship->getAngleDifference(doorAngle, angle);
-			if (ship->getDoors()[k]->getIsActive() &&
-				diff < static_cast<float>(block->getRange()) / 2) {
-				goodAngle = false;
-				break;
-			}
+/**
+ * Tries an event again later, backing off after each failure.
+ *
+ * One time events are retried until they are placed, since they would never fire otherwise.
+ * Repeating events are given up on after MAX_RETRIES tries and wait for their next occurrence.
+ *
+ * @param timer The timer of the event that could not be placed
+ * @param time  The time (ignoring freeze) to schedule from
+ */
+void GLaDOS::retryEvent(TimingWheel::Timer timer, float time) {
+	if (timer.attempts + 1 >= MAX_RETRIES && !events.at(timer.id)->isOneTime()) {
+		stats.dropped++;
+		scheduleEvent(timer.id, time);
+		return;
+	}
+	timer.attempts = std::min(timer.attempts + 1, MAX_RETRIES);
+	timer.due = time + RETRY_DELAY * static_cast<float>(1 << (timer.attempts - 1));
+	scheduler.schedule(timer);
+	stats.retried++;
+}
+
+/**
+ * Schedules the next occurrence of an event after the given time.
+ *
+ * @param id   The index of the event
+ * @param time The time (ignoring freeze) to schedule from
+ */
+void GLaDOS::scheduleEvent(int id, float time) {
+	const std::shared_ptr<EventModel>& event = events.at(id);
+	const auto start = static_cast<float>(event->getStart());
+	if (event->isOneTime()) {
+		if (time <= start) {
+			scheduler.schedule({id, 0, start});
 		}
+		return;
+	}
 
-		for (unsigned int k = 0; goodAngle && k < ship->getButtons().size(); k++) {
-			const float buttonAngle = ship->getButtons()[k]->getAngle();
-			const float diff = ship->getAngleDifference(buttonAngle, angle);
-			if (ship->getButtons()[k]->getIsActive() &&
-				diff < static_cast<float>(block->getRange()) / 2) {
-				goodAngle = false;
-				break;
-			}
+	// Level files give the chance of rolling rand() % spawnRate <= 1 once per frame
+	int spawnRate =
+		static_cast<int>(globals::MIN_PLAYERS /
+						 (event->getProbability() * static_cast<float>(mib.getNumPlayers())));
+	if (spawnRate < 1) {
+		spawnRate = 1;
+	}
+	const float chance = std::min(1.0f, 2.0f / static_cast<float>(spawnRate));
+	std::exponential_distribution<float> gap(chance * EVENT_FRAMERATE);
+	const float due = std::max(time, start) + gap(rand);
+	if (due < static_cast<float>(event->getEnd() + 1)) {
+		scheduler.schedule({id, 0, due});
+	}
+}
+
+/**
+ * Tries to place the building block for an event on the ship.
+ *
+ * @param block The building block to place
+ *
+ * @return Placed on success, Exhausted if there are not enough free objects, or Blocked if the
+ * ship was too crowded to fit it
+ */
+GLaDOS::PlaceResult GLaDOS::placeBlock(const std::shared_ptr<BuildingBlockModel>& block) {
+	// assign the relative player ids
+	vector<int> ids;
+	ids.reserve(ship->getDonuts().size());
+	for (int j = 0; j < ship->getDonuts().size(); j++) {
+		ids.push_back(j);
+	}
+	std::shuffle(ids.begin(), ids.end(), rand);
+	const vector<BuildingBlockModel::Object> objects = block->getObjects();
+	const int breachesNeeded = block->getBreachesNeeded();
+	const int doorsNeeded = block->getDoorsNeeded();
+	const int buttonsNeeded = block->getButtonsNeeded();
+
+	// If we don't have enough resources for this event, they're probably already fucked
+	if (doorsNeeded > ship->getFreeDoors().size() ||
+		breachesNeeded > ship->getFreeBreaches().size() ||
+		buttonsNeeded > ship->getFreeButtons().size()) {
+		return Exhausted;
+	}
+	// the ids we actually use
+	vector<int> neededIds;
+	for (const auto& object : objects) {
+		const int id = object.player;
+		if (id != -1) {
+			ids.push_back(id);
 		}
-		if (!goodAngle) {
-			continue;
+	}
+	// Keep the block's range clear of every active object, and padding clear of every player
+	const float halfRange = static_cast<float>(block->getRange()) / 2;
+	const float padding = block->getType() == BuildingBlockModel::MinDist
+							  ? static_cast<float>(block->getDistance())
+							  : 0;
+	ship->indexObjects(freeSpace, halfRange, halfRange, halfRange);
+	for (int j = 0; j < ship->getDonuts().size(); j++) {
+		const float dist =
+			find(neededIds.begin(), neededIds.end(), j) != neededIds.end() ? 0 : padding;
+		freeSpace.block(ship->getDonuts().at(j)->getAngle(), dist + halfRange);
+	}
+	freeSpace.build();
+
+	float angle = 0;
+	if (block->getType() == BuildingBlockModel::SpecificPlayer) {
+		const int id = ids.at(block->getPlayer());
+		angle = ship->getDonuts().at(id)->getAngle() + static_cast<float>(block->getDistance());
+		if (!freeSpace.isFree(angle)) {
+			return Blocked;
 		}
-		// set angle to where zero is
-		angle =
-			angle - static_cast<float>(block->getRange()) / 2 - static_cast<float>(block->getMin());
-
+	} else {
+		angle = freeSpace.sample(std::uniform_real_distribution<float>(0, 1)(rand));
 		if (angle < 0) {
-			angle += ship->getSize();
-		} else if (angle >= ship->getSize()) {
-			angle -= ship->getSize();
-		}
-		for (const auto& object : objects) {
-			placeObject(object, angle, ids);
+			return Blocked;
 		}
-		readyQueue.erase(readyQueue.begin() + i);
-		break;
 	}
+	// set angle to where zero is
+	angle = angle - static_cast<float>(block->getRange()) / 2 - static_cast<float>(block->getMin());
+
+	if (angle < 0) {
+		angle += ship->getSize();
+	} else if (angle >= ship->getSize()) {
+		angle -= ship->getSize();
+	}
+	for (const auto& object : objects) {
+		placeObject(object, angle, ids);
+	}
+	return Placed;
 }
 
 void GLaDOS::tutorialLevels(float /*dt*/) {
@@ -533,7 +583,8 @@ void GLaDOS::tutorialLevels(float /*dt*/) {
 				customEventCtr--;
 			} else if (customEventCtr <= 0) {
 				// Check if all breaches that can be resolved are resolved.
-				if (ship->getBreaches().size() - breachFree.size() == mib.getNumPlayers()) {
+				const size_t active = ship->getBreaches().size() - ship->getFreeBreaches().size();
+				if (active == mib.getNumPlayers()) {
 					ship->setTimeless(false);
 					mib.forceWinLevel();
 					ship->initTimer(0);
@@ -541,7 +592,7 @@ void GLaDOS::tutorialLevels(float /*dt*/) {
 			}
 			break;
 		case tutorial::DOOR_LEVEL:
-			if (ship->getDoors().size() - doorFree.size() == 0) {
+			if (ship->getDoors().size() == ship->getFreeDoors().size()) {
 				ship->setTimeless(false);
 				mib.forceWinLevel();
 				ship->initTimer(0);
@@ -549,7 +600,7 @@ void GLaDOS::tutorialLevels(float /*dt*/) {
 			}
 			break;
 		case tutorial::BUTTON_LEVEL:
-			if (ship->getButtons().size() - buttonFree.size() == 0) {
+			if (ship->getButtons().size() == ship->getFreeButtons().size()) {
 				ship->setTimeless(false);
 				mib.forceWinLevel();
 				ship->initTimer(0);
@@ -3,15 +3,19 @@
 
 #include <cugl/cugl.h>
 
+#include <deque>
 #include <random>
 
+#include "AngleIndex.h"
 #include "BreachModel.h"
 #include "DonutModel.h"
 #include "DoorModel.h"
 #include "Globals.h"
 #include "LevelModel.h"
 #include "MagicInternetBox.h"
+#include "RandomStream.h"
 #include "ShipModel.h"
+#include "TimingWheel.h"
 #include "TutorialConstants.h"
 
 /**
@@ -19,12 +23,38 @@
  * The controller class responsible for generating the challenges in the game.
  */
 class GLaDOS {
+   public:
+	/**
+	 * Counters describing the state of the event scheduler, for profiling
+	 */
+	struct SchedulerStats {
+		/** The number of timers waiting in the wheel */
+		size_t pending = 0;
+		/** The number of events ready to be placed */
+		size_t ready = 0;
+		/** The largest number of ready events seen this level */
+		size_t peakReady = 0;
+		/** The number of times an event fired */
+		unsigned int fired = 0;
+		/** The number of events placed on the ship */
+		unsigned int placed = 0;
+		/** The number of placement retries scheduled */
+		unsigned int retried = 0;
+		/** The number of events given up on (no resources, no room, or queue full) */
+		unsigned int dropped = 0;
+		/** The number of those given up on because the ship had no free objects left */
+		unsigned int exhausted = 0;
+	};
+
    private:
+	/** The result of trying to place a building block */
+	enum PlaceResult { Placed, Exhausted, Blocked };
+
 	/** Whether or not this input is active */
 	bool active;
 
-	/** Random number generator */
-	std::minstd_rand rand;
+	/** Random number generator; the GM stream of the level */
+	RandomStream rand;
 
 	/** The state of the ship */
 	std::shared_ptr<ShipModel> ship;
@@ -47,21 +77,62 @@ class GLaDOS {
 	/** The maximum number of buttons on ship at any one time. This will probably need to scale with
 	 * the number of players*/
 	unsigned int maxButtons;
-	/** queue recording which breaches are free. */
-	queue<int> breachFree;
-	/** queue recording which doors are free. */
-	queue<int> doorFree;
-	/** queue recording which buttons are free. */
-	queue<int> buttonFree;
 	/** List of building blocks for this level*/
 	map<std::string, std::shared_ptr<BuildingBlockModel>> blocks;
 	/** List of events for this level*/
 	vector<std::shared_ptr<EventModel>> events;
-	/** List of events that are ready to be executed*/
-	vector<std::shared_ptr<EventModel>> readyQueue;
+	/** Timers for the next occurrence of each event, keyed on time ignoring freeze */
+	TimingWheel scheduler;
+	/** Events that are due and waiting to be placed, oldest first */
+	std::deque<TimingWheel::Timer> readyQueue;
+	/** Scratch list of timers fired this frame */
+	vector<TimingWheel::Timer> fired;
+	/** Scheduler counters for this level */
+	SchedulerStats stats;
+	/** Free space on the ship, rebuilt whenever something needs placing */
+	AngleIndex freeSpace;
 	/** Time we started the stabilizer (for tutorial only) */
 	float stabilizerStart;
 
+	/**
+	 * Schedules the next occurrence of an event after the given time.
+	 *
+	 * Occurrences follow a Poisson process whose rate matches the per-frame probability in the
+	 * level file. One time events fire once, at their start time.
+	 *
+	 * @param id   The index of the event
+	 * @param time The time (ignoring freeze) to schedule from
+	 */
+	void scheduleEvent(int id, float time);
+
+	/**
+	 * Tries an event again later, backing off after each failure.
+	 *
+	 * One time events are retried until they are placed. Repeating events are given up on after
+	 * a few tries and wait for their next occurrence instead.
+	 *
+	 * @param timer The timer of the event that could not be placed
+	 * @param time  The time (ignoring freeze) to schedule from
+	 */
+	void retryEvent(TimingWheel::Timer timer, float time);
+
+	/**
+	 * Tries to place the building block for an event on the ship.
+	 *
+	 * @param block The building block to place
+	 *
+	 * @return Placed on success, Exhausted if there are not enough free objects, or Blocked if the
+	 * ship was too crowded to fit it
+	 */
+	PlaceResult placeBlock(const std::shared_ptr<BuildingBlockModel>& block);
+
+	/**
+	 * Restores the random stream, ready events and tutorial progress from a checkpoint.
+	 *
+	 * @param checkpoint A checkpoint written by {@link checkpoint}; ignored if empty or truncated
+	 */
+	void restore(const cugl::ByteView& checkpoint);
+
    public:
 #pragma mark -
 #pragma mark Constructors
@@ -106,6 +177,47 @@ class GLaDOS {
 	 */
 	bool init(const std::shared_ptr<ShipModel>& ship, int levelNum);
 
+	/**
+	 * Seeds the random number generator with the GM stream of the given level seed.
+	 *
+	 * Must be called before {@link init}, as initialization already draws random numbers.
+	 *
+	 * @param levelSeed The level seed
+	 */
+	void seed(uint32_t levelSeed) {
+		rand = RandomStream::level(levelSeed).split(RandomStream::Name::GM);
+	}
+
+	/**
+	 * Resumes the GM of a level in progress, taking over from a host that dropped out.
+	 *
+	 * Unlike {@link init}, this leaves the ship as it is. Must be called after {@link seed}.
+	 *
+	 * @param checkpoint The last checkpoint from the old host; may be empty
+	 *
+	 * @return true if the controller was resumed successfully
+	 */
+	bool resume(const std::shared_ptr<ShipModel>& ship, const std::shared_ptr<LevelModel>& level,
+				const cugl::ByteView& checkpoint);
+
+	/**
+	 * Resumes the GM of a tutorial level in progress, taking over from a host that dropped out.
+	 *
+	 * @param checkpoint The last checkpoint from the old host; may be empty
+	 *
+	 * @return true if the controller was resumed successfully
+	 */
+	bool resume(const std::shared_ptr<ShipModel>& ship, int levelNum,
+				const cugl::ByteView& checkpoint);
+
+	/**
+	 * Writes what another player needs to resume this GM: how far the random stream has gone, the
+	 * events waiting to be placed, and the progress of the tutorial.
+	 *
+	 * @param data The vector to append the checkpoint to
+	 */
+	void checkpoint(std::vector<uint8_t>& data) const;
+
 #pragma mark -
 #pragma mark GM Handling
 	/**
@@ -144,6 +256,15 @@ class GLaDOS {
 
 	void tutorialLevels(float dt);
 
+	/**
+	 * Returns the event scheduler counters for the current level
+	 */
+	const SchedulerStats& getSchedulerStats() {
+		stats.pending = scheduler.size();
+		stats.ready = readyQueue.size();
+		return stats;
+	}
+
 #pragma mark -
 };
 #endif /* GM_CONTROLLER_H */
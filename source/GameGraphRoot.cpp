@@ -436,7 +436,7 @@ void GameGraphRoot::update( // NOLINT Yeah it's a big function; we'll live with
 			// Show loss screen
 			lossScreen->setVisible(true);
 			pauseMenu->setVisible(false);
-			if (playerID != 0) {
+			if (!MagicInternetBox::getInstance().isHost()) {
 				lostWaitText->setVisible(true);
 				restartBtn->setVisible(false);
 			}
@@ -650,7 +650,7 @@ void GameGraphRoot::processButtons() {
 		isBackToMainMenu = true;
 	}
 
-	if (playerID == 0) {
+	if (MagicInternetBox::getInstance().isHost()) {
 		if (winScreen->isVisible()) {
 			if (winScreen->tappedNext(tapData)) {
 				lastButtonPressed = NextLevel;
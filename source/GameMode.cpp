@@ -8,6 +8,7 @@
 #include "ExternalDonutModel.h"
 #include "Globals.h"
 #include "PlayerDonutModel.h"
+#include "ReplayLog.h"
 
 using namespace cugl;
 using namespace std;
@@ -28,6 +29,8 @@ using namespace std;
 bool GameMode::init(const std::shared_ptr<cugl::AssetManager>& assets) {
 	isBackToMainMenu = false;
 	gm.reset();
+	levelModel = nullptr;
+	net.setGMCheckpointer(nullptr);
 
 	// Music Initialization
 	auto source = assets->get<Sound>("theme");
@@ -55,6 +58,9 @@ bool GameMode::init(const std::shared_ptr<cugl::AssetManager>& assets) {
 	const uint8_t playerID = net.getPlayerID().value();
 	const uint8_t levelID = net.getLevelNum().value();
 
+	// Seed shared by every player for every random number stream of this level
+	const uint32_t seed = net.getLevelSeed();
+
 	if (levelID >= MAX_NUM_LEVELS) {
 		// Reached end of game
 
@@ -68,42 +74,38 @@ bool GameMode::init(const std::shared_ptr<cugl::AssetManager>& assets) {
 		const char* levelName = LEVEL_NAMES.at(levelID);
 
 		CULog("Loading level %s b/c mib gave level num %d", levelName, levelID);
-		const uint8_t shipNumPlayers = net.getMaxNumPlayers();
-
 		const std::shared_ptr<LevelModel> level = assets->get<LevelModel>(levelName);
-		const unsigned int maxEvents =
-			level->getMaxBreaches() * shipNumPlayers / globals::MIN_PLAYERS;
-		const unsigned int maxDoors =
-			std::min(level->getMaxDoors() * shipNumPlayers / globals::MIN_PLAYERS,
-					 static_cast<int>(shipNumPlayers) * 2 - 1);
-		unsigned int maxButtons = level->getMaxButtons() * shipNumPlayers / globals::MIN_PLAYERS;
-		if (maxButtons % 2 != 0) {
-			maxButtons += 1;
-		}
-		ship = ShipModel::alloc(
-			shipNumPlayers, maxEvents, maxDoors, playerID, level->getShipSize(shipNumPlayers),
-			level->getInitHealth() * static_cast<float>(shipNumPlayers) / globals::MIN_PLAYERS,
-			maxButtons);
-		ship->initTimer(level->getTime());
-		if (playerID == 0) {
+		ship = ShipModel::alloc(level, net.getMaxNumPlayers(), playerID);
+		ship->seed(seed, playerID);
+		levelModel = level;
+		if (net.isHost()) {
 			gm.emplace();
+			gm->seed(seed);
 			gm->init(ship, level);
 		}
 	} else {
 		// Tutorial Mode. Allocate an empty ship and let the gm do the rest.
 		// Prepare for maximum hardcoding
 		ship = ShipModel::alloc(0, 0, 0, 0, 0, 0);
+		ship->seed(seed, playerID);
 		gm.emplace();
+		gm->seed(seed);
 		gm->init(ship, levelID);
 
 		// Ugly hack for the fact that GLaDOS is responsible for tutorial initialization
-		if (playerID != 0) {
+		if (!net.isHost()) {
 			gm.reset();
 		}
 	}
 
+	if (gm.has_value()) {
+		shareGMCheckpoints();
+	}
+
 	donutModel = ship->getDonuts()[playerID];
 	ship->setLevelNum(levelID);
+	ReplayLog::getInstance().level(levelID, playerID, net.getMaxNumPlayers(),
+								   net.getLevelParity(), net.isAuthoritative(), seed);
 
 	// Scene graph Initialization
 	sgRoot.init(assets, ship, playerID);
@@ -115,6 +117,7 @@ bool GameMode::init(const std::shared_ptr<cugl::AssetManager>& assets) {
  * Disposes of all (non-static) resources allocated to this mode.
  */
 void GameMode::dispose() {
+	net.setGMCheckpointer(nullptr);
 	if (gm.has_value()) {
 		gm->dispose();
 		gm.reset();
@@ -126,6 +129,22 @@ void GameMode::dispose() {
 #pragma endregion
 #pragma region Update Helpers
 
+void GameMode::shareGMCheckpoints() {
+	net.setGMCheckpointer([this](std::vector<uint8_t>& data) { gm->checkpoint(data); });
+}
+
+void GameMode::resumeGM() {
+	CULog("Took over as host; resuming the GM");
+	gm.emplace();
+	gm->seed(net.getLevelSeed());
+	if (levelModel != nullptr) {
+		gm->resume(ship, levelModel, net.getGMCheckpoint());
+	} else {
+		gm->resume(ship, net.getLevelNum().value(), net.getGMCheckpoint());
+	}
+	shareGMCheckpoints();
+}
+
 void GameMode::applyInputsToPlayerDonut() {
 	const uint8_t playerID = net.getPlayerID().value();
 
@@ -196,6 +215,10 @@ bool GameMode::connectionUpdate(float timestep) {
 		case MagicInternetBox::GameStart:
 			net.update(ship);
 			sgRoot.setStatus(GameGraphRoot::Normal);
+			if (net.isHost() && !gm.has_value() && !isBackToMainMenu &&
+				net.lastNetworkEvent() == MagicInternetBox::None) {
+				resumeGM();
+			}
 			break;
 		default:
 			CULog("ERROR: Uncaught MatchmakingStatus Value Occurred %d", net.matchStatus());
@@ -230,6 +253,7 @@ void GameMode::update(float timestep) {
 
 	// Grab inputs
 	input->update(timestep);
+	ReplayLog::getInstance().frame(timestep, input->getRoll(), input->isJumpPending());
 
 	// Check for loss
 	if (lossCheck()) {
@@ -253,6 +277,7 @@ void GameMode::update(float timestep) {
 	if (gm.has_value()) {
 		gm->update(timestep);
 	}
+	ReplayLog::getInstance().digest(ship);
 
 	// Process graphics before draw step
 	sgRoot.update(timestep);
@@ -39,6 +39,8 @@ class GameMode {
 	std::shared_ptr<DonutModel> donutModel;
 	/** The Ship model */
 	std::shared_ptr<ShipModel> ship;
+	/** The level being played; null for tutorial levels and the end of the game */
+	std::shared_ptr<LevelModel> levelModel;
 
 	/** Whether to go back to main menu */
 	bool isBackToMainMenu;
@@ -56,6 +58,12 @@ class GameMode {
 	 */
 	bool connectionUpdate(float timestep);
 
+	/** Send a checkpoint of the GM with each state sync, so another player can take over */
+	void shareGMCheckpoints();
+
+	/** Take over the GM of the level in progress after becoming the host mid level */
+	void resumeGM();
+
 	/** Handle loss. Returns true if loss. */
 	bool lossCheck();
 	/** Handle win. Returns true if won. */
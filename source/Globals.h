@@ -17,11 +17,11 @@ namespace globals {
 #pragma warning(push)
 #pragma warning(disable : 4244)
 
-/** Network tick frequency */
+/** Default number of frames between position updates; see TickRateController */
 constexpr unsigned int NETWORK_TICK = 12; // NOLINT
 
 /** API version number. Bump this everytime a backwards incompatible API change happens. */
-constexpr uint8_t API_VER = 0; // NOLINT
+constexpr uint8_t API_VER = 9; // NOLINT
 
 /** ID marker for unops in sound effects*/
 constexpr int UNOP_MARKER = 12; // NOLINT
@@ -153,6 +153,12 @@ class InputController {
 	 */
 	bool hasJumped();
 
+	/**
+	 * Return whether the player has jumped since {@link hasJumped()} was last queried, without
+	 * clearing the jump
+	 */
+	bool isJumpPending() const { return jumped; }
+
 #pragma endregion
 #pragma region Callbacks
 	/**
@@ -7,30 +7,38 @@
 #include "Globals.h"
 #include "LevelConstants.h"
 #include "NetworkDataType.h"
+#include "ReplayLog.h"
 #include "StateReconciler.h"
+#include "ThreadedNetworkConnection.h"
+#include "TickRateController.h"
 
-/** The state synchronization frequency */
-constexpr unsigned int STATE_SYNC_FREQ = globals::NETWORK_TICK * 5;
+/** Number of position updates per state sync */
+constexpr unsigned int SYNC_TICKS = 5;
+
+/** Messages at least this long are sent compressed, if that makes them smaller */
+constexpr size_t COMPRESS_MIN_SIZE = 64;
 
 /** Minimum number of seconds to wait after a connection attempt before allowing retrys */
 constexpr double MIN_WAIT_TIME = 0.5;
 
-/** How many ticks without a server message before considering oneself disconnected */
-constexpr unsigned int SERVER_TIMEOUT = 300;
+/** How long without a server message before considering oneself disconnected */
+constexpr auto SERVER_TIMEOUT = std::chrono::seconds(5);
 
-/** IP of the NAT punchthrough server */
+/** IP of the NAT punchthrough server, unless another is set with setServer */
 constexpr auto SERVER_ADDRESS = "34.138.48.28";
 /** Port of the NAT punchthrough server */
 constexpr uint16_t SERVER_PORT = 61111;
+/** Port of the UDP relay coordinator; none is deployed, so only used once set with setRelay */
+constexpr uint16_t RELAY_PORT = 61112;
 /** Port of the websocket fallback server */
 constexpr uint16_t FALLBACK_PORT = 8080;
 /** Max # of players per game */
 constexpr uint8_t MAX_PLAYERS = 6;
-/** Current game API */
-constexpr uint8_t API = 0;
-
-constexpr auto SERVER_CONFIG = cugl::NetworkConnection::ConnectionConfig(
-	SERVER_ADDRESS, SERVER_PORT, FALLBACK_PORT, MAX_PLAYERS, API);
+/**
+ * Whether clients connect directly to each other instead of only through the host.
+ * Off by default, so games go through the host unless a build opts in.
+ */
+constexpr bool USE_MESH = false;
 
 class MagicInternetBox::Mimpl {
    private:
@@ -46,19 +54,63 @@ class MagicInternetBox::Mimpl {
 	/** The current frame, modulo the network tick rate. */
 	unsigned int currFrame;
 
+	/** The current network tick, modulo the number of ticks per state sync */
+	unsigned int currTick;
+
+	/** Picks the network tick rate from the quality of the connection */
+	TickRateController tickRate;
+
 	/** Current level number, or empty if unassigned */
 	tl::optional<uint8_t> levelNum;
 	/** Parity of current level (to sync state syncs) */
 	bool levelParity;
+	/** Seed of every shared random number stream of the current level */
+	uint32_t levelSeed;
 
 	/** Whether to skip tutorial levels */
 	bool skipTutorial;
 
+	/** Whether the host is the only writer of object state for this game */
+	bool authoritative;
+
+	/** Player ID of the host as of the last gameplay update */
+	uint8_t hostID;
+
+	/** Last checkpoint of the host's GM for the current level */
+	std::vector<uint8_t> gmCheckpoint;
+
+	/** Writes a checkpoint of this player's GM, if it has one */
+	std::function<void(std::vector<uint8_t>&)> gmCheckpointer;
+
+	/** Set the authority mode of this game */
+	void setAuthoritativeInternal(bool value) {
+		authoritative = value;
+		stateReconciler.setAuthoritative(value);
+	}
+
+	/** Draw a fresh level seed; only the host does this */
+	static uint32_t newLevelSeed() {
+		return static_cast<uint32_t>(
+			std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	}
+
+	/** Append a level seed to a message */
+	static void putSeed(uint32_t seed, std::vector<uint8_t>& data) {
+		StateReconciler::encodeInt(seed, data);
+	}
+
+	/** Read the level seed at the given index of a message, or 0 if the message is too short */
+	static uint32_t getSeed(const cugl::ByteView& message, size_t index) {
+		return message.size() < index + 4 ? 0 : StateReconciler::decodeInt(message, index);
+	}
+
 	/** Start the given level */
-	void startLevelInternal(uint8_t num, bool parity) {
+	void startLevelInternal(uint8_t num, bool parity, uint32_t seed) {
 		levelNum = num;
 		levelParity = parity;
+		levelSeed = seed;
 		stateReconciler.reset();
+		gmCheckpoint.clear();
 		if (num >= MAX_NUM_LEVELS || num < 0) {
 			events = EndGame;
 		} else {
@@ -69,12 +121,76 @@ class MagicInternetBox::Mimpl {
 	/** Helper controller to reconcile states during state sync */
 	StateReconciler stateReconciler;
 
-	/** Number of frames since the last inbound server message */
-	unsigned int framesSinceLastMessage;
+	/** Snapshot received while reconnecting, to apply once the level is loaded */
+	tl::optional<std::vector<uint8_t>> pendingSnapshot;
+
+	/**
+	 * Follow players leaving and rejoining the game. As host, immediately send everyone a snapshot
+	 * when a player rejoins, so that they need not wait for the next state sync.
+	 */
+	void trackPlayers(const std::shared_ptr<ShipModel>& state) {
+		const auto& donuts = state->getDonuts();
+		bool rejoined = false;
+		for (uint8_t i = 0; i < donuts.size(); i++) {
+			const bool active = conn->isPlayerActive(i);
+			if (active == donuts[i]->getIsActive()) {
+				continue;
+			}
+			CULog("Player %d has %s", i, active ? "reconnected" : "disconnected");
+			donuts[i]->setIsActive(active);
+			rejoined |= active;
+		}
+		if (rejoined && isHost() && !state->isLevelOver()) {
+			sendSnapshot(state);
+		}
+	}
+
+	/**
+	 * Follow the host changing. Having just taken over as host, immediately send everyone a
+	 * snapshot, so that they agree with the new host without waiting for the next state sync.
+	 */
+	void trackHost(const std::shared_ptr<ShipModel>& state) {
+		if (conn->getHostID() == hostID) {
+			return;
+		}
+		hostID = conn->getHostID();
+		CULog("Player %d is now the host", hostID);
+		if (isHost() && !state->isLevelOver()) {
+			sendSnapshot(state);
+		}
+	}
+
+	/** Send everyone a snapshot of the level */
+	void sendSnapshot(const std::shared_ptr<ShipModel>& state) {
+		std::vector<uint8_t> data;
+		data.push_back(Snapshot);
+		StateReconciler::encodeSnapshot(state, data, levelNum.value(), levelParity, levelSeed,
+										authoritative);
+		send(data);
+	}
+
+	/** Time at which the last inbound server message was handled */
+	std::chrono::steady_clock::time_point lastMessageTime;
 
 	/** Time at which the last connection was attempted */
 	std::chrono::time_point<std::chrono::system_clock> lastAttemptConnectionTime;
 
+	/**
+	 * Address of the machine running the punchthrough and fallback servers. Connections keep
+	 * pointing into this, so it only changes while there is no connection.
+	 */
+	std::string serverAddress;
+
+	/** Address of the relay coordinator, or empty for no relay. Changes like serverAddress. */
+	std::string relayAddress;
+
+	/** Returns the config for connecting to the servers at {@link serverAddress} */
+	cugl::NetworkConnection::ConnectionConfig serverConfig() const {
+		return cugl::NetworkConnection::ConnectionConfig(
+			serverAddress.c_str(), SERVER_PORT, FALLBACK_PORT, MAX_PLAYERS, globals::API_VER,
+			USE_MESH, relayAddress.empty() ? nullptr : relayAddress.c_str(), RELAY_PORT);
+	}
+
 	/**
 	 * Initialize the network connection.
 	 * Will establish a connection to the server.
@@ -107,9 +223,46 @@ class MagicInternetBox::Mimpl {
 
 		stateReconciler.reset();
 		skipTutorial = false;
+		setAuthoritativeInternal(false);
+		hostID = 0;
 		return true;
 	}
 
+	/** Scratch space for compressing and decompressing messages */
+	std::vector<uint8_t> compressed;
+	std::vector<uint8_t> decompressed;
+
+	/** Send a message to every other player, recording it if a replay is being recorded */
+	void send(const std::vector<uint8_t>& data) {
+		ReplayLog::getInstance().outbound(data);
+		if (data.size() >= COMPRESS_MIN_SIZE) {
+			// [ Compressed | compressed message ]
+			compressed.assign(1, Compressed);
+			StateReconciler::compress(data, compressed);
+			if (compressed.size() < data.size()) {
+				conn->send(compressed);
+				return;
+			}
+		}
+		conn->send(data);
+	}
+
+	/**
+	 * Returns the message as it was sent before any compression, valid until the next call; empty
+	 * if it does not decompress.
+	 */
+	cugl::ByteView decompress(const cugl::ByteView& message) {
+		if (message.empty() || message[0] != Compressed) {
+			return message;
+		}
+		decompressed.clear();
+		if (!StateReconciler::decompress(message.from(1), decompressed)) {
+			CULogError("Received a malformed compressed message; dropping");
+			return cugl::ByteView();
+		}
+		return decompressed;
+	}
+
 	/**
 	 * Send data over the network as described in the architecture specification.
 	 *
@@ -157,7 +310,7 @@ class MagicInternetBox::Mimpl {
 		data.push_back(d3Positive);
 		StateReconciler::encodeFloat(abs(data3), data);
 
-		conn->send(data);
+		send(data);
 	}
 
    public:
@@ -167,9 +320,13 @@ class MagicInternetBox::Mimpl {
 		  status(Uninitialized),
 		  events(None),
 		  currFrame(0),
+		  currTick(0),
 		  levelParity(true),
+		  levelSeed(0),
 		  skipTutorial(false),
-		  framesSinceLastMessage(0) {}
+		  authoritative(false),
+		  hostID(0),
+		  serverAddress(SERVER_ADDRESS) {}
 
 	bool initHost() {
 		if (!initConnection()) {
@@ -177,7 +334,8 @@ class MagicInternetBox::Mimpl {
 			return false;
 		}
 
-		conn = cugl::NetworkConnection::newHostConnection(SERVER_CONFIG);
+		conn = std::make_unique<cugl::ThreadedNetworkConnection>(
+			cugl::NetworkConnection::newHostConnection(serverConfig()));
 
 		status = HostConnecting;
 
@@ -190,13 +348,32 @@ class MagicInternetBox::Mimpl {
 			return false;
 		}
 
-		conn = cugl::NetworkConnection::newClientConnection(SERVER_CONFIG, id);
+		conn = std::make_unique<cugl::ThreadedNetworkConnection>(
+			cugl::NetworkConnection::newClientConnection(serverConfig(), id));
 
 		status = ClientConnecting;
 
 		return true;
 	}
 
+	void initReplay(std::unique_ptr<cugl::NetworkConnection> connection, uint8_t level,
+					bool parity, uint32_t seed, bool authoritative) {
+		conn = std::move(connection);
+		status = GameStart;
+		events = None;
+		currFrame = 0;
+		currTick = 0;
+		tickRate.reset();
+		lastMessageTime = std::chrono::steady_clock::now();
+		levelNum = level;
+		levelParity = parity;
+		levelSeed = seed;
+		stateReconciler.reset();
+		gmCheckpoint.clear();
+		setAuthoritativeInternal(authoritative);
+		hostID = conn->getHostID();
+	}
+
 #pragma endregion
 
 #pragma region Getters
@@ -210,6 +387,10 @@ class MagicInternetBox::Mimpl {
 
 	tl::optional<uint8_t> getLevelNum() { return levelNum; }
 
+	bool getLevelParity() const { return levelParity; }
+
+	uint32_t getLevelSeed() const { return levelSeed; }
+
 	tl::optional<uint8_t> getPlayerID() { return conn->getPlayerID(); }
 
 	uint8_t getNumPlayers() const { return conn->getNumPlayers(); }
@@ -217,10 +398,48 @@ class MagicInternetBox::Mimpl {
 	uint8_t getMaxNumPlayers() const { return conn->getTotalPlayers(); }
 
 	bool isPlayerActive(uint8_t playerID) { return conn->isPlayerActive(playerID); }
+
+	bool isAuthoritative() const { return authoritative; }
+
+	bool isHost() const { return conn != nullptr && conn->getPlayerID() == conn->getHostID(); }
+
+	cugl::ByteView getGMCheckpoint() const { return gmCheckpoint; }
 #pragma endregion
 
+	void setGMCheckpointer(std::function<void(std::vector<uint8_t>&)> checkpointer) {
+		gmCheckpointer = std::move(checkpointer);
+	}
+
 	void setSkipTutorial(bool skip) { skipTutorial = skip; }
 
+	void setServer(const std::string& address) {
+		if (conn != nullptr) {
+			CULog("ERROR: Trying to change servers while connected");
+			return;
+		}
+		serverAddress = address;
+	}
+
+	void setRelay(const std::string& address) {
+		if (conn != nullptr) {
+			CULog("ERROR: Trying to change relays while connected");
+			return;
+		}
+		relayAddress = address;
+	}
+
+	void setAuthoritative(bool value) {
+		switch (status) {
+			case HostConnecting:
+			case HostWaitingOnOthers:
+				break;
+			default:
+				CULog("ERROR: Trying to set authority mode during invalid state %d", status);
+				return;
+		}
+		setAuthoritativeInternal(value);
+	}
+
 #pragma region Game Management
 	void startGame(uint8_t levelNum) {
 		switch (status) {
@@ -241,8 +460,11 @@ class MagicInternetBox::Mimpl {
 		std::vector<uint8_t> data;
 		data.push_back(uint8_t{StartGame});
 		data.push_back(levelNum);
+		data.push_back(authoritative ? 1 : 0);
+		levelSeed = newLevelSeed();
+		putSeed(levelSeed, data);
 		this->levelNum = levelNum;
-		conn->send(data);
+		send(data);
 
 		status = GameStart;
 		stateReconciler.reset();
@@ -256,14 +478,16 @@ class MagicInternetBox::Mimpl {
 		}
 
 		levelParity = !levelParity;
+		const uint32_t seed = newLevelSeed();
 
 		std::vector<uint8_t> data;
 		data.push_back(uint8_t{ChangeGame});
 		data.push_back(0);
 		data.push_back(levelParity ? 1 : 0);
-		conn->send(data);
+		putSeed(seed, data);
+		send(data);
 
-		startLevelInternal(levelNum.value(), levelParity);
+		startLevelInternal(levelNum.value(), levelParity, seed);
 	}
 
 	void nextLevel() {
@@ -280,14 +504,16 @@ class MagicInternetBox::Mimpl {
 			}
 		}
 		levelParity = !levelParity;
-		startLevelInternal(level, levelParity);
+		const uint32_t seed = newLevelSeed();
+		startLevelInternal(level, levelParity, seed);
 
 		std::vector<uint8_t> data;
 		data.push_back(uint8_t{ChangeGame});
 		data.push_back(1);
 		data.push_back(level);
 		data.push_back(levelParity ? 1 : 0);
-		conn->send(data);
+		putSeed(seed, data);
+		send(data);
 	}
 #pragma endregion
 
@@ -307,6 +533,8 @@ class MagicInternetBox::Mimpl {
 			default:
 				break;
 		}
+		// The server timeout only runs during gameplay
+		lastMessageTime = std::chrono::steady_clock::now();
 
 		switch (conn->getStatus()) {
 			case cugl::NetworkConnection::NetStatus::Disconnected:
@@ -354,7 +582,8 @@ class MagicInternetBox::Mimpl {
 				break;
 		}
 
-		conn->receive([this](const std::vector<uint8_t>& message) {
+		conn->receive([this](const cugl::ByteView& received) {
+			const cugl::ByteView message = decompress(received);
 			if (message.empty()) {
 				return;
 			}
@@ -374,6 +603,25 @@ class MagicInternetBox::Mimpl {
 					status = GameStart;
 					levelNum = message[1];
 					stateReconciler.reset();
+					setAuthoritativeInternal(message.size() > 2 && message[2] != 0);
+					levelSeed = getSeed(message, 3);
+					return;
+				}
+				case Snapshot: {
+					const auto header = StateReconciler::decodeSnapshotHeader(message);
+					if (status != ReconnectPending || !header.has_value()) {
+						CULog("Received snapshot during connection but not reconnecting");
+						return;
+					}
+					CULog("Reconnect success from snapshot");
+					status = GameStart;
+					setAuthoritativeInternal(header->authoritative);
+					if (header->level != levelNum || header->parity != levelParity) {
+						// The game moved on while we were away; load its level first
+						startLevelInternal(header->level, header->parity, header->seed);
+					}
+					// The view dies with this callback, so keep a copy
+					pendingSnapshot = message.toVector();
 					return;
 				}
 				case StateSync: {
@@ -415,45 +663,65 @@ class MagicInternetBox::Mimpl {
 			return;
 		}
 
-		framesSinceLastMessage++;
 		const uint8_t pID = conn->getPlayerID().value();
 
+		trackPlayers(state);
+		trackHost(state);
+		if (pendingSnapshot.has_value()) {
+			if (stateReconciler.restore(state, *pendingSnapshot, levelNum.value(), levelParity,
+										pID)) {
+				pendingSnapshot = tl::nullopt;
+			} else if (events != LoadLevel) {
+				CULog("Snapshot does not match the loaded level; dropping");
+				pendingSnapshot = tl::nullopt;
+			}
+		}
+
 		// NETWORK TICK
-		currFrame = (currFrame + 1) % STATE_SYNC_FREQ;
-		if (currFrame % globals::NETWORK_TICK == 0) {
+		tickRate.update(conn->getLinkStats());
+		const unsigned int tick = tickRate.getTick();
+		currFrame = currFrame + 1 >= tick ? 0 : currFrame + 1;
+		if (currFrame == 0) {
 			const std::shared_ptr<DonutModel> player = state->getDonuts()[pID];
 			const float angle = player->getAngle();
 			const float velocity = player->getVelocity();
-			sendData(PositionUpdate, angle, pID, -1, -1, velocity);
+			// Other players ease this donut over the tick it was sent with
+			sendData(PositionUpdate, angle, pID, static_cast<uint8_t>(tick), -1, velocity);
 
-			// STATE SYNC (and check for server connection)
-			if (currFrame == 0) {
-				if (pID == 0) {
+			// STATE SYNC
+			currTick = (currTick + 1) % SYNC_TICKS;
+			if (currTick == 0) {
+				if (isHost()) {
 					if (!state->isLevelOver()) {
 						std::vector<uint8_t> data;
 						data.push_back(StateSync);
 						StateReconciler::encode(state, data, levelNum.value(), levelParity);
-						conn->send(data);
+						send(data);
+					}
+					if (gmCheckpointer) {
+						// [ GMCheckpoint | level | parity | checkpoint ]
+						std::vector<uint8_t> data;
+						data.push_back(GMCheckpoint);
+						data.push_back(levelNum.value());
+						data.push_back(levelParity ? 1 : 0);
+						gmCheckpointer(data);
+						send(data);
 					}
-				}
-				if (framesSinceLastMessage > SERVER_TIMEOUT) {
-					CULog(
-						"HAS NOT RECEIVED SERVER MESSAGE IN TIMEOUT FRAMES; assuming disconnected");
-					forceDisconnect();
-					status = Reconnecting;
-					return;
 				}
 			}
 		}
 
-		conn->receive([&state, this](const std::vector<uint8_t>& message) {
+		conn->receive([&state, pID, this](const cugl::ByteView& received) {
+			const cugl::ByteView message = decompress(received);
 			if (message.empty()) {
 				return;
 			}
 
+			ReplayLog::getInstance().inbound(message);
+
 			auto type = static_cast<NetworkDataType>(message[0]);
 
-			framesSinceLastMessage = 0;
+			lastMessageTime = std::chrono::steady_clock::now();
 
 			switch (type) {
 				case PlayerJoined: {
@@ -477,11 +745,27 @@ class MagicInternetBox::Mimpl {
 					}
 					return;
 				}
+				case Snapshot: {
+					if (!isHost() && !state->isLevelOver()) {
+						if (!stateReconciler.restore(state, message, levelNum.value(), levelParity,
+													 pID)) {
+							CULog("Wrong level snapshot; ignoring");
+						}
+					}
+					return;
+				}
+				case GMCheckpoint: {
+					if (message.size() > 3 && message[1] == levelNum &&
+						(message[2] != 0) == levelParity) {
+						gmCheckpoint.assign(message.begin() + 3, message.end());
+					}
+					return;
+				}
 				case ChangeGame: {
 					if (message[1] == 0) {
-						startLevelInternal(levelNum.value(), message[2] != 0);
+						startLevelInternal(levelNum.value(), message[2] != 0, getSeed(message, 3));
 					} else {
-						startLevelInternal(message[2], message[3] != 0);
+						startLevelInternal(message[2], message[3] != 0, getSeed(message, 4));
 					}
 					return;
 				}
@@ -501,9 +785,25 @@ class MagicInternetBox::Mimpl {
 			float data3 = (message[6] == 1 ? 1 : -1) * // NOLINT
 						  StateReconciler::decodeFloat(message[7], message[8]); // NOLINT
 
+			// Other players only send inputs and positions to an authoritative host
+			if (authoritative && isHost()) {
+				switch (type) {
+					case BreachShrink:
+					case BreachResolveAll:
+					case DualResolve:
+					case ButtonFlag:
+					case ButtonResolve:
+						CULog("Ignoring object state from a client in authoritative mode");
+						return;
+					default:
+						break;
+				}
+			}
+
 			switch (type) {
 				case PositionUpdate: {
 					const std::shared_ptr<DonutModel> donut = state->getDonuts()[id];
+					donut->setNetworkTick(data1);
 					donut->setAngle(angle);
 					donut->setVelocity(data3);
 					break;
@@ -522,6 +822,11 @@ class MagicInternetBox::Mimpl {
 					CULog("Resolve breach %d", id);
 					break;
 				}
+				case BreachResolveAll: {
+					state->resolvePlayerBreaches(id);
+					CULog("Resolve all breaches of player %d", id);
+					break;
+				}
 				case DualCreate: {
 					const int taskID = id;
 					state->createDoor(angle, taskID);
@@ -574,6 +879,15 @@ class MagicInternetBox::Mimpl {
 					break;
 			}
 		});
+
+		// Checked after the inbox is drained, so a long frame cannot time out a live connection
+		if (currFrame == 0 && currTick == 0 &&
+			std::chrono::steady_clock::now() - lastMessageTime > SERVER_TIMEOUT) {
+			CULog("HAS NOT RECEIVED SERVER MESSAGE IN TIMEOUT; assuming disconnected");
+			forceDisconnect();
+			status = Reconnecting;
+			return;
+		}
 		switch (status) {
 			case ReconnectError:
 				conn = nullptr;
@@ -594,6 +908,11 @@ class MagicInternetBox::Mimpl {
 		CULog("Sending resolve id %d", id);
 	}
 
+	void resolvePlayerBreaches(uint8_t player) {
+		sendData(BreachResolveAll, -1.0f, player, -1, -1, -1.0f);
+		CULog("Sending resolve all for player %d", player);
+	}
+
 	void createDualTask(float angle, uint8_t id) { sendData(DualCreate, angle, id, -1, -1, -1.0f); }
 
 	void flagDualTask(uint8_t id, uint8_t player, uint8_t flag) {
@@ -635,9 +954,12 @@ class MagicInternetBox::Mimpl {
 		forceDisconnect();
 		status = Uninitialized;
 		stateReconciler.reset();
+		tickRate.reset();
 		levelNum = tl::nullopt;
+		pendingSnapshot = tl::nullopt;
+		gmCheckpoint.clear();
+		hostID = 0;
 
-		framesSinceLastMessage = 0;
 		conn = nullptr;
 	}
 };
@@ -648,6 +970,11 @@ MagicInternetBox::MagicInternetBox() : impl(new Mimpl) {}
 MagicInternetBox::~MagicInternetBox() = default;
 bool MagicInternetBox::initHost() { return impl->initHost(); }
 bool MagicInternetBox::initClient(const std::string& id) { return impl->initClient(id); }
+void MagicInternetBox::initReplay(std::unique_ptr<cugl::NetworkConnection> connection,
+								  uint8_t levelNum, bool parity, uint32_t seed,
+								  bool authoritative) {
+	impl->initReplay(std::move(connection), levelNum, parity, seed, authoritative);
+}
 MagicInternetBox::MatchmakingStatus MagicInternetBox::matchStatus() { return impl->matchStatus(); }
 MagicInternetBox::NetworkEvents MagicInternetBox::lastNetworkEvent() {
 	return impl->lastNetworkEvent();
@@ -655,11 +982,23 @@ MagicInternetBox::NetworkEvents MagicInternetBox::lastNetworkEvent() {
 void MagicInternetBox::acknowledgeNetworkEvent() { impl->acknowledgeNetworkEvent(); }
 std::string MagicInternetBox::getRoomID() { return impl->getRoomID(); }
 tl::optional<uint8_t> MagicInternetBox::getLevelNum() { return impl->getLevelNum(); }
+bool MagicInternetBox::getLevelParity() const { return impl->getLevelParity(); }
+uint32_t MagicInternetBox::getLevelSeed() const { return impl->getLevelSeed(); }
 tl::optional<uint8_t> MagicInternetBox::getPlayerID() { return impl->getPlayerID(); }
 uint8_t MagicInternetBox::getNumPlayers() const { return impl->getNumPlayers(); }
 uint8_t MagicInternetBox::getMaxNumPlayers() const { return impl->getMaxNumPlayers(); }
 bool MagicInternetBox::isPlayerActive(uint8_t playerID) { return impl->isPlayerActive(playerID); }
+bool MagicInternetBox::isAuthoritative() const { return impl->isAuthoritative(); }
+bool MagicInternetBox::isHost() const { return impl->isHost(); }
+cugl::ByteView MagicInternetBox::getGMCheckpoint() const { return impl->getGMCheckpoint(); }
+void MagicInternetBox::setGMCheckpointer(std::function<void(std::vector<uint8_t>&)> checkpointer) {
+	impl->setGMCheckpointer(std::move(checkpointer));
+}
 void MagicInternetBox::setSkipTutorial(bool skip) { impl->setSkipTutorial(skip); }
+void MagicInternetBox::setServer(const std::string& address) { impl->setServer(address); }
+
+void MagicInternetBox::setRelay(const std::string& address) { impl->setRelay(address); }
+void MagicInternetBox::setAuthoritative(bool value) { impl->setAuthoritative(value); }
 void MagicInternetBox::startGame(uint8_t levelNum) { impl->startGame(levelNum); }
 void MagicInternetBox::restartGame() { impl->restartGame(); }
 void MagicInternetBox::nextLevel() { impl->nextLevel(); }
@@ -669,6 +1008,9 @@ void MagicInternetBox::createBreach(float angle, uint8_t player, uint8_t id) {
 	impl->createBreach(angle, player, id);
 }
 void MagicInternetBox::resolveBreach(uint8_t id) { impl->resolveBreach(id); }
+void MagicInternetBox::resolvePlayerBreaches(uint8_t player) {
+	impl->resolvePlayerBreaches(player);
+}
 void MagicInternetBox::createDualTask(float angle, uint8_t id) { impl->createDualTask(angle, id); }
 void MagicInternetBox::flagDualTask(uint8_t id, uint8_t player, uint8_t flag) {
 	impl->flagDualTask(id, player, flag);
@@ -5,6 +5,7 @@
 
 #include <tl/optional.hpp>
 
+#include "CUNetworkConnection.h"
 #include "ShipModel.h"
 
 /**
@@ -104,6 +105,19 @@ class MagicInternetBox {
 	 */
 	bool initClient(const std::string& id);
 
+	/**
+	 * Initialize this controller class to play back a recorded level over the given connection,
+	 * as if the game had just started on that level. Used by the offline re-simulator.
+	 *
+	 * @param connection    The connection to play back through
+	 * @param levelNum      The recorded level number
+	 * @param parity        The recorded level parity
+	 * @param seed          The recorded level seed
+	 * @param authoritative Whether the recorded host was authoritative
+	 */
+	void initReplay(std::unique_ptr<cugl::NetworkConnection> connection, uint8_t levelNum,
+					bool parity, uint32_t seed, bool authoritative);
+
 	/**
 	 * Query the current matchmaking status
 	 */
@@ -131,9 +145,21 @@ class MagicInternetBox {
 	 */
 	tl::optional<uint8_t> getLevelNum();
 
+	/**
+	 * Returns the parity of the current level, which tells a restart apart from the previous
+	 * attempt at the same level.
+	 */
+	bool getLevelParity() const;
+
+	/**
+	 * Returns the seed of the current level, chosen by the host and sent with the level number.
+	 * Every shared random number stream of the level is split off of it.
+	 */
+	uint32_t getLevelSeed() const;
+
 	/**
 	 * Returns the current player ID, or -1 if uninitialized.
-	 * 0 is the host player.
+	 * 0 is the host player, unless the host migrated (see {@link isHost()}).
 	 */
 	tl::optional<uint8_t> getPlayerID();
 
@@ -153,11 +179,64 @@ class MagicInternetBox {
 	 */
 	bool isPlayerActive(uint8_t playerID);
 
+	/**
+	 * Returns whether this player is currently the host. This starts as player 0, but another
+	 * player takes over if the host drops out of a mesh game.
+	 */
+	bool isHost() const;
+
+	/**
+	 * Returns the last checkpoint of the host's GM for the current level, or an empty view if
+	 * none has been received. Used to resume the GM after taking over as host.
+	 */
+	cugl::ByteView getGMCheckpoint() const;
+
+	/**
+	 * Set the function writing a checkpoint of this player's GM, sent to everyone with each state
+	 * sync while this player is the host. Pass nullptr to stop sending checkpoints.
+	 *
+	 * @param checkpointer A function appending a checkpoint to the given message
+	 */
+	void setGMCheckpointer(std::function<void(std::vector<uint8_t>&)> checkpointer);
+
+	/**
+	 * Returns whether the host is the only writer of object state in this game.
+	 *
+	 * In this mode other players send only their position and jumps; the host runs collisions for
+	 * every donut and broadcasts every change to breaches, doors and buttons, and its state syncs
+	 * are applied at once instead of after a second sync.
+	 */
+	bool isAuthoritative() const;
+
 	/**
 	 * Set whether or not the tutorial should be skipped.
 	 */
 	void setSkipTutorial(bool skip);
 
+	/**
+	 * Set the machine running the punchthrough and fallback servers, e.g. a local
+	 * tooling/room-server.cpp for testing offline. The servers must listen on the usual ports.
+	 * Only takes effect while there is no connection.
+	 *
+	 * @param address The IP address of the servers
+	 */
+	void setServer(const std::string& address);
+
+	/**
+	 * Set the machine running the relay coordinator, e.g. a local tooling/relay-server.cpp. There
+	 * is no relay unless one is set. Only takes effect while there is no connection.
+	 *
+	 * @param address The IP address of the relay coordinator, or empty for no relay
+	 */
+	void setRelay(const std::string& address);
+
+	/**
+	 * Set whether the host is the only writer of object state (see {@link isAuthoritative()}).
+	 * Should only be called by the host before the game starts; other players learn the mode when
+	 * the game starts.
+	 */
+	void setAuthoritative(bool value);
+
 	/**
 	 * Start the game with the current number of players.
 	 * Should only be called when the matchmaking status is waiting on others
@@ -207,6 +286,15 @@ class MagicInternetBox {
 	 */
 	void resolveBreach(uint8_t id);
 
+	/**
+	 * Inform other players that every breach belonging to a player has been fully resolved.
+	 *
+	 * Sent once in place of a shrink per health point, e.g. when that player disconnects.
+	 *
+	 * @param player The player whose breaches were resolved
+	 */
+	void resolvePlayerBreaches(uint8_t player);
+
 	/**
 	 * Inform other players that a task requiring two players has been created
 	 * (eg: locked doors from nondigital)
@@ -20,12 +20,16 @@ enum NetworkDataType {
 	AllSucceed,
 	ForceWin,
 	StateSync,
+	BreachResolveAll,
 
 	// Connection messages that can be received during gameplay
 	PlayerJoined = 50, // Doubles for both matchmaking and reconnect
 	PlayerDisconnect,  // Doubles for manually disconnecting
 	StartGame,
-	ChangeGame // Followed by 0 for restart, 1 for next level
+	ChangeGame, // Followed by 0 for restart, 1 for next level
+	Snapshot,   // Full state of the level for a player joining mid level
+	GMCheckpoint, // State of the host's GM, for whoever takes over if the host drops out
+	Compressed	  // Another message, compressed with StateReconciler::compress
 };
 
 #endif /* __NETWORK_DATA_TYPE_H__ */
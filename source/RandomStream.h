@@ -0,0 +1,110 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstdint>
+#include <random>
+
+/**
+ * A named stream of random numbers derived from the seed of a level.
+ *
+ * Every player learns the seed when the level starts, so every player can rebuild any stream and
+ * draw exactly what whoever else uses it draws. Streams split into named (or numbered, e.g. by
+ * player ID) child streams. What a child draws depends only on the seed and the path of names
+ * leading to it, never on how much has been drawn from its parent or any other stream.
+ *
+ * This is a UniformRandomBitGenerator, so it works with the standard distributions and shuffles.
+ */
+class RandomStream {
+   public:
+	/** The streams split off of a level seed */
+	enum class Name : uint32_t {
+		/** Challenge scheduling and placement by the host */
+		GM = 1,
+		/** Teleport angles after a failed stabilizer; split by player ID */
+		Teleport,
+		/** Directions of stabilizer challenges */
+		Stabilizer
+	};
+
+	using result_type = std::minstd_rand::result_type;
+
+   private:
+	/** The key identifying this stream */
+	uint64_t key;
+
+	/** The generator drawing this stream's numbers */
+	std::minstd_rand engine;
+
+	/** The number of numbers drawn so far */
+	uint32_t draws;
+
+	/** Scramble a 64 bit value (the SplitMix64 finalizer) */
+	static uint64_t mix(uint64_t x) {
+		// NOLINTNEXTLINE Magic numbers are the point of a hash
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull; // NOLINT
+		return x ^ (x >> 31);						  // NOLINT
+	}
+
+	/** Create the stream with the given key */
+	explicit RandomStream(uint64_t key)
+		: key(key), engine(static_cast<result_type>(key % std::minstd_rand::modulus)), draws(0) {}
+
+   public:
+	/** Create a stream for the level seed 0. Streams should normally come from {@link level}. */
+	RandomStream() : RandomStream(mix(0)) {}
+
+	/**
+	 * Returns the root stream of a level, from which every other stream is split.
+	 *
+	 * @param seed The level seed
+	 */
+	static RandomStream level(uint32_t seed) { return RandomStream(mix(seed)); }
+
+	/**
+	 * Returns the child stream with the given number.
+	 *
+	 * @param index The number of the child, e.g. a player ID
+	 */
+	RandomStream split(uint32_t index) const {
+		// Offset the index so that child 0 of any stream does not share its parent's key
+		return RandomStream(mix(key ^ mix(static_cast<uint64_t>(index) + 1)));
+	}
+
+	/**
+	 * Returns the child stream with the given name.
+	 *
+	 * @param name The name of the child
+	 */
+	RandomStream split(Name name) const { return split(static_cast<uint32_t>(name)); }
+
+	/** Draw the next number */
+	result_type operator()() {
+		draws++;
+		return engine();
+	}
+
+	/** Returns the number of numbers drawn from this stream so far */
+	uint32_t getDraws() const { return draws; }
+
+	/**
+	 * Skip ahead to the given number of draws, so that a player joining late draws what everyone
+	 * else does next. Does nothing if this stream is already past that point.
+	 *
+	 * @param target The number of draws to skip to
+	 */
+	void skipTo(uint32_t target) {
+		if (target > draws) {
+			engine.discard(target - draws);
+			draws = target;
+		}
+	}
+
+	/** The smallest number this can draw */
+	static constexpr result_type min() { return std::minstd_rand::min(); }
+
+	/** The largest number this can draw */
+	static constexpr result_type max() { return std::minstd_rand::max(); }
+};
+
+#endif /* RANDOM_STREAM_H */
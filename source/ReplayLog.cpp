@@ -0,0 +1,267 @@
+#include "ReplayLog.h"
+
+#include <array>
+#include <cstring>
+
+#include "Globals.h"
+#include "Varint.h"
+
+/** Magic bytes at the start of every log */
+constexpr std::array<char, 4> MAGIC = {'S', 'S', 'R', 'P'};
+
+/** Version of the log format */
+constexpr uint8_t FORMAT_VERSION = 1;
+
+/** FNV-1a offset basis */
+constexpr uint32_t FNV_BASIS = 2166136261u;
+
+/** FNV-1a prime */
+constexpr uint32_t FNV_PRIME = 16777619u;
+
+/** Payload sizes of the fixed size records */
+constexpr size_t LEVEL_SIZE = 9;
+constexpr size_t FRAME_SIZE = 9;
+constexpr size_t DIGEST_SIZE = 4;
+
+/** Append a 32 bit integer, little endian */
+static void put32(uint32_t value, std::vector<uint8_t>& out) {
+	for (unsigned int i = 0; i < 4; i++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+/** Append the bits of a float */
+static void putFloat(float value, std::vector<uint8_t>& out) {
+	uint32_t bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	put32(bits, out);
+}
+
+/** Read a 32 bit integer, little endian */
+static uint32_t get32(const uint8_t* in) {
+	uint32_t value = 0;
+	for (unsigned int i = 0; i < 4; i++) {
+		value |= static_cast<uint32_t>(in[i]) << (8 * i);
+	}
+	return value;
+}
+
+/** Read the bits of a float */
+static float getFloat(const uint8_t* in) {
+	const uint32_t bits = get32(in);
+	float value = 0;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/** Mix the given bytes into a hash */
+static void mix(uint32_t& hash, const void* data, size_t size) {
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * FNV_PRIME;
+	}
+}
+
+/** Mix a vector of plain values into a hash */
+template <typename T>
+static void mix(uint32_t& hash, const std::vector<T>& values) {
+	mix(hash, values.data(), values.size() * sizeof(T));
+}
+
+bool ReplayLog::start(const std::string& path) {
+	stop();
+	out.open(path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		CULogError("Could not open replay log %s", path.c_str());
+		return false;
+	}
+	out.write(MAGIC.data(), MAGIC.size());
+	out.put(static_cast<char>(FORMAT_VERSION));
+	out.put(static_cast<char>(globals::API_VER));
+	CULog("Recording replay to %s", path.c_str());
+	return true;
+}
+
+void ReplayLog::stop() {
+	if (out.is_open()) {
+		out.close();
+	}
+}
+
+void ReplayLog::write(Kind kind) {
+	if (!out.is_open()) {
+		return;
+	}
+	out.put(static_cast<char>(kind));
+	std::array<uint8_t, varint::MAX_SIZE> length{};
+	const size_t lengthSize = varint::encode(static_cast<uint32_t>(record.size()), length.data());
+	out.write(reinterpret_cast<const char*>(length.data()),
+			  static_cast<std::streamsize>(lengthSize));
+	out.write(reinterpret_cast<const char*>(record.data()),
+			  static_cast<std::streamsize>(record.size()));
+}
+
+void ReplayLog::level(uint8_t level, uint8_t playerID, uint8_t numPlayers, bool parity,
+					  bool authoritative, uint32_t seed) {
+	if (!out.is_open()) {
+		return;
+	}
+	record.clear();
+	record.push_back(level);
+	record.push_back(playerID);
+	record.push_back(numPlayers);
+	record.push_back(parity ? 1 : 0);
+	record.push_back(authoritative ? 1 : 0);
+	put32(seed, record);
+	write(Kind::Level);
+	// Level boundaries are rare; make sure a crash loses at most the level in progress
+	out.flush();
+}
+
+void ReplayLog::frame(float timestep, float roll, bool jump) {
+	if (!out.is_open()) {
+		return;
+	}
+	record.clear();
+	putFloat(timestep, record);
+	putFloat(roll, record);
+	record.push_back(jump ? 1 : 0);
+	write(Kind::Frame);
+}
+
+void ReplayLog::inbound(const cugl::ByteView& message) {
+	if (!out.is_open()) {
+		return;
+	}
+	record.assign(message.begin(), message.end());
+	write(Kind::Inbound);
+}
+
+void ReplayLog::outbound(const cugl::ByteView& message) {
+	if (!out.is_open()) {
+		return;
+	}
+	record.assign(message.begin(), message.end());
+	write(Kind::Outbound);
+}
+
+void ReplayLog::digest(const std::shared_ptr<ShipModel>& ship) {
+	if (!out.is_open()) {
+		return;
+	}
+	record.clear();
+	put32(hash(ship), record);
+	write(Kind::Digest);
+}
+
+uint32_t ReplayLog::hash(const std::shared_ptr<ShipModel>& ship) {
+	uint32_t hash = FNV_BASIS;
+
+	const float health = ship->getHealth();
+	mix(hash, &health, sizeof(health));
+	mix(hash, &ship->timeLeftInTimer, sizeof(ship->timeLeftInTimer));
+
+	const BreachStore& breaches = ship->getBreachStore();
+	mix(hash, breaches.angle);
+	mix(hash, breaches.health);
+	mix(hash, breaches.player);
+	mix(hash, breaches.active);
+
+	const DoorStore& doors = ship->getDoorStore();
+	mix(hash, doors.angle);
+	mix(hash, doors.active);
+	for (const auto& players : doors.playersOn) {
+		const unsigned long bits = players.to_ulong();
+		mix(hash, &bits, sizeof(bits));
+	}
+
+	const ButtonStore& buttons = ship->getButtonStore();
+	mix(hash, buttons.angle);
+	mix(hash, buttons.pairID);
+	mix(hash, buttons.jumped);
+	mix(hash, buttons.active);
+
+	for (const auto& donut : ship->getDonuts()) {
+		const std::array<float, 3> motion = {donut->getAngle(), donut->getVelocity(),
+											 donut->getJumpOffset()};
+		mix(hash, motion.data(), sizeof(motion));
+	}
+
+	const auto stabilizer = static_cast<uint8_t>(ship->getStabilizer().getState());
+	mix(hash, &stabilizer, sizeof(stabilizer));
+
+	return hash;
+}
+
+bool ReplayLog::read(const std::string& path, std::vector<Entry>& entries) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		CULogError("Could not open replay log %s", path.c_str());
+		return false;
+	}
+	const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+									std::istreambuf_iterator<char>());
+
+	const size_t headerSize = MAGIC.size() + 2;
+	if (data.size() < headerSize || std::memcmp(data.data(), MAGIC.data(), MAGIC.size()) != 0 ||
+		data[MAGIC.size()] != FORMAT_VERSION) {
+		CULogError("%s is not a replay log", path.c_str());
+		return false;
+	}
+	if (data[MAGIC.size() + 1] != globals::API_VER) {
+		CULogError("Replay log API %d does not match game API %d", data[MAGIC.size() + 1],
+				   globals::API_VER);
+		return false;
+	}
+
+	size_t index = headerSize;
+	while (index < data.size()) {
+		Entry entry;
+		entry.kind = static_cast<Kind>(data[index++]);
+
+		const auto encoded = varint::decode(data.data(), data.size(), index);
+		if (!encoded.has_value() || *encoded > data.size() - index) {
+			return false;
+		}
+		const size_t length = *encoded;
+		const uint8_t* payload = data.data() + index;
+		index += length;
+
+		switch (entry.kind) {
+			case Kind::Level:
+				if (length < LEVEL_SIZE) {
+					return false;
+				}
+				entry.level = payload[0];
+				entry.playerID = payload[1];
+				entry.numPlayers = payload[2];
+				entry.parity = payload[3] != 0;
+				entry.authoritative = payload[4] != 0;
+				entry.seed = get32(payload + 5);
+				break;
+			case Kind::Frame:
+				if (length < FRAME_SIZE) {
+					return false;
+				}
+				entry.timestep = getFloat(payload);
+				entry.roll = getFloat(payload + 4);
+				entry.jump = payload[8] != 0;
+				break;
+			case Kind::Inbound:
+			case Kind::Outbound:
+				entry.message.assign(payload, payload + length);
+				break;
+			case Kind::Digest:
+				if (length < DIGEST_SIZE) {
+					return false;
+				}
+				entry.digest = get32(payload);
+				break;
+			default:
+				// Unknown records from newer recorders are skipped
+				continue;
+		}
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
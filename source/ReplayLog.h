@@ -0,0 +1,165 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CUNetworkConnection.h"
+#include "ShipModel.h"
+
+/**
+ * A compact binary log of one player's view of a game, for re-simulating it offline.
+ *
+ * The log records the start of every level (with the seed its random number generators were given),
+ * the roll and jump input of every gameplay frame, every message sent and received through the
+ * network, and a digest of the ship after every simulated frame. Messages are stamped implicitly by
+ * their position between frame records.
+ *
+ * Recording is done through the singleton, which is a no-op until {@link start} is called. Logs are
+ * read back with {@link read}; see tooling/replay-sim.cpp for the re-simulator.
+ *
+ * FORMAT
+ *
+ * [ "SSRP" | format version (1 byte) | API version (1 byte) ] followed by records of the form
+ * [ kind (1 byte) | payload length (varint) | payload ]. Multi-byte fields are little endian and
+ * floats are stored as their raw bits.
+ */
+class ReplayLog {
+   public:
+	/** The kind of a record */
+	enum class Kind : uint8_t {
+		/** [ level | player ID | number of players | parity | authoritative | seed (4 bytes) ] */
+		Level = 0,
+		/** [ timestep (4 bytes) | roll (4 bytes) | jump ] */
+		Frame,
+		/** A message received from the network */
+		Inbound,
+		/** A message sent to the network */
+		Outbound,
+		/** [ digest of the ship after the previous frame (4 bytes) ] */
+		Digest
+	};
+
+	/** A decoded record */
+	struct Entry {
+		/** The kind of this record; determines which fields below are set */
+		Kind kind = Kind::Frame;
+
+		/** Level number */
+		uint8_t level = 0;
+		/** ID of the recording player */
+		uint8_t playerID = 0;
+		/** Total number of players in the ship */
+		uint8_t numPlayers = 0;
+		/** Level parity from MagicInternetBox */
+		bool parity = true;
+		/** Whether the host was authoritative */
+		bool authoritative = false;
+		/** Seed given to the ship and GM */
+		uint32_t seed = 0;
+
+		/** Frame timestep in seconds */
+		float timestep = 0;
+		/** Roll input */
+		float roll = 0;
+		/** Whether the player pressed jump */
+		bool jump = false;
+
+		/** Ship digest */
+		uint32_t digest = 0;
+
+		/** Raw network message */
+		std::vector<uint8_t> message;
+	};
+
+   private:
+	/** The file being recorded to */
+	std::ofstream out;
+
+	/** Scratch space for the record being written */
+	std::vector<uint8_t> record;
+
+	/** Create an idle recorder. This constructor is private, as this class is a singleton. */
+	ReplayLog() = default;
+
+	/** Write the record in the scratch space with the given kind */
+	void write(Kind kind);
+
+   public:
+	ReplayLog(const ReplayLog&) = delete;
+	void operator=(const ReplayLog&) = delete;
+
+	/**
+	 * Grab the singleton recorder
+	 */
+	static ReplayLog& getInstance() {
+		static ReplayLog log;
+		return log;
+	}
+
+	/**
+	 * Start recording to the given file, replacing its contents.
+	 *
+	 * @param path The file to record to
+	 * @returns Whether the file could be opened
+	 */
+	bool start(const std::string& path);
+
+	/** Stop recording and close the file */
+	void stop();
+
+	/** Returns whether a recording is in progress */
+	bool isRecording() const { return out.is_open(); }
+
+	/**
+	 * Record the start of a level.
+	 *
+	 * @param level         The level number
+	 * @param playerID      The ID of this player
+	 * @param numPlayers    The total number of players in the ship
+	 * @param parity        The level parity from MagicInternetBox
+	 * @param authoritative Whether the host is authoritative
+	 * @param seed          The seed given to the ship and GM
+	 */
+	void level(uint8_t level, uint8_t playerID, uint8_t numPlayers, bool parity,
+			   bool authoritative, uint32_t seed);
+
+	/**
+	 * Record the input of a frame of gameplay. The models are only stepped if the level is neither
+	 * won nor lost.
+	 *
+	 * @param timestep The frame timestep in seconds
+	 * @param roll     The roll input
+	 * @param jump     Whether jump was pressed
+	 */
+	void frame(float timestep, float roll, bool jump);
+
+	/** Record a message received from the network */
+	void inbound(const cugl::ByteView& message);
+
+	/** Record a message sent to the network */
+	void outbound(const cugl::ByteView& message);
+
+	/** Record the digest of the given ship after a simulated frame */
+	void digest(const std::shared_ptr<ShipModel>& ship);
+
+	/**
+	 * Returns a hash of the simulated state of the given ship: health, timer, every object and
+	 * every donut. Floats are hashed bit for bit, so any divergence at all changes the digest.
+	 */
+	static uint32_t hash(const std::shared_ptr<ShipModel>& ship);
+
+	/**
+	 * Read every record of a log.
+	 *
+	 * @param path    The log file
+	 * @param entries The vector to append the records to
+	 * @returns Whether the whole file was read; false if it is missing, of another format or API
+	 * version, or truncated (in which case every complete record is still appended)
+	 */
+	static bool read(const std::string& path, std::vector<Entry>& entries);
+};
+
+#endif /* REPLAY_LOG_H */
@@ -0,0 +1,12 @@
+#include "ReplayNetworkConnection.h"
+
+using namespace cugl;
+
+void ReplayNetworkConnection::receive(const std::function<void(const ByteView&)>& dispatcher) {
+	// Swap out first, in case the dispatcher pushes more messages
+	std::vector<std::vector<uint8_t>> messages;
+	messages.swap(inbox);
+	for (const auto& msg : messages) {
+		dispatcher(msg);
+	}
+}
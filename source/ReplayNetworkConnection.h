@@ -0,0 +1,73 @@
+#ifndef REPLAY_NETWORK_CONNECTION_H
+#define REPLAY_NETWORK_CONNECTION_H
+
+#include <vector>
+
+#include "CUNetworkConnection.h"
+
+namespace cugl {
+/**
+ * Network connection that plays back recorded traffic instead of talking to anyone.
+ *
+ * Messages pushed into this connection are handed out on the next call to receive, and every
+ * message sent is kept so that it can be compared against the recording. The connection is always
+ * connected, and every player in the ship is always active.
+ */
+class ReplayNetworkConnection : public NetworkConnection {
+   private:
+	/** This player's ID */
+	uint8_t playerID;
+	/** The number of players in the ship */
+	uint8_t numPlayers;
+	/** Messages waiting for the next receive */
+	std::vector<std::vector<uint8_t>> inbox;
+	/** Messages sent since the last call to takeSent */
+	std::vector<std::vector<uint8_t>> sent;
+
+   public:
+	/**
+	 * Creates a connection that plays back a recording made by the given player.
+	 *
+	 * @param playerID   The ID of the player that made the recording
+	 * @param numPlayers The number of players in the ship
+	 */
+	ReplayNetworkConnection(uint8_t playerID, uint8_t numPlayers)
+		: playerID(playerID), numPlayers(numPlayers) {}
+
+	/** Queue a recorded message for the next call to receive */
+	void push(const std::vector<uint8_t>& msg) { inbox.push_back(msg); }
+
+	/** Returns the messages sent since the last call, and forgets them */
+	std::vector<std::vector<uint8_t>> takeSent() {
+		std::vector<std::vector<uint8_t>> result;
+		result.swap(sent);
+		return result;
+	}
+
+	void send(const std::vector<uint8_t>& msg) override { sent.push_back(msg); }
+
+	void sendOnlyToHost(const std::vector<uint8_t>& msg) override { sent.push_back(msg); }
+
+	void receive(const std::function<void(const ByteView&)>& dispatcher) override;
+
+	void manualDisconnect() override {}
+
+	void startGame() override {}
+
+	NetStatus getStatus() const override { return NetStatus::Connected; }
+
+	tl::optional<uint8_t> getPlayerID() const override { return playerID; }
+
+	std::string getRoomID() const override { return "REPLAY"; }
+
+	bool isPlayerActive(uint8_t /*playerID*/) const override { return true; }
+
+	uint8_t getNumPlayers() const override { return numPlayers; }
+
+	uint8_t getTotalPlayers() const override { return numPlayers; }
+
+	uint8_t getHostID() const override { return 0; }
+};
+}; // namespace cugl
+
+#endif /* REPLAY_NETWORK_CONNECTION_H */
@@ -1,5 +1,7 @@
 ﻿#include "ShipModel.h"
 
+#include <algorithm>
+
 #include "CollisionController.h"
 #include "ExternalDonutModel.h"
 #include "Globals.h"
@@ -7,9 +9,6 @@
 #include "PlayerDonutModel.h"
 #include "SoundEffectController.h"
 
-/** Max number of attempts of generating a new teleportation angle */
-constexpr int MAX_NEW_ANGLE_ATTEMPTS = 1000;
-
 // Health
 /** Grace period for a breach before it starts deducting health */
 constexpr float BREACH_HEALTH_GRACE_PERIOD = 5.0f;
@@ -17,11 +16,12 @@ constexpr float BREACH_HEALTH_GRACE_PERIOD = 5.0f;
 constexpr float BREACH_HEALTH_PENALTY = 0.003f;
 
 ShipModel::ShipModel()
-	: rand(static_cast<unsigned int>(
-		  std::chrono::high_resolution_clock::now().time_since_epoch().count())),
-	  donuts(0),
+	: donuts(0),
 	  breaches(0),
 	  doors(0),
+	  breachStore(std::make_shared<BreachStore>()),
+	  doorStore(std::make_shared<DoorStore>()),
+	  buttonStore(std::make_shared<ButtonStore>()),
 	  initHealth(0),
 	  health(0),
 	  shipSize(0),
@@ -47,18 +47,24 @@ bool ShipModel::init(uint8_t numPlayers, uint8_t numBreaches, uint8_t numDoors,
 	}
 
 	// Instantiate breach models
+	breachStore = std::make_shared<BreachStore>(numBreaches);
+	breaches.clear();
 	for (uint8_t i = 0; i < numBreaches; i++) {
-		breaches.push_back(std::make_shared<BreachModel>());
+		breaches.push_back(std::make_shared<BreachModel>(breachStore, i));
 	}
 
 	// Instantiate door models
+	doorStore = std::make_shared<DoorStore>(numDoors);
+	doors.clear();
 	for (uint8_t i = 0; i < numDoors; i++) {
-		doors.push_back(std::make_shared<DoorModel>());
+		doors.push_back(std::make_shared<DoorModel>(doorStore, i));
 	}
 
 	// Instantiate button models
+	buttonStore = std::make_shared<ButtonStore>(numButtons);
+	buttons.clear();
 	for (uint8_t i = 0; i < numButtons; i++) {
-		buttons.push_back(std::make_shared<ButtonModel>());
+		buttons.push_back(std::make_shared<ButtonModel>(buttonStore, i));
 	}
 
 	// Instantiate health
@@ -99,6 +105,17 @@ bool ShipModel::resolveBreach(uint8_t id) {
 	return true;
 }
 
+bool ShipModel::resolvePlayerBreaches(uint8_t player) {
+	bool resolved = false;
+	for (size_t i = 0; i < breachStore->size(); i++) {
+		if (breachStore->active[i] != 0 && breachStore->player[i] == player) {
+			breaches[i]->decHealth(breachStore->health[i]);
+			resolved = true;
+		}
+	}
+	return resolved;
+}
+
 bool ShipModel::flagDoor(uint8_t id, uint8_t player, uint8_t flag) {
 	if (flag == 0) {
 		doors.at(id)->removePlayer(player);
@@ -122,35 +139,14 @@ bool ShipModel::failAllTask() {
 	SoundEffectController::getInstance()->endEvent(SoundEffectController::TELEPORT, 0);
 
 	const auto& donut = donuts.at(*MagicInternetBox::getInstance().getPlayerID());
-	float newAngle = 0;
-	bool goodAngle = false;
-	int attempts = 0;
-	while (!goodAngle && attempts < MAX_NEW_ANGLE_ATTEMPTS) {
-		// Generate random angle
-		newAngle = std::fmodf(static_cast<float>(rand()), getSize());
-		goodAngle = true;
-		attempts += 1;
-		// Check against breaches
-		for (auto& breach : breaches) {
-			const float breachAngle = breach->getAngle();
-			const float diff = getAngleDifference(breachAngle, newAngle);
-			if (diff <= MIN_DISTANCE && breachAngle != -1) {
-				goodAngle = false;
-				break;
-			}
-		}
-		if (!goodAngle) {
-			continue;
-		}
-		// Check against doors
-		for (auto& door : doors) {
-			const float doorAngle = door->getAngle();
-			const float diff = getAngleDifference(doorAngle, newAngle);
-			if (diff <= MIN_DISTANCE && doorAngle != -1) {
-				goodAngle = false;
-				break;
-			}
-		}
+	AngleIndex index;
+	indexObjects(index, MIN_DISTANCE, MIN_DISTANCE, 0);
+	index.build();
+	std::uniform_real_distribution<float> fraction(0, 1);
+	float newAngle = index.sample(fraction(rand));
+	if (newAngle < 0) {
+		// The ship is packed, so anywhere is as good as anywhere else
+		newAngle = fraction(rand) * getSize();
 	}
 	CULog("Setting teleport angle %f", newAngle);
 	donut->setTeleportAngle(newAngle);
@@ -158,6 +154,26 @@ bool ShipModel::failAllTask() {
 	return true;
 }
 
+void ShipModel::indexObjects(AngleIndex& index, float breachRadius, float doorRadius,
+							 float buttonRadius) const {
+	index.clear(shipSize);
+	for (const auto& breach : breaches) {
+		if (breach->getIsActive()) {
+			index.block(breach->getAngle(), breachRadius);
+		}
+	}
+	for (const auto& door : doors) {
+		if (door->getIsActive()) {
+			index.block(door->getAngle(), doorRadius);
+		}
+	}
+	for (const auto& button : buttons) {
+		if (button->getIsActive()) {
+			index.block(button->getAngle(), buttonRadius);
+		}
+	}
+}
+
 bool ShipModel::createButton(float angle1, uint8_t id1, float angle2, uint8_t id2) {
 	buttons[id1]->init(angle1, buttons.at(id2), id2);
 	buttons[id2]->init(angle2, buttons.at(id1), id1);
@@ -175,17 +191,29 @@ void ShipModel::resolveButton(uint8_t id) {
 	btn->reset();
 }
 
+std::shared_ptr<ShipModel> ShipModel::alloc(const std::shared_ptr<LevelModel>& level,
+											 uint8_t numPlayers, uint8_t playerID) {
+	const unsigned int maxEvents = level->getMaxBreaches() * numPlayers / globals::MIN_PLAYERS;
+	const unsigned int maxDoors = std::min(level->getMaxDoors() * numPlayers / globals::MIN_PLAYERS,
+										   static_cast<int>(numPlayers) * 2 - 1);
+	unsigned int maxButtons = level->getMaxButtons() * numPlayers / globals::MIN_PLAYERS;
+	if (maxButtons % 2 != 0) {
+		maxButtons += 1;
+	}
+	const float initHealth =
+		level->getInitHealth() * static_cast<float>(numPlayers) / globals::MIN_PLAYERS;
+	auto ship = alloc(numPlayers, maxEvents, maxDoors, playerID, level->getShipSize(numPlayers),
+					  initHealth, maxButtons);
+	ship->initTimer(level->getTime());
+	return ship;
+}
+
 void ShipModel::update(float timestep) {
 	// Update timer
 	if (!timerEnded()) {
-		bool allButtonsInactive = true;
-
-		for (auto& button : buttons) {
-			if (button->getIsActive()) {
-				allButtonsInactive = false;
-				break;
-			}
-		}
+		const auto& active = buttonStore->active;
+		const bool allButtonsInactive =
+			std::find(active.begin(), active.end(), 1) == active.end();
 		updateTimer(timestep, allButtonsInactive);
 	}
 
@@ -195,7 +223,9 @@ void ShipModel::update(float timestep) {
 	}
 
 	// Collision Detection
-	CollisionController::updateCollisions(*this, *MagicInternetBox::getInstance().getPlayerID());
+	auto& mib = MagicInternetBox::getInstance();
+	CollisionController::updateCollisions(*this, *mib.getPlayerID(), mib.isAuthoritative(),
+										  mib.isHost());
 
 	// Update door models
 	for (const auto& door : doors) {
@@ -203,7 +233,8 @@ void ShipModel::update(float timestep) {
 	}
 
 	// Update stabilizer model
-	if (stabilizer.update(getTimeless() ? -1 : timeLeftInTimer, donuts)) {
+	kinematics.gather(donuts);
+	if (stabilizer.update(getTimeless() ? -1 : timeLeftInTimer, kinematics)) {
 		if (stabilizer.getIsWin()) {
 			MagicInternetBox::getInstance().succeedAllTask();
 			stabilizerTutorial = true;
@@ -215,10 +246,11 @@ void ShipModel::update(float timestep) {
 	}
 
 	// Health drain
-	for (const auto& breach : breaches) {
+	const float now = trunc(canonicalTimeElapsed);
+	for (size_t i = 0; i < breachStore->size(); i++) {
 		// this should be adjusted based on the level and number of players
-		if (breach->getIsActive() && trunc(canonicalTimeElapsed) - trunc(breach->getTimeCreated()) >
-										 BREACH_HEALTH_GRACE_PERIOD) {
+		if (breachStore->active[i] != 0 &&
+			now - trunc(breachStore->timeCreated[i]) > BREACH_HEALTH_GRACE_PERIOD) {
 			decHealth(BREACH_HEALTH_PENALTY);
 		}
 	}
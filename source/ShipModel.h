@@ -2,22 +2,28 @@
 #define SHIP_MODEL_H
 #include <cugl/cugl.h>
 
+#include "AngleIndex.h"
 #include "BreachModel.h"
 #include "ButtonModel.h"
+#include "DonutKinematics.h"
 #include "DonutModel.h"
 #include "DoorModel.h"
 #include "Globals.h"
+#include "LevelModel.h"
+#include "RandomStream.h"
 #include "StabilizerModel.h"
 #include "Unopenable.h"
 
 class ShipModel {
    private:
-	/** Random number generator */
-	std::minstd_rand rand;
+	/** Random number generator; this player's teleport stream of the level */
+	RandomStream rand;
 
 #pragma region Models
 	/** Current list of breaches on ship*/
 	std::vector<std::shared_ptr<DonutModel>> donuts;
+	/** Angle, velocity and activity of every donut, gathered each frame */
+	DonutKinematics kinematics;
 	/** Current list of breaches on ship*/
 	std::vector<std::shared_ptr<BreachModel>> breaches;
 	/** Current list of doors on ship*/
@@ -26,6 +32,12 @@ class ShipModel {
 	std::vector<std::shared_ptr<Unopenable>> unopenable;
 	/** Current list of doors on ship*/
 	std::vector<std::shared_ptr<ButtonModel>> buttons;
+	/** Packed fields of every breach, viewed through breaches */
+	std::shared_ptr<BreachStore> breachStore;
+	/** Packed fields of every door, viewed through doors */
+	std::shared_ptr<DoorStore> doorStore;
+	/** Packed fields of every button, viewed through buttons */
+	std::shared_ptr<ButtonStore> buttonStore;
 	/** Stabilizer model */
 	StabilizerModel stabilizer;
 #pragma endregion
@@ -167,6 +179,19 @@ class ShipModel {
 					: nullptr);
 	}
 
+	/**
+	 * Create and return a shared pointer to a new ship model for a (non tutorial) level, with its
+	 * objects, size and health scaled to the number of players and its timer started.
+	 *
+	 * @param level      The level
+	 * @param numPlayers The number of players in this ship
+	 * @param playerID   The ID of the current local player
+	 *
+	 * @return A smart pointer to a newly initialized ship model
+	 */
+	static std::shared_ptr<ShipModel> alloc(const std::shared_ptr<LevelModel>& level,
+											uint8_t numPlayers, uint8_t playerID);
+
 #pragma mark -
 #pragma mark Accessors
 	/**
@@ -176,6 +201,11 @@ class ShipModel {
 	 */
 	std::vector<std::shared_ptr<DonutModel>>& getDonuts() { return donuts; }
 
+	/**
+	 * Returns the packed state of every donut, as of the last stabilizer step.
+	 */
+	const DonutKinematics& getKinematics() const { return kinematics; }
+
 	/**
 	 * Returns the current list of breaches.
 	 *
@@ -204,6 +234,38 @@ class ShipModel {
 	 */
 	std::vector<std::shared_ptr<ButtonModel>>& getButtons() { return buttons; }
 
+	/**
+	 * Returns the packed fields of every breach, indexed by breach id.
+	 *
+	 * Per-frame loops over all breaches should read this rather than the models.
+	 */
+	const BreachStore& getBreachStore() const { return *breachStore; }
+
+	/**
+	 * Returns the packed fields of every door, indexed by door id.
+	 */
+	const DoorStore& getDoorStore() const { return *doorStore; }
+
+	/**
+	 * Returns the packed fields of every button, indexed by button id.
+	 */
+	const ButtonStore& getButtonStore() const { return *buttonStore; }
+
+	/**
+	 * Returns the ids of the inactive breaches. Breaches keep this up to date themselves.
+	 */
+	FreeSlots& getFreeBreaches() { return breachStore->slots; }
+
+	/**
+	 * Returns the ids of the inactive doors. Doors keep this up to date themselves.
+	 */
+	FreeSlots& getFreeDoors() { return doorStore->slots; }
+
+	/**
+	 * Returns the ids of the unused buttons. Buttons keep this up to date themselves.
+	 */
+	FreeSlots& getFreeButtons() { return buttonStore->slots; }
+
 	/**
 	 * Create breach.
 	 *
@@ -230,6 +292,15 @@ class ShipModel {
 	 */
 	bool resolveBreach(uint8_t id);
 
+	/**
+	 * Fully resolves every active breach belonging to the given player.
+	 *
+	 * @param player the player whose breaches should be resolved.
+	 *
+	 * @return true if any breach was resolved.
+	 */
+	bool resolvePlayerBreaches(uint8_t player);
+
 	/**
 	 * Create door with given id.
 	 *
@@ -401,6 +472,18 @@ class ShipModel {
 	 */
 	void setLevelNum(uint8_t l) { levelNum = l; }
 
+	/**
+	 * Seeds the random number generators of this ship and its stabilizer from the given level
+	 * seed, so that every player draws the same numbers and a level can be replayed exactly.
+	 *
+	 * @param levelSeed The level seed
+	 * @param playerID  The ID of the current local player, whose teleport stream to draw from
+	 */
+	void seed(uint32_t levelSeed, uint8_t playerID) {
+		rand = RandomStream::level(levelSeed).split(RandomStream::Name::Teleport).split(playerID);
+		stabilizer.seed(levelSeed);
+	}
+
 	/**
 	 * Separates each donut into their own section
 	 */
@@ -432,5 +515,17 @@ class ShipModel {
 	float getAngleDifference(float angle1, float angle2) const {
 		return shipSize / 2 - abs(abs(angle1 - angle2) - shipSize / 2);
 	}
+
+	/**
+	 * Resets the given index to the size of this ship and blocks the arc around every active
+	 * breach, door and button. The index is not built, so callers may block more before building.
+	 *
+	 * @param index        The index to fill
+	 * @param breachRadius The distance to keep clear around each breach
+	 * @param doorRadius   The distance to keep clear around each door
+	 * @param buttonRadius The distance to keep clear around each button
+	 */
+	void indexObjects(AngleIndex& index, float breachRadius, float doorRadius,
+					  float buttonRadius) const;
 };
 #endif /* SHIP_MODEL_H */
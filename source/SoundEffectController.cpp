@@ -4,3 +4,52 @@ using namespace cugl;
 
 // Apparently this is necessary...
 std::shared_ptr<SoundEffectController> SoundEffectController::instance; // NOLINT (clang-tidy bug)
+constexpr std::array<const char*, SoundEffectController::NUM_EFFECTS> SoundEffectController::FILES;
+constexpr std::array<unsigned int, SoundEffectController::NUM_EFFECTS> SoundEffectController::VOICES;
+
+void SoundEffectController::init(const std::shared_ptr<cugl::AssetManager>& assets) {
+	for (unsigned int e = 0; e < NUM_EFFECTS; e++) {
+		Bank& bank = banks.at(e);
+		bank.sound = assets->get<Sound>(FILES.at(e));
+		bank.voices = VOICES.at(e);
+		bank.next = 0;
+		for (unsigned int v = 0; v < bank.voices; v++) {
+			bank.keys.at(v) = std::string(FILES.at(e)) + std::to_string(v);
+		}
+	}
+}
+
+unsigned int SoundEffectController::pickVoice(Bank& bank) {
+	// Round robin from the oldest voice, so a steal always takes the least recent one
+	unsigned int voice = bank.next;
+	for (unsigned int i = 0; i < bank.voices; i++) {
+		unsigned int v = (bank.next + i) % bank.voices;
+		if (!AudioChannels::get()->isActiveEffect(bank.keys.at(v))) {
+			voice = v;
+			break;
+		}
+	}
+	bank.next = (voice + 1) % bank.voices;
+	return voice;
+}
+
+void SoundEffectController::startEvent(Effect e, int id, float gain, float pan) {
+	Bank& bank = banks.at(e);
+	if (bank.sound == nullptr || id < 0) {
+		return;
+	}
+	if (static_cast<size_t>(id) >= bank.active.size()) {
+		bank.active.resize(id + 1, false);
+	}
+
+	// Check if this event has already been registered
+	if (bank.active[id]) {
+		return;
+	}
+	bank.active[id] = true;
+
+	const std::string& key = bank.keys.at(pickVoice(bank));
+	if (AudioChannels::get()->playEffect(key, bank.sound, false, gain, true)) {
+		AudioChannels::get()->setEffectPan(key, pan);
+	}
+}
@@ -2,29 +2,57 @@
 #define SOUND_EFFECT_CONTROLLER_H
 #include <cugl/cugl.h>
 
-#include <map>
+#include <array>
+#include <string>
+#include <vector>
 
 /**
  * This class represents sound effects
  *
+ * Each effect owns a small pool of voices, which are reserved sound effect channels in {@link
+ * cugl::AudioChannels}. The same effect can overlap with itself up to its number of voices; past
+ * that, the oldest voice of that effect is stolen rather than the new sound being dropped. The
+ * voice counts sum to at most the number of channels the engine is started with, so one effect
+ * can never starve another.
+ *
+ * All effect samples are decoded once at load time and shared by every voice.
+ *
  * This class is a singleton. It is initialized the first time the instance is acquired.
  */
 class SoundEffectController {
+   public:
+	enum Effect { JUMP = 0, DOOR = 1, FIX = 2, SLOW = 3, CLICK = 4, TELEPORT = 5 };
+
+	/** The number of distinct effects */
+	static constexpr unsigned int NUM_EFFECTS = 6;
+
+	/** The maximum number of voices any single effect may have */
+	static constexpr unsigned int MAX_VOICES = 6;
+
    private:
+	/**
+	 * The voice pool for a single effect
+	 */
+	struct Bank {
+		/** The shared sample for this effect */
+		std::shared_ptr<cugl::Sound> sound;
+		/** The channel key of each voice, built once so playing never allocates */
+		std::array<std::string, MAX_VOICES> keys;
+		/** The number of voices in this bank */
+		unsigned int voices = 0;
+		/** The voice to steal next (the least recently started) */
+		unsigned int next = 0;
+		/** Whether each event id is currently active, indexed by id */
+		std::vector<bool> active;
+	};
+
 	/**
 	 * The singleton instance of this class.
 	 */
 	static std::shared_ptr<SoundEffectController> instance; // NOLINT
 
-	/** List of actively playing effects. */
-	std::map<std::pair<int, int>, bool> activeEffects;
-
-	std::shared_ptr<cugl::Sound> jump;
-	std::shared_ptr<cugl::Sound> doorCollide;
-	std::shared_ptr<cugl::Sound> fixBreach;
-	std::shared_ptr<cugl::Sound> slowBreach;
-	std::shared_ptr<cugl::Sound> click;
-	std::shared_ptr<cugl::Sound> teleport;
+	/** The voice pool for each effect, indexed by {@link Effect} */
+	std::array<Bank, NUM_EFFECTS> banks;
 
 	static constexpr auto JUMP_FILE = "jump";
 	static constexpr auto DOOR_FILE = "doorCollide";
@@ -33,6 +61,13 @@ class SoundEffectController {
 	static constexpr auto CLICK_FILE = "click";
 	static constexpr auto TELEPORT_FILE = "teleport";
 
+	/** The asset name of each effect, indexed by {@link Effect} */
+	static constexpr std::array<const char*, NUM_EFFECTS> FILES = {
+		JUMP_FILE, DOOR_FILE, FIX_FILE, SLOW_FILE, CLICK_FILE, TELEPORT_FILE};
+
+	/** The number of voices for each effect, indexed by {@link Effect}. Sums to at most 24. */
+	static constexpr std::array<unsigned int, NUM_EFFECTS> VOICES = {6, 4, 4, 4, 2, 1};
+
 	/**
 	 * Creates a new sound effect controller.
 	 *
@@ -41,9 +76,14 @@ class SoundEffectController {
 	 */
 	SoundEffectController() = default;
 
-   public:
-	enum Effect { JUMP = 0, DOOR = 1, FIX = 2, SLOW = 3, CLICK = 4, TELEPORT = 5 };
+	/**
+	 * Return the voice of the given bank to play on, stealing the oldest voice if all are busy.
+	 *
+	 * @param bank The voice pool to pick from
+	 */
+	static unsigned int pickVoice(Bank& bank);
 
+   public:
 #pragma region Constructors
 
 	/**
@@ -61,75 +101,40 @@ class SoundEffectController {
 	 * Initialize the Sound Effect controller with the given assets.
 	 *
 	 */
-	void init(const std::shared_ptr<cugl::AssetManager>& assets) {
-		jump = assets->get<cugl::Sound>(JUMP_FILE);
-		doorCollide = assets->get<cugl::Sound>(DOOR_FILE);
-		fixBreach = assets->get<cugl::Sound>(FIX_FILE);
-		slowBreach = assets->get<cugl::Sound>(SLOW_FILE);
-		click = assets->get<cugl::Sound>(CLICK_FILE);
-		teleport = assets->get<cugl::Sound>(TELEPORT_FILE);
-	}
+	void init(const std::shared_ptr<cugl::AssetManager>& assets);
 
 	/**
 	 * Register an event occurring, and if a sound has not already been played for it, play a sound
 	 * effect.
 	 *
-	 *
+	 * @param e    The effect to play
+	 * @param id   The id of the event within that effect (e.g. the breach or player id)
+	 * @param gain The voice gain, or negative to use the asset volume
+	 * @param pan  The voice stereo pan, from -1 (left) to 1 (right)
 	 */
-	void startEvent(Effect e, int id) {
-		// Check if this event has already been registered
-		if (!activeEffects[{e, id}]) {
-			activeEffects[{e, id}] = true;
-			std::shared_ptr<cugl::Sound> sound; // NOLINT switch statement sets these
-			const char* key;					// NOLINT
-			switch (e) {
-				case JUMP:
-					sound = jump;
-					key = JUMP_FILE;
-					break;
-				case DOOR:
-					sound = doorCollide;
-					key = DOOR_FILE;
-					break;
-				case FIX:
-					sound = fixBreach;
-					key = FIX_FILE;
-					break;
-				case SLOW:
-					sound = slowBreach;
-					key = SLOW_FILE;
-					break;
-				case CLICK:
-					sound = click;
-					key = CLICK_FILE;
-					break;
-				case TELEPORT:
-					sound = teleport;
-					key = TELEPORT_FILE;
-					break;
-			}
-			if (!cugl::AudioChannels::get()->isActiveEffect(key)) {
-				cugl::AudioChannels::get()->playEffect(key, sound, false);
-				cugl::AudioChannels::get()->setEffectPan(key, 0);
-			}
-		}
-	}
+	void startEvent(Effect e, int id, float gain = -1, float pan = 0);
 
 	/**
 	 * Register an event ending.
 	 *
-	 *
+	 * @param e  The effect of the event
+	 * @param id The id of the event within that effect
 	 */
 	void endEvent(Effect e, int id) {
-		if (activeEffects[{e, id}]) {
-			activeEffects[{e, id}] = false;
+		Bank& bank = banks.at(e);
+		if (id >= 0 && static_cast<size_t>(id) < bank.active.size()) {
+			bank.active[id] = false;
 		}
 	}
 
 	/**
 	 * Clears all active events
 	 */
-	void reset() { activeEffects.clear(); }
+	void reset() {
+		for (auto& bank : banks) {
+			bank.active.assign(bank.active.size(), false);
+		}
+	}
 
 	/**
 	 * Deactivates and disposes of this sound effect controller.
@@ -6,8 +6,7 @@
 constexpr unsigned int SUCCESS_CUTOFF = 60;
 
 StabilizerModel::StabilizerModel()
-	: rand(static_cast<unsigned int>(time(nullptr))), // NOLINT Good enough for us
-	  currState(StabilizerModel::StabilizerState::Inactive),
+	: currState(StabilizerModel::StabilizerState::Inactive),
 	  progress(0),
 	  endTime(0) {}
 
@@ -38,8 +37,7 @@ void StabilizerModel::startChallenge(float currTime) {
 	currState = (rand() % 2) != 0 ? StabilizerState::Left : StabilizerState::Right;
 }
 
-bool StabilizerModel::update(float timeRemaining,
-							 const std::vector<std::shared_ptr<DonutModel>>& donuts) {
+bool StabilizerModel::update(float timeRemaining, const DonutKinematics& donuts) {
 	if (!getIsActive()) {
 		return false;
 	}
@@ -50,26 +48,7 @@ bool StabilizerModel::update(float timeRemaining,
 		return false;
 	}
 
-	bool allRoll = true;
-
-	for (const auto& allDonut : donuts) {
-		if (!allDonut->getIsActive()) {
-			continue;
-		}
-		if (isLeft()) {
-			if (allDonut->getVelocity() >= 0) {
-				allRoll = false;
-				break;
-			}
-		} else {
-			if (allDonut->getVelocity() <= 0) {
-				allRoll = false;
-				break;
-			}
-		}
-	}
-
-	if (allRoll) {
+	if (donuts.allRolling(isLeft())) {
 		progress++;
 	}
 
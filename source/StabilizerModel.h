@@ -3,7 +3,8 @@
 
 #include <cugl/cugl.h>
 
-#include "DonutModel.h"
+#include "DonutKinematics.h"
+#include "RandomStream.h"
 
 class StabilizerModel {
    public:
@@ -12,7 +13,7 @@ class StabilizerModel {
 
    private:
 	/** Random number generator */
-	std::minstd_rand rand;
+	RandomStream rand;
 
 	/** Current state of the challenge */
 	StabilizerModel::StabilizerState currState;
@@ -31,6 +32,20 @@ class StabilizerModel {
 
 	virtual ~StabilizerModel() = default;
 
+	/**
+	 * Seed the random number generator that picks the direction of each challenge with the
+	 * stabilizer stream of the given level seed
+	 */
+	void seed(uint32_t levelSeed) {
+		rand = RandomStream::level(levelSeed).split(RandomStream::Name::Stabilizer);
+	}
+
+	/** Returns how far the random stream picking challenge directions has advanced */
+	uint32_t getDraws() const { return rand.getDraws(); }
+
+	/** Advance the random stream picking challenge directions to the given point */
+	void skipTo(uint32_t draws) { rand.skipTo(draws); }
+
 	/** Return whether this stabilizer is active */
 	bool getIsActive() const;
 
@@ -68,11 +83,11 @@ class StabilizerModel {
 	 *
 	 * @param timeRemaining Amount of time left as displayed on the ship's timer, or -1 for
 	 * timeless levels
-	 * @param donuts All donut models in ship
+	 * @param donuts Packed state of all donuts in ship
 	 * @returns True if the model performed computations this frame. If this returns true, the ship
 	 * should check to see if pass or fail happened this frame, and if so process accordingly.
 	 */
-	bool update(float timeRemaining, const std::vector<std::shared_ptr<DonutModel>>& donuts);
+	bool update(float timeRemaining, const DonutKinematics& donuts);
 
 	/** Immediately fail this challenge (usually b/c we received the command over networking) */
 	void fail();
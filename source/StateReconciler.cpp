@@ -1,5 +1,7 @@
 #include "StateReconciler.h"
 
+#include "NetworkDataType.h"
+
 /** Just the top bit in a byte */
 constexpr uint8_t TOP_BIT_MASK = 1 << 7;
 
@@ -12,6 +14,15 @@ constexpr uint16_t ONE_BYTE = 256;
 /** How close to consider floating point numbers identical */
 constexpr float FLOAT_EPSILON = 0.1f;
 
+/** Bytes in a 32 bit integer */
+constexpr size_t INT_BYTES = 4;
+
+/** Bytes before the first donut of a snapshot, including the flag byte */
+constexpr size_t SNAPSHOT_HEADER = 12;
+
+/** Bytes per donut in a snapshot */
+constexpr size_t SNAPSHOT_DONUT = 6;
+
 float StateReconciler::decodeFloat(uint8_t m1, uint8_t m2) {
 	return static_cast<float>(m1 + ONE_BYTE * m2) / FLOAT_PRECISION;
 }
@@ -33,6 +44,60 @@ std::pair<uint8_t, bool> StateReconciler::decodeLevelNum(uint8_t encodedLevel) {
 	return {encodedLevel, true};
 }
 
+void StateReconciler::encodeInt(uint32_t value, std::vector<uint8_t>& out) {
+	for (size_t i = 0; i < INT_BYTES; i++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+uint32_t StateReconciler::decodeInt(const cugl::ByteView& message, size_t index) {
+	uint32_t value = 0;
+	for (size_t i = 0; i < INT_BYTES; i++) {
+		value |= static_cast<uint32_t>(message[index + i]) << (8 * i);
+	}
+	return value;
+}
+
+void StateReconciler::compress(const cugl::ByteView& message, std::vector<uint8_t>& out) {
+	// [ byte ]* where a zero byte is followed by the number of zeros after it in the run
+	for (size_t i = 0; i < message.size();) {
+		if (message[i] != 0) {
+			out.push_back(message[i++]);
+			continue;
+		}
+		size_t run = 1;
+		while (run < ONE_BYTE && i + run < message.size() && message[i + run] == 0) {
+			run++;
+		}
+		out.push_back(0);
+		out.push_back(static_cast<uint8_t>(run - 1));
+		i += run;
+	}
+}
+
+bool StateReconciler::decompress(const cugl::ByteView& message, std::vector<uint8_t>& out) {
+	for (size_t i = 0; i < message.size(); i++) {
+		if (message[i] != 0) {
+			out.push_back(message[i]);
+			continue;
+		}
+		if (++i == message.size()) {
+			return false;
+		}
+		out.insert(out.end(), message[i] + size_t{1}, 0);
+	}
+	return true;
+}
+
+bool StateReconciler::confirmed(const std::unordered_map<unsigned int, bool>& cache,
+								unsigned int id, bool value) const {
+	if (authoritative) {
+		return true;
+	}
+	const auto entry = cache.find(id);
+	return entry != cache.end() && entry->second == value;
+}
+
 void StateReconciler::encode(const std::shared_ptr<ShipModel>& state, std::vector<uint8_t>& data,
 							 uint8_t level, bool parity) {
 	// Level data first
@@ -44,47 +109,52 @@ void StateReconciler::encode(const std::shared_ptr<ShipModel>& state, std::vecto
 	encodeFloat(state->timeLeftInTimer, data);
 
 	// Send Breaches
-	const auto& breaches = state->getBreaches();
+	const BreachStore& breaches = state->getBreachStore();
 	data.push_back(static_cast<uint8_t>(breaches.size()));
-	for (const auto& breach : breaches) {
-		data.push_back(breach->getHealth());
-		data.push_back(breach->getPlayer());
-		encodeFloat(breach->getAngle(), data);
+	for (size_t i = 0; i < breaches.size(); i++) {
+		if (breaches.health[i] == 0) {
+			// Nobody reads the rest of a resolved breach; zeros compress away
+			data.insert(data.end(), 4, 0);
+			continue;
+		}
+		data.push_back(breaches.health[i]);
+		data.push_back(breaches.player[i]);
+		encodeFloat(breaches.angle[i], data);
 	}
 
 	// Send Doors
-	const auto& doors = state->getDoors();
+	const DoorStore& doors = state->getDoorStore();
 	data.push_back(static_cast<uint8_t>(doors.size()));
-	for (const auto& door : doors) {
-		if (!door->getIsActive()) {
+	for (size_t i = 0; i < doors.size(); i++) {
+		if (doors.active[i] == 0) {
 			data.push_back(0);
 			data.push_back(0);
 			data.push_back(0);
 		} else {
 			data.push_back(1);
-			encodeFloat(door->getAngle(), data);
+			encodeFloat(doors.angle[i], data);
 		}
 	}
 
 	// Send Buttons
-	const auto& btns = state->getButtons();
+	const ButtonStore& btns = state->getButtonStore();
 	data.push_back(static_cast<uint8_t>(btns.size()));
-	for (const auto& btn : btns) {
-		if (!btn->getIsActive()) {
+	for (size_t i = 0; i < btns.size(); i++) {
+		if (btns.active[i] == 0) {
 			data.push_back(0);
 			data.push_back(0);
 			data.push_back(0);
 			data.push_back(0);
 		} else {
 			data.push_back(1);
-			encodeFloat(btn->getAngle(), data);
-			data.push_back(btn->getPairID());
+			encodeFloat(btns.angle[i], data);
+			data.push_back(btns.pairID[i]);
 		}
 	}
 }
 
 bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
-								const std::vector<uint8_t>& message, uint8_t level, bool parity) {
+								const cugl::ByteView& message, uint8_t level, bool parity) {
 	auto levelData = decodeLevelNum(message[1]);
 	if (levelData.first != level || levelData.second != parity) {
 		return false;
@@ -114,14 +184,14 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 	for (uint8_t i = 0; i < breaches.size(); i++) {
 		if (breaches[i]->getHealth() == 0 && message[index] > 0) {
 			const float angle = decodeFloat(message[index + 2], message[index + 3]);
-			if (breachCache.count(i) != 0 && breachCache[i]) {
+			if (confirmed(breachCache, i, true)) {
 				CULog("Found resolved breach that should be unresolved, id %d", i);
 				state->createBreach(angle, message[index], message[index + 1], static_cast<int>(i));
 			} else {
 				localBreach[i] = true;
 			}
 		} else if (breaches[i]->getHealth() > 0 && message[index] == 0) {
-			if (breachCache.count(i) != 0 && !breachCache[i]) {
+			if (confirmed(breachCache, i, false)) {
 				CULog("Found unresolved breach that should be resolved, id %d", i);
 				for (unsigned int j = breaches[i]->getHealth(); j > 0; j--) {
 					state->resolveBreach(static_cast<int>(i));
@@ -129,6 +199,8 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 			} else {
 				localBreach[i] = false;
 			}
+		} else if (authoritative && breaches[i]->getHealth() > message[index]) {
+			breaches[i]->decHealth(breaches[i]->getHealth() - message[index]);
 		}
 		index += 4;
 	}
@@ -144,7 +216,7 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 		if (message[index] != 0u) {
 			const float angle = decodeFloat(message[index + 1], message[index + 2]);
 			if (abs(doors[i]->getAngle() - angle) > FLOAT_EPSILON) {
-				if (doorCache.count(i) != 0 && doorCache[i]) {
+				if (confirmed(doorCache, i, true)) {
 					CULog("Found open door that should be closed, id %d", i);
 					state->createDoor(angle, static_cast<int>(i));
 				} else {
@@ -153,7 +225,7 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 			}
 		} else {
 			if (doors[i]->getIsActive()) {
-				if (doorCache.count(i) != 0 && !doorCache[i]) {
+				if (confirmed(doorCache, i, false)) {
 					CULog("Found closed door that should be open, id %d", i);
 					state->getDoors()[i]->reset();
 				} else {
@@ -184,7 +256,7 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 					localUnpairedBtn[message[index + 3]] = angle;
 				} else {
 					uint8_t pairID = message[index + 3];
-					if (btnCache.count(i) != 0 && btnCache[i]) {
+					if (confirmed(btnCache, i, true)) {
 						state->createButton(localUnpairedBtn[pairID], pairID, angle, i);
 					} else {
 						localBtn[i] = true;
@@ -194,7 +266,7 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 			}
 		} else {
 			if (btns[i]->getIsActive()) {
-				if (btnCache.count(i) != 0 && !btnCache[i]) {
+				if (confirmed(btnCache, i, false)) {
 					CULog("Found active button that should be fixed, id %d; resolving both", i);
 					state->resolveButton(static_cast<int>(i));
 				} else {
@@ -220,6 +292,74 @@ bool StateReconciler::reconcile(const std::shared_ptr<ShipModel>& state,
 	return true;
 }
 
+void StateReconciler::encodeSnapshot(const std::shared_ptr<ShipModel>& state,
+									 std::vector<uint8_t>& data, uint8_t level, bool parity,
+									 uint32_t seed, bool authoritative) {
+	data.push_back(ENCODE_LEVEL_NUM(level, parity));
+	encodeInt(seed, data);
+	data.push_back(authoritative ? 1 : 0);
+	encodeInt(state->getStabilizer().getDraws(), data);
+
+	const auto& donuts = state->getDonuts();
+	data.push_back(static_cast<uint8_t>(donuts.size()));
+	for (const auto& donut : donuts) {
+		data.push_back(donut->getIsActive() ? 1 : 0);
+		encodeFloat(donut->getAngle(), data);
+		data.push_back(donut->getVelocity() < 0 ? 0 : 1);
+		encodeFloat(abs(donut->getVelocity()), data);
+	}
+
+	data.push_back(StateSync);
+	encode(state, data, level, parity);
+}
+
+tl::optional<StateReconciler::SnapshotHeader> StateReconciler::decodeSnapshotHeader(
+	const cugl::ByteView& message) {
+	if (message.size() < SNAPSHOT_HEADER) {
+		return tl::nullopt;
+	}
+	const auto levelData = decodeLevelNum(message[1]);
+	return SnapshotHeader{levelData.first, levelData.second, decodeInt(message, 2),
+						  message[2 + INT_BYTES] != 0};
+}
+
+bool StateReconciler::restore(const std::shared_ptr<ShipModel>& state,
+							  const cugl::ByteView& message, uint8_t level, bool parity,
+							  uint8_t playerID) {
+	const auto header = decodeSnapshotHeader(message);
+	if (!header.has_value() || header->level != level || header->parity != parity) {
+		return false;
+	}
+
+	const auto& donuts = state->getDonuts();
+	const size_t numDonuts = message[SNAPSHOT_HEADER - 1];
+	const size_t syncStart = SNAPSHOT_HEADER + numDonuts * SNAPSHOT_DONUT;
+	if (numDonuts != donuts.size() || message.size() <= syncStart) {
+		CULog("ERROR: Malformed snapshot for %lu donuts", donuts.size());
+		return false;
+	}
+
+	state->getStabilizer().skipTo(decodeInt(message, 3 + INT_BYTES));
+	for (size_t i = 0; i < numDonuts; i++) {
+		const size_t index = SNAPSHOT_HEADER + i * SNAPSHOT_DONUT;
+		if (i == playerID) {
+			continue;
+		}
+		const auto& donut = donuts[i];
+		donut->setIsActive(message[index] != 0);
+		donut->setAngle(decodeFloat(message[index + 1], message[index + 2]));
+		donut->setVelocity((message[index + 3] == 0 ? -1.0f : 1.0f) *
+						   decodeFloat(message[index + 4], message[index + 5]));
+	}
+
+	// A snapshot is the whole truth; nothing is worth buffering until the next sync
+	const bool wasAuthoritative = authoritative;
+	authoritative = true;
+	const bool success = reconcile(state, message.from(syncStart), level, parity);
+	authoritative = wasAuthoritative;
+	return success;
+}
+
 void StateReconciler::reset() {
 	breachCache.clear();
 	doorCache.clear();
@@ -3,6 +3,9 @@
 
 #include <cugl/cugl.h>
 
+#include <tl/optional.hpp>
+
+#include "CUNetworkConnection.h"
 #include "ShipModel.h"
 
 /**
@@ -33,7 +36,43 @@ class StateReconciler {
 	/** Local cache of unpaired buttons; pre-innitialized as an optimization */
 	std::unordered_map<unsigned int, float> localUnpairedBtn;
 
+	/** Whether the sender of state syncs is the only writer of object state */
+	bool authoritative;
+
+	/**
+	 * Returns whether a discrepancy should be corrected now rather than buffered until the next
+	 * state sync. This is when the previous sync found the same discrepancy, or always if the
+	 * sender is authoritative.
+	 *
+	 * @param cache The discrepancies found by the previous sync
+	 * @param id    The ID of the object
+	 * @param value The state the server claims for the object
+	 */
+	bool confirmed(const std::unordered_map<unsigned int, bool>& cache, unsigned int id,
+				   bool value) const;
+
    public:
+	/** The level a snapshot is for, and how to play it */
+	struct SnapshotHeader {
+		/** Level number */
+		uint8_t level;
+		/** Level parity */
+		bool parity;
+		/** Level seed */
+		uint32_t seed;
+		/** Whether the host is authoritative */
+		bool authoritative;
+	};
+
+	/** Create a reconciler that buffers discrepancies for one state sync */
+	StateReconciler() : authoritative(false) {}
+
+	/**
+	 * Set whether state syncs come from an authoritative host. If so, every discrepancy is
+	 * corrected as soon as it is seen, including partially resolved breaches.
+	 */
+	void setAuthoritative(bool value) { authoritative = value; }
+
 	/** Decode a float from the two bytes in the network packet */
 	static float decodeFloat(uint8_t m1, uint8_t m2);
 
@@ -43,6 +82,28 @@ class StateReconciler {
 	/** Decode a level byte into the current level and parity */
 	static std::pair<uint8_t, bool> decodeLevelNum(uint8_t encodedLevel);
 
+	/** Encode a 32 bit integer, little endian, and append it to the end of the given vector */
+	static void encodeInt(uint32_t value, std::vector<uint8_t>& out);
+
+	/** Decode the 32 bit integer at the given index of a network packet */
+	static uint32_t decodeInt(const cugl::ByteView& message, size_t index);
+
+	/**
+	 * Compress a message by collapsing every run of zeros into a zero and the length of the run,
+	 * and append the result to the given vector.
+	 *
+	 * State syncs and snapshots are mostly zeros, since every free object slot is sent as one,
+	 * while messages without long runs of zeros may grow; only send the result if it is smaller.
+	 */
+	static void compress(const cugl::ByteView& message, std::vector<uint8_t>& out);
+
+	/**
+	 * Undo {@link compress}, appending the original message to the given vector.
+	 *
+	 * @returns Whether the compressed message was well formed
+	 */
+	static bool decompress(const cugl::ByteView& message, std::vector<uint8_t>& out);
+
 	/**
 	 * Encode the state of the game into the specified vector.
 	 *
@@ -67,10 +128,55 @@ class StateReconciler {
 	 * @return True iff successful. A return value of false indicates a catastrophic failure that
 	 * cannot be recovered from (typically, the user has the wrong level loaded).
 	 */
-	bool reconcile(const std::shared_ptr<ShipModel>& state, const std::vector<uint8_t>& message,
+	bool reconcile(const std::shared_ptr<ShipModel>& state, const cugl::ByteView& message,
 				   uint8_t level, bool parity);
 
-	/** Reset this class */
+	/**
+	 * Encode a full snapshot of the game for a player joining mid level into the specified vector.
+	 *
+	 * FORMAT
+	 *
+	 * [ level | seed (4 bytes) | authoritative | stabilizer draws (4 bytes) | number of donuts |
+	 * (active | angle (2 bytes) | velocity sign | velocity (2 bytes)) per donut | state sync ]
+	 *
+	 * The level byte is encoded as in a state sync, and the state sync is a complete message,
+	 * starting with its own flag byte.
+	 *
+	 * @param state The authoritative copy of the game state. PRECONDITION: Game must be going.
+	 * @param data The vector for the snapshot to be output into. The first element of the vector
+	 * should be prepopulated with the appropriate network flag byte.
+	 * @param level The current level number
+	 * @param parity Level parity from mib
+	 * @param seed The level seed
+	 * @param authoritative Whether the host is authoritative
+	 */
+	static void encodeSnapshot(const std::shared_ptr<ShipModel>& state, std::vector<uint8_t>& data,
+							   uint8_t level, bool parity, uint32_t seed, bool authoritative);
+
+	/**
+	 * Decode the level a snapshot is for, without needing a ship for that level.
+	 *
+	 * @param message The full incoming snapshot message
+	 * @return The header, or empty if the message is too short to be a snapshot
+	 */
+	static tl::optional<SnapshotHeader> decodeSnapshotHeader(const cugl::ByteView& message);
+
+	/**
+	 * Bring the game fully up to date with a snapshot, correcting every discrepancy at once. The
+	 * local player's donut is left where it is.
+	 *
+	 * @param state The local copy of the state, to be mutated
+	 * @param message The full incoming snapshot message
+	 * @param level The current level number
+	 * @param parity Level parity from mib
+	 * @param playerID The ID of the local player
+	 *
+	 * @return True iff successful; false if the snapshot is malformed or for another level
+	 */
+	bool restore(const std::shared_ptr<ShipModel>& state, const cugl::ByteView& message,
+				 uint8_t level, bool parity, uint8_t playerID);
+
+	/** Reset the buffered discrepancies of this class */
 	void reset();
 };
 
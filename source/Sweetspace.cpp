@@ -1,6 +1,9 @@
 #include "Sweetspace.h"
 
+#include <cstdlib>
+
 #include "AdUtils.h"
+#include "ReplayLog.h"
 
 using namespace cugl;
 
@@ -20,6 +23,9 @@ constexpr unsigned int MODE_ENUM_STEP = 100;
  * causing the application to run.
  */
 void Sweetspace::onStartup() {
+	// Prefer the packed assets if the build shipped them; loose files otherwise
+	AssetPack::mount("assets.pack");
+
 	assets = AssetManager::alloc();
 	batch = SpriteBatch::alloc();
 #if defined(__ANDROID__) || defined(__IPHONEOS__)
@@ -29,6 +35,19 @@ void Sweetspace::onStartup() {
 	// Start up input controller
 	InputController::getInstance();
 
+#ifdef SWEETSPACE_RECORD_REPLAY
+	// Record every game for the re-simulator in tooling/replay-sim.cpp
+	ReplayLog::getInstance().start(Application::get()->getSaveDirectory() + "replay.ssr");
+#endif
+
+	// Point matchmaking at other servers, such as tooling/room-server.cpp on this machine
+	if (const char* server = std::getenv("SWEETSPACE_SERVER")) {
+		MagicInternetBox::getInstance().setServer(server);
+	}
+	if (const char* relay = std::getenv("SWEETSPACE_RELAY")) {
+		MagicInternetBox::getInstance().setRelay(relay);
+	}
+
 	assets->attach<Font>(FontLoader::alloc()->getHook());
 	assets->attach<Texture>(TextureLoader::alloc()->getHook());
 	assets->attach<Sound>(SoundLoader::alloc()->getHook());
@@ -68,8 +87,10 @@ void Sweetspace::onShutdown() {
 	gameplay.dispose();
 	mainmenu.dispose();
 	InputController::cleanup();
+	ReplayLog::getInstance().stop();
 	assets = nullptr;
 	batch = nullptr;
+	AssetPack::unmountAll();
 
 	Application::onShutdown(); // YOU MUST END with call to parent
 }
@@ -0,0 +1,195 @@
+#include "ThreadedNetworkConnection.h"
+
+#include <chrono>
+#include <utility>
+
+using namespace cugl;
+
+/** Longest time between polls of the wrapped connection, when no calls are queued */
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1);
+
+/** Time between measurements of the wrapped connection's link quality */
+constexpr auto STATS_INTERVAL = std::chrono::milliseconds(250);
+
+bool ThreadedNetworkConnection::State::operator==(const State& other) const {
+	return status == other.status && playerID == other.playerID && roomID == other.roomID &&
+		   active == other.active && numPlayers == other.numPlayers &&
+		   totalPlayers == other.totalPlayers && hostID == other.hostID &&
+		   linkStats == other.linkStats;
+}
+
+ThreadedNetworkConnection::ThreadedNetworkConnection(std::unique_ptr<NetworkConnection> conn)
+	: conn(std::move(conn)),
+	  sharedChanged(false),
+	  queued(0),
+	  applied(0),
+	  woken(false),
+	  running(true) {
+	outbox.init(QUEUE_SIZE);
+	inbox.init(QUEUE_SIZE);
+	view = capture();
+	shared = view;
+	thread = std::thread([this]() { run(); });
+}
+
+ThreadedNetworkConnection::~ThreadedNetworkConnection() {
+	running = false;
+	notify();
+	thread.join();
+}
+
+void ThreadedNetworkConnection::send(const std::vector<uint8_t>& msg) {
+	enqueue(Command::Kind::Send, msg);
+}
+
+void ThreadedNetworkConnection::sendOnlyToHost(const std::vector<uint8_t>& msg) {
+	enqueue(Command::Kind::SendOnlyToHost, msg);
+}
+
+void ThreadedNetworkConnection::manualDisconnect() {
+	enqueue(Command::Kind::Disconnect, {});
+	sync();
+}
+
+void ThreadedNetworkConnection::startGame() {
+	// The game reads the final player count as soon as this returns
+	enqueue(Command::Kind::StartGame, {});
+	sync();
+}
+
+void ThreadedNetworkConnection::receive(const std::function<void(const ByteView&)>& dispatcher) {
+	// Take the state first; every message it reflects is in the inbox by now
+	if (sharedChanged.exchange(false)) {
+		const std::lock_guard<std::mutex> lock(sharedLock);
+		view = shared;
+	}
+	for (auto* msg = inbox.peek(); msg != nullptr; msg = inbox.peek()) {
+		dispatcher(*msg);
+		inbox.pop();
+	}
+}
+
+void ThreadedNetworkConnection::enqueue(Command::Kind kind, const std::vector<uint8_t>& msg) {
+	Command* command = outbox.prepare();
+	while (command == nullptr) {
+		// The network thread never waits on us, so it will make room
+		std::this_thread::yield();
+		command = outbox.prepare();
+	}
+	command->kind = kind;
+	command->msg.assign(msg.begin(), msg.end());
+	outbox.commit();
+	queued++;
+	notify();
+}
+
+void ThreadedNetworkConnection::sync() {
+	std::unique_lock<std::mutex> lock(sharedLock);
+	appliedChanged.wait(lock, [this]() { return applied == queued; });
+	view = shared;
+}
+
+void ThreadedNetworkConnection::notify() {
+	{
+		const std::lock_guard<std::mutex> lock(wakeLock);
+		woken = true;
+	}
+	wake.notify_one();
+}
+
+ThreadedNetworkConnection::State ThreadedNetworkConnection::capture() const {
+	State state;
+	state.status = conn->getStatus();
+	state.playerID = conn->getPlayerID();
+	state.roomID = conn->getRoomID();
+	for (size_t i = 0; i < ONE_BYTE; i++) {
+		state.active.set(i, conn->isPlayerActive(static_cast<uint8_t>(i)));
+	}
+	state.numPlayers = conn->getNumPlayers();
+	state.totalPlayers = conn->getTotalPlayers();
+	state.hostID = conn->getHostID();
+	return state;
+}
+
+void ThreadedNetworkConnection::run() {
+	State last = shared;
+	auto lastStats = std::chrono::steady_clock::now();
+	while (running) {
+		const uint64_t made = drainOutbox();
+
+		// Whatever the caller could not take yet goes first, to keep messages in order
+		while (!overflow.empty()) {
+			auto* slot = inbox.prepare();
+			if (slot == nullptr) {
+				break;
+			}
+			slot->swap(overflow.front());
+			inbox.commit();
+			overflow.pop_front();
+		}
+		conn->receive([this](const ByteView& msg) { deliver(msg); });
+
+		State state = capture();
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastStats >= STATS_INTERVAL) {
+			state.linkStats = conn->getLinkStats();
+			lastStats = now;
+		} else {
+			state.linkStats = last.linkStats;
+		}
+		const bool changed = !(state == last);
+		if (changed || made > 0) {
+			{
+				const std::lock_guard<std::mutex> lock(sharedLock);
+				if (changed) {
+					shared = state;
+				}
+				applied += made;
+			}
+			appliedChanged.notify_all();
+		}
+		if (changed) {
+			sharedChanged = true;
+			last = std::move(state);
+		}
+
+		std::unique_lock<std::mutex> lock(wakeLock);
+		wake.wait_for(lock, POLL_INTERVAL, [this]() { return woken; });
+		woken = false;
+	}
+	// Make sure a disconnect queued right before shutting down still happens
+	drainOutbox();
+}
+
+uint64_t ThreadedNetworkConnection::drainOutbox() {
+	uint64_t made = 0;
+	for (auto* command = outbox.peek(); command != nullptr; command = outbox.peek()) {
+		switch (command->kind) {
+			case Command::Kind::Send:
+				conn->send(command->msg);
+				break;
+			case Command::Kind::SendOnlyToHost:
+				conn->sendOnlyToHost(command->msg);
+				break;
+			case Command::Kind::StartGame:
+				conn->startGame();
+				break;
+			case Command::Kind::Disconnect:
+				conn->manualDisconnect();
+				break;
+		}
+		outbox.pop();
+		made++;
+	}
+	return made;
+}
+
+void ThreadedNetworkConnection::deliver(const ByteView& msg) {
+	auto* slot = overflow.empty() ? inbox.prepare() : nullptr;
+	if (slot == nullptr) {
+		overflow.emplace_back(msg.begin(), msg.end());
+		return;
+	}
+	slot->assign(msg.begin(), msg.end());
+	inbox.commit();
+}
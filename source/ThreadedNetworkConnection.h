@@ -0,0 +1,166 @@
+#ifndef THREADED_NETWORK_CONNECTION_H
+#define THREADED_NETWORK_CONNECTION_H
+
+#include <cugl/util/CULockFreeQueue.h>
+
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CUNetworkConnection.h"
+
+namespace cugl {
+/**
+ * Network connection that runs another connection on a thread of its own.
+ *
+ * The wrapped connection is only ever touched by the network thread. That thread sleeps until a
+ * call is queued for it, and otherwise wakes every millisecond to check for packets, as neither
+ * kind of connection can signal their arrival. Messages travel between that thread and the caller
+ * through a pair of lock-free queues: sends are queued and go out right away instead of waiting for
+ * the next game frame, and received messages wait in an inbox until the next call to receive. A
+ * slow frame no longer delays packet handling, and a burst of packets no longer lengthens a frame.
+ *
+ * The getters return the state of the wrapped connection as of the last call to receive, so they
+ * stay consistent with the messages handed out so far. Calls that change that state, like
+ * startGame, wait for the network thread to make them and refresh the getters before returning.
+ */
+class ThreadedNetworkConnection : public NetworkConnection {
+   public:
+	/**
+	 * Start running the given connection on a new network thread.
+	 *
+	 * @param conn The connection to run; must not be used by anything else from now on
+	 */
+	explicit ThreadedNetworkConnection(std::unique_ptr<NetworkConnection> conn);
+
+	/** Stops the network thread once it has passed on everything already queued */
+	~ThreadedNetworkConnection() override;
+
+	ThreadedNetworkConnection(const ThreadedNetworkConnection&) = delete;
+	ThreadedNetworkConnection& operator=(const ThreadedNetworkConnection&) = delete;
+
+	void send(const std::vector<uint8_t>& msg) override;
+
+	void sendOnlyToHost(const std::vector<uint8_t>& msg) override;
+
+	void receive(const std::function<void(const ByteView&)>& dispatcher) override;
+
+	void manualDisconnect() override;
+
+	void startGame() override;
+
+	NetStatus getStatus() const override { return view.status; }
+
+	tl::optional<uint8_t> getPlayerID() const override { return view.playerID; }
+
+	std::string getRoomID() const override { return view.roomID; }
+
+	bool isPlayerActive(uint8_t playerID) const override { return view.active.test(playerID); }
+
+	uint8_t getNumPlayers() const override { return view.numPlayers; }
+
+	uint8_t getTotalPlayers() const override { return view.totalPlayers; }
+
+	uint8_t getHostID() const override { return view.hostID; }
+
+	tl::optional<LinkStats> getLinkStats() const override { return view.linkStats; }
+
+   private:
+	static constexpr size_t ONE_BYTE = 256;
+
+	/** Number of messages each queue holds before the producer has to wait */
+	static constexpr size_t QUEUE_SIZE = 1024;
+
+	/** Everything the getters report */
+	struct State {
+		NetStatus status = NetStatus::Pending;
+		tl::optional<uint8_t> playerID;
+		std::string roomID;
+		std::bitset<ONE_BYTE> active;
+		uint8_t numPlayers = 0;
+		uint8_t totalPlayers = 0;
+		uint8_t hostID = 0;
+		/** Only refreshed every {@link STATS_INTERVAL}, as it changes with nearly every poll */
+		tl::optional<LinkStats> linkStats;
+
+		bool operator==(const State& other) const;
+	};
+
+	/** A call for the network thread to make on the wrapped connection */
+	struct Command {
+		enum class Kind : uint8_t { Send, SendOnlyToHost, StartGame, Disconnect };
+		Kind kind = Kind::Send;
+		/** The message to send, if any */
+		std::vector<uint8_t> msg;
+	};
+
+	/** The wrapped connection; only touched by the network thread once it starts */
+	std::unique_ptr<NetworkConnection> conn;
+
+	/** Calls from the caller to the network thread */
+	LockFreeQueue<Command> outbox;
+	/** Messages from the network thread to the caller */
+	LockFreeQueue<std::vector<uint8_t>> inbox;
+	/** Received messages that did not fit in the inbox; only touched by the network thread */
+	std::deque<std::vector<uint8_t>> overflow;
+
+	/** The state reported by the getters; only touched by the caller */
+	State view;
+	/** The latest state of the wrapped connection, guarded by {@link sharedLock} */
+	State shared;
+	/** Guards {@link shared} */
+	std::mutex sharedLock;
+	/** Whether {@link shared} changed since the caller last copied it */
+	std::atomic<bool> sharedChanged;
+	/** Number of calls queued so far; only touched by the caller */
+	uint64_t queued;
+	/** Number of calls made so far, with their effect in {@link shared}; guarded by sharedLock */
+	uint64_t applied;
+	/** Signalled whenever {@link applied} goes up */
+	std::condition_variable appliedChanged;
+
+	/** Guards {@link woken} */
+	std::mutex wakeLock;
+	/** Whether the network thread has been woken since it last went to sleep */
+	bool woken;
+	/** Wakes the network thread early, when a call is queued or it should stop */
+	std::condition_variable wake;
+
+	/** Whether the network thread should keep going */
+	std::atomic<bool> running;
+	/** The network thread */
+	std::thread thread;
+
+	/** Queue a call for the network thread, waiting for room if the outbox is full */
+	void enqueue(Command::Kind kind, const std::vector<uint8_t>& msg);
+
+	/** Wait until the network thread made every queued call, then refresh the getters */
+	void sync();
+
+	/** Wake the network thread if it is asleep */
+	void notify();
+
+	/** Returns the current state of the wrapped connection, without its link quality */
+	State capture() const;
+
+	/** The body of the network thread */
+	void run();
+
+	/**
+	 * Make every call in the outbox; network thread only
+	 *
+	 * @return The number of calls made
+	 */
+	uint64_t drainOutbox();
+
+	/** Move a received message into the inbox (or overflow); network thread only */
+	void deliver(const ByteView& msg);
+};
+}; // namespace cugl
+
+#endif /* THREADED_NETWORK_CONNECTION_H */
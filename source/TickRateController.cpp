@@ -0,0 +1,63 @@
+#include "TickRateController.h"
+
+#include <algorithm>
+
+#include "Globals.h"
+
+/** Fewest frames between position updates */
+constexpr unsigned int MIN_TICK = 6;
+
+/** Most frames between position updates */
+constexpr unsigned int MAX_TICK = 30;
+
+/** Round trip time above which a link is struggling (ms) */
+constexpr uint32_t BAD_RTT = 250;
+
+/** Fraction of packets lost above which a link is struggling */
+constexpr float BAD_LOSS = 0.05f;
+
+/** Bytes queued above which a link is struggling */
+constexpr uint64_t BAD_QUEUE = 4096;
+
+/** Round trip time below which a link has room to spare (ms) */
+constexpr uint32_t GOOD_RTT = 100;
+
+/** Fraction of packets lost below which a link has room to spare */
+constexpr float GOOD_LOSS = 0.01f;
+
+/** Bytes queued below which a link has room to spare */
+constexpr uint64_t GOOD_QUEUE = 1024;
+
+/** Frames to wait after a change before backing off again, so a backlog has time to drain */
+constexpr unsigned int BACKOFF_FRAMES = 30;
+
+/** Frames a link must stay clean before speeding up again */
+constexpr unsigned int PROBE_FRAMES = 120;
+
+void TickRateController::reset() {
+	tick = globals::NETWORK_TICK;
+	framesSinceChange = 0;
+}
+
+void TickRateController::update(const tl::optional<cugl::NetworkConnection::LinkStats>& stats) {
+	framesSinceChange++;
+	if (!stats.has_value()) {
+		return;
+	}
+
+	if (stats->rtt > BAD_RTT || stats->loss > BAD_LOSS || stats->queuedBytes > BAD_QUEUE) {
+		if (framesSinceChange >= BACKOFF_FRAMES && tick < MAX_TICK) {
+			tick = std::min(MAX_TICK, tick + std::max(1U, tick / 2));
+			framesSinceChange = 0;
+		}
+	} else if (stats->rtt < GOOD_RTT && stats->loss < GOOD_LOSS &&
+			   stats->queuedBytes < GOOD_QUEUE) {
+		if (framesSinceChange >= PROBE_FRAMES && tick > MIN_TICK) {
+			tick--;
+			framesSinceChange = 0;
+		}
+	} else {
+		// Neither struggling nor spare; a clean stretch has to start over
+		framesSinceChange = std::min(framesSinceChange, BACKOFF_FRAMES);
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef TICK_RATE_CONTROLLER_H
+#define TICK_RATE_CONTROLLER_H
+
+#include "CUNetworkConnection.h"
+
+/**
+ * Picks how often to send position updates from the measured quality of this player's links.
+ *
+ * Starts at globals::NETWORK_TICK. Each time a link backs up, loses packets or slows down, the
+ * tick grows by half so the sends stop piling up behind it; each stretch of a clean link shrinks
+ * it by a frame, for smoother motion. The tick never leaves the bounds in TickRateController.cpp.
+ * Connections that cannot measure their links keep the tick where it is.
+ *
+ * State syncs are sent every few position updates, so their cadence follows the tick. The tick
+ * goes out with every position update, and other players ease this player's donut over it.
+ */
+class TickRateController {
+   private:
+	/** Frames between position updates */
+	unsigned int tick;
+	/** Frames since the tick last changed */
+	unsigned int framesSinceChange;
+
+   public:
+	TickRateController() { reset(); }
+
+	/** Go back to the default tick, e.g. for a new game */
+	void reset();
+
+	/**
+	 * Adjust the tick for a new frame.
+	 *
+	 * @param stats The latest link measurements, or empty if there are none
+	 */
+	void update(const tl::optional<cugl::NetworkConnection::LinkStats>& stats);
+
+	/** Returns the number of frames between position updates */
+	unsigned int getTick() const { return tick; }
+};
+
+#endif /* TICK_RATE_CONTROLLER_H */
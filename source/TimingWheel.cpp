@@ -0,0 +1,66 @@
+#include "TimingWheel.h"
+
+void TimingWheel::clear(float time) {
+	for (auto& slot : near) {
+		slot.clear();
+	}
+	for (auto& slot : far) {
+		slot.clear();
+	}
+	overflow.clear();
+	expired.clear();
+	current = tickOf(time);
+	count = 0;
+}
+
+void TimingWheel::place(const Timer& timer) {
+	const uint64_t tick = tickOf(timer.due);
+	if (tick <= current) {
+		expired.push_back(timer);
+	} else if (tick - current < SLOTS) {
+		near.at(tick % SLOTS).push_back(timer);
+	} else if (tick / SLOTS - current / SLOTS < SLOTS) {
+		far.at((tick / SLOTS) % SLOTS).push_back(timer);
+	} else {
+		overflow.push_back(timer);
+	}
+}
+
+void TimingWheel::schedule(const Timer& timer) {
+	place(timer);
+	count++;
+}
+
+void TimingWheel::advance(float time, std::vector<Timer>& fired) {
+	const size_t start = fired.size();
+	fired.insert(fired.end(), expired.begin(), expired.end());
+	expired.clear();
+
+	const uint64_t target = tickOf(time);
+	while (current < target && count > fired.size() - start) {
+		current++;
+		if (current % SLOTS == 0) {
+			// Cascade the next block of the second level into the first
+			std::vector<Timer> block;
+			block.swap(far.at((current / SLOTS) % SLOTS));
+			if (!overflow.empty()) {
+				block.insert(block.end(), overflow.begin(), overflow.end());
+				overflow.clear();
+			}
+			for (const auto& timer : block) {
+				place(timer);
+			}
+		}
+
+		auto& slot = near.at(current % SLOTS);
+		fired.insert(fired.end(), slot.begin(), slot.end());
+		slot.clear();
+		fired.insert(fired.end(), expired.begin(), expired.end());
+		expired.clear();
+	}
+	if (current < target) {
+		// Nothing is left to fire, so skip straight ahead
+		current = target;
+	}
+	count -= fired.size() - start;
+}
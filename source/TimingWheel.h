@@ -0,0 +1,108 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A hierarchical timing wheel for scheduling game events.
+ *
+ * Time is divided into ticks of {@link TICK} seconds. The first level holds one slot per tick for
+ * the next {@link SLOTS} ticks; the second holds one slot per {@link SLOTS} ticks beyond that.
+ * Timers further out than the second level wait in a small overflow list. As the wheel advances,
+ * second level slots are cascaded down into the first, so scheduling and firing are both O(1) per
+ * timer no matter how many are pending.
+ *
+ * The wheel is keyed on an arbitrary, monotonically increasing clock. It never reads the time
+ * itself.
+ */
+class TimingWheel {
+   public:
+	/** A scheduled timer */
+	struct Timer {
+		/** The id of whatever is being scheduled (e.g. an event index) */
+		int id;
+		/** The number of times this timer has been retried */
+		int attempts;
+		/** The time at which this timer is due */
+		float due;
+	};
+
+	/** The length of a tick in seconds */
+	static constexpr float TICK = 0.25f;
+
+	/** The number of slots in each level of the wheel */
+	static constexpr unsigned int SLOTS = 64;
+
+   private:
+	/** The first level of the wheel, one slot per tick */
+	std::array<std::vector<Timer>, SLOTS> near;
+	/** The second level of the wheel, one slot per SLOTS ticks */
+	std::array<std::vector<Timer>, SLOTS> far;
+	/** Timers beyond the second level */
+	std::vector<Timer> overflow;
+	/** Timers that were already due when scheduled */
+	std::vector<Timer> expired;
+
+	/** The current tick */
+	uint64_t current;
+	/** The number of pending timers */
+	size_t count;
+
+	/**
+	 * Returns the tick containing the given time.
+	 *
+	 * @param time The clock time
+	 */
+	static uint64_t tickOf(float time) {
+		return time <= 0 ? 0 : static_cast<uint64_t>(time / TICK);
+	}
+
+	/**
+	 * Places a timer in the wheel without updating the count.
+	 *
+	 * @param timer The timer to place
+	 */
+	void place(const Timer& timer);
+
+   public:
+	/**
+	 * Creates a new, empty timing wheel starting at time 0.
+	 */
+	TimingWheel() : current(0), count(0) {}
+
+	/**
+	 * Removes all timers and restarts the wheel at the given time.
+	 *
+	 * @param time The clock time to start at
+	 */
+	void clear(float time = 0);
+
+	/**
+	 * Schedules a timer.
+	 *
+	 * A timer that is already due will fire on the next call to {@link advance}.
+	 *
+	 * @param timer The timer to schedule
+	 */
+	void schedule(const Timer& timer);
+
+	/**
+	 * Advances the wheel to the given time, appending every timer now due to fired.
+	 *
+	 * Timers fire in tick order. Times earlier than the current tick are ignored.
+	 *
+	 * @param time  The clock time to advance to
+	 * @param fired The list to append fired timers to
+	 */
+	void advance(float time, std::vector<Timer>& fired);
+
+	/**
+	 * Returns the number of timers still pending in the wheel.
+	 */
+	size_t size() const { return count; }
+};
+
+#endif /* TIMING_WHEEL_H */
@@ -0,0 +1,70 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tl/optional.hpp>
+
+/**
+ * Lengths encoded as varints: 7 bits per byte, least significant first, with the top bit set on
+ * every byte but the last. Values under 128 take a single byte.
+ *
+ * Used for the message lengths of the network protocol and the record lengths of replay logs.
+ */
+namespace varint {
+
+/** Bits of payload in each byte */
+constexpr unsigned int BITS = 7;
+
+/** The continuation bit of a byte */
+constexpr uint8_t MORE = 1 << BITS;
+
+/** Most bits of payload a varint may carry */
+constexpr unsigned int MAX_BITS = 32;
+
+/** Most bytes a varint may take */
+constexpr size_t MAX_SIZE = (MAX_BITS + BITS - 1) / BITS;
+
+/**
+ * Encode a value.
+ *
+ * @param value The value to encode
+ * @param out   Where to write the varint; must have room for MAX_SIZE bytes
+ *
+ * @return The number of bytes written
+ */
+inline size_t encode(uint32_t value, uint8_t* out) {
+	size_t size = 0;
+	while (value >= MORE) {
+		out[size++] = static_cast<uint8_t>((value & (MORE - 1)) | MORE);
+		value >>= BITS;
+	}
+	out[size++] = static_cast<uint8_t>(value);
+	return size;
+}
+
+/**
+ * Decode a value.
+ *
+ * @param data  The bytes to read from
+ * @param size  The number of bytes in data
+ * @param index Where the varint starts; moved past the varint on success
+ *
+ * @return The value, or empty if the varint runs off the end of data or past MAX_BITS
+ */
+inline tl::optional<uint32_t> decode(const uint8_t* data, size_t size, size_t& index) {
+	uint32_t value = 0;
+	size_t i = index;
+	for (unsigned int shift = 0; shift < MAX_BITS && i < size; shift += BITS) {
+		value |= static_cast<uint32_t>(data[i] & (MORE - 1)) << shift;
+		if ((data[i++] & MORE) == 0) {
+			index = i;
+			return value;
+		}
+	}
+	return tl::nullopt;
+}
+
+} // namespace varint
+
+#endif /* VARINT_H */
@@ -30,7 +30,7 @@ typedef SOCKET socket_t;  // NOLINT
 #endif
 
 WebsocketNetworkConnection::WebsocketNetworkConnection(ConnectionConfig config)
-	: apiVer(config.apiVersion), maxPlayers(config.maxNumPlayers), ws(nullptr) {
+	: status(NetStatus::Disconnected), apiVer(config.apiVersion), maxPlayers(config.maxNumPlayers) {
 	if (!initConnection(config)) {
 		status = NetStatus::GenericError;
 		return;
@@ -47,7 +47,10 @@ WebsocketNetworkConnection::WebsocketNetworkConnection(ConnectionConfig config)
 
 WebsocketNetworkConnection::WebsocketNetworkConnection(ConnectionConfig config,
 													   const std::string& roomID)
-	: apiVer(config.apiVersion), maxPlayers(config.maxNumPlayers), roomID(roomID), ws(nullptr) {
+	: status(NetStatus::Disconnected),
+	  apiVer(config.apiVersion),
+	  maxPlayers(config.maxNumPlayers),
+	  roomID(roomID) {
 	if (!initConnection(config)) {
 		status = NetStatus::GenericError;
 		return;
@@ -64,7 +67,7 @@ WebsocketNetworkConnection::WebsocketNetworkConnection(ConnectionConfig config,
 	status = NetStatus::Pending;
 }
 
-WebsocketNetworkConnection::~WebsocketNetworkConnection() = default;
+WebsocketNetworkConnection::~WebsocketNetworkConnection() { manualDisconnect(); }
 
 bool cugl::WebsocketNetworkConnection::initConnection(ConnectionConfig config) {
 	switch (status) {
@@ -101,7 +104,7 @@ bool cugl::WebsocketNetworkConnection::initConnection(ConnectionConfig config) {
 	serverUrl << ':';
 	serverUrl << config.fallbackServerPort;
 
-	ws = WebSocket::from_url(serverUrl.str());
+	ws = std::unique_ptr<WebSocket>(WebSocket::from_url(serverUrl.str()));
 	if (!ws) { // NOLINT
 		status = NetStatus::GenericError;
 		return false;
@@ -127,6 +130,8 @@ void WebsocketNetworkConnection::sendOnlyToHost(const std::vector<uint8_t>& msg)
 void WebsocketNetworkConnection::manualDisconnect() {
 	if (ws != nullptr) {
 		ws->close();
+		// Push the close frame out before the socket goes away
+		ws->poll();
 		ws = nullptr;
 	}
 	status = NetStatus::Reconnecting;
@@ -143,8 +148,7 @@ void WebsocketNetworkConnection::startGame() {
 
 NetworkConnection::NetStatus WebsocketNetworkConnection::getStatus() const { return status; }
 
-void WebsocketNetworkConnection::receive(
-	const std::function<void(const std::vector<uint8_t>&)>& dispatcher) {
+void WebsocketNetworkConnection::receive(const std::function<void(const ByteView&)>& dispatcher) {
 	switch (status) {
 		case NetStatus::Pending:
 		case NetStatus::Connected:
@@ -156,23 +160,26 @@ void WebsocketNetworkConnection::receive(
 		case NetStatus::GenericError:
 			return;
 	}
+	if (ws == nullptr) {
+		return;
+	}
 
+	// Sends go out as they are made, so this only has to drain the socket
 	ws->poll();
-	ws->dispatchBinary([this, &dispatcher](const std::vector<uint8_t>& message) {
+	ws->dispatchRaw([this, &dispatcher](const uint8_t* data, size_t size) {
+		const ByteView message(data, size);
 		if (message.empty()) {
 			return;
 		}
 
 		const auto type = static_cast<CustomDataPackets>(message[0]);
-		// Uses some slow array copies, but who cares; this is just the fallback code we hopefully
-		// never need
 		switch (type) {
 			case GeneralMsg:
-				dispatcher(vector<uint8_t>(message.begin() + 1, message.end()));
+				dispatcher(message.from(1));
 				break;
 			case HostMsg:
 				if (*playerID == 0) {
-					dispatcher(vector<uint8_t>(message.begin() + 1, message.end()));
+					dispatcher(message.from(1));
 				}
 				break;
 			case StartGame:
@@ -1,6 +1,8 @@
 #ifndef WEBSOCKET_NETWORK_CONNECTION_H
 #define WEBSOCKET_NETWORK_CONNECTION_H
 
+#include <memory>
+
 #include "CUNetworkConnection.h"
 #include "libraries/easywsclient.hpp"
 
@@ -23,7 +25,7 @@ class WebsocketNetworkConnection : public NetworkConnection {
 
 	void sendOnlyToHost(const std::vector<uint8_t>& msg) override;
 
-	void receive(const std::function<void(const std::vector<uint8_t>&)>& dispatcher) override;
+	void receive(const std::function<void(const ByteView&)>& dispatcher) override;
 
 	void manualDisconnect() override;
 #pragma endregion
@@ -44,6 +46,8 @@ class WebsocketNetworkConnection : public NetworkConnection {
 	uint8_t getNumPlayers() const override { return numPlayers; }
 
 	uint8_t getTotalPlayers() const override { return maxPlayers; }
+
+	uint8_t getHostID() const override { return 0; }
 #pragma endregion
 
    private:
@@ -65,7 +69,7 @@ class WebsocketNetworkConnection : public NetworkConnection {
 	std::bitset<ONE_BYTE> connectedPlayers;
 
 	/** The actual websocket connection */
-	easywsclient::WebSocket::pointer ws;
+	std::unique_ptr<easywsclient::WebSocket> ws;
 
 	/**
 	 * Initialize the network connection.
@@ -62,6 +62,7 @@ typedef unsigned __int64 uint64_t;
 #define socketerrno WSAGetLastError()
 #define SOCKET_EAGAIN_EINPROGRESS WSAEINPROGRESS
 #define SOCKET_EWOULDBLOCK WSAEWOULDBLOCK
+#define SOCKET_SEND_FLAGS 0
 #else
 #include <fcntl.h>
 #include <netdb.h>
@@ -92,6 +93,12 @@ typedef int socket_t;
 #define socketerrno errno
 #define SOCKET_EAGAIN_EINPROGRESS EAGAIN
 #define SOCKET_EWOULDBLOCK EWOULDBLOCK
+#ifdef MSG_NOSIGNAL
+// A dropped connection is an error to report, not a SIGPIPE to die of
+#define SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SOCKET_SEND_FLAGS 0
+#endif
 #endif
 
 #include <string>
@@ -101,6 +108,7 @@ typedef int socket_t;
 
 using easywsclient::BytesCallback_Imp;
 using easywsclient::Callback_Imp;
+using easywsclient::RawCallback_Imp;
 
 namespace { // private module-only namespace
 
@@ -145,6 +153,7 @@ class _DummyWebSocket : public easywsclient::WebSocket {
 	readyStateValues getReadyState() const { return CLOSED; }
 	void _dispatch(Callback_Imp& callable) {}
 	void _dispatchBinary(BytesCallback_Imp& callable) {}
+	void _dispatchRaw(RawCallback_Imp& callable) {}
 };
 
 class _RealWebSocket : public easywsclient::WebSocket {
@@ -186,8 +195,16 @@ class _RealWebSocket : public easywsclient::WebSocket {
 		uint8_t masking_key[4];
 	};
 
+	// Bytes are received into rxbuf[rxhead, rxtail). Frames are parsed and handed out in place,
+	// and consumed by moving rxhead past them, so nothing is copied or shifted per frame. The
+	// buffer only moves bytes when a partial frame is left at its end and recv needs more room,
+	// and rewinds for free whenever it drains.
 	std::vector<uint8_t> rxbuf;
+	size_t rxhead;
+	size_t rxtail;
+	// Bytes waiting to go out are txbuf[txhead, end); sent bytes are skipped the same way.
 	std::vector<uint8_t> txbuf;
+	size_t txhead;
 	std::vector<uint8_t> receivedData;
 
 	socket_t sockfd;
@@ -195,11 +212,70 @@ class _RealWebSocket : public easywsclient::WebSocket {
 	bool useMask;
 	bool isRxBad;
 
+	// Most bytes asked of recv at once; also the free space kept at the end of rxbuf
+	static const size_t RX_CHUNK = 16384;
+
 	_RealWebSocket(socket_t sockfd, bool useMask)
-		: sockfd(sockfd), readyState(OPEN), useMask(useMask), isRxBad(false) {}
+		: rxbuf(RX_CHUNK),
+		  rxhead(0),
+		  rxtail(0),
+		  txhead(0),
+		  sockfd(sockfd),
+		  readyState(OPEN),
+		  useMask(useMask),
+		  isRxBad(false) {}
+
+	~_RealWebSocket() {
+		if (readyState != CLOSED) {
+			closesocket(sockfd);
+		}
+	}
 
 	readyStateValues getReadyState() const { return readyState; }
 
+	void fail(ssize_t ret) {
+		closesocket(sockfd);
+		readyState = CLOSED;
+		fputs(ret < 0 ? "Connection error!\n" : "Connection closed!\n", stderr);
+	}
+
+	// Make room for at least `room` more bytes after rxtail
+	void reserveRx(size_t room) {
+		if (rxbuf.size() - rxtail >= room) {
+			return;
+		}
+		if (rxhead > 0) {
+			// Only the unfinished frame at the end is left to keep
+			memmove(&rxbuf[0], &rxbuf[rxhead], rxtail - rxhead);
+			rxtail -= rxhead;
+			rxhead = 0;
+		}
+		if (rxbuf.size() - rxtail < room) {
+			rxbuf.resize(rxtail + room);
+		}
+	}
+
+	// Send as much of txbuf as the socket takes without blocking
+	void flushTx() {
+		while (txhead < txbuf.size()) {
+			ssize_t ret = ::send(sockfd, (char*)&txbuf[txhead], txbuf.size() - txhead,
+								 SOCKET_SEND_FLAGS);
+			if (ret < 0 &&
+				(socketerrno == SOCKET_EWOULDBLOCK || socketerrno == SOCKET_EAGAIN_EINPROGRESS)) {
+				break;
+			} else if (ret <= 0) {
+				fail(ret);
+				return;
+			} else {
+				txhead += ret;
+			}
+		}
+		if (txhead == txbuf.size()) {
+			txbuf.clear();
+			txhead = 0;
+		}
+	}
+
 	void poll(int timeout) { // timeout in milliseconds
 		if (readyState == CLOSED) {
 			if (timeout > 0) {
@@ -215,49 +291,26 @@ class _RealWebSocket : public easywsclient::WebSocket {
 			FD_ZERO(&rfds);
 			FD_ZERO(&wfds);
 			FD_SET(sockfd, &rfds);
-			if (txbuf.size()) {
+			if (txhead < txbuf.size()) {
 				FD_SET(sockfd, &wfds);
 			}
 			select(sockfd + 1, &rfds, &wfds, 0, timeout > 0 ? &tv : 0);
 		}
 		while (true) {
-			// FD_ISSET(0, &rfds) will be true
-			int N = rxbuf.size();
-			ssize_t ret;
-			rxbuf.resize(N + 1500);
-			ret = recv(sockfd, (char*)&rxbuf[0] + N, 1500, 0);
-			if (false) {
-			} else if (ret < 0 && (socketerrno == SOCKET_EWOULDBLOCK ||
-								   socketerrno == SOCKET_EAGAIN_EINPROGRESS)) {
-				rxbuf.resize(N);
-				break;
-			} else if (ret <= 0) {
-				rxbuf.resize(N);
-				closesocket(sockfd);
-				readyState = CLOSED;
-				fputs(ret < 0 ? "Connection error!\n" : "Connection closed!\n", stderr);
-				break;
-			} else {
-				rxbuf.resize(N + ret);
-			}
-		}
-		while (txbuf.size()) {
-			int ret = ::send(sockfd, (char*)&txbuf[0], txbuf.size(), 0);
-			if (false) {
-			} // ??
-			else if (ret < 0 && (socketerrno == SOCKET_EWOULDBLOCK ||
-								 socketerrno == SOCKET_EAGAIN_EINPROGRESS)) {
+			reserveRx(RX_CHUNK);
+			ssize_t ret = recv(sockfd, (char*)&rxbuf[rxtail], RX_CHUNK, 0);
+			if (ret < 0 &&
+				(socketerrno == SOCKET_EWOULDBLOCK || socketerrno == SOCKET_EAGAIN_EINPROGRESS)) {
 				break;
 			} else if (ret <= 0) {
-				closesocket(sockfd);
-				readyState = CLOSED;
-				fputs(ret < 0 ? "Connection error!\n" : "Connection closed!\n", stderr);
-				break;
+				fail(ret);
+				return;
 			} else {
-				txbuf.erase(txbuf.begin(), txbuf.begin() + ret);
+				rxtail += ret;
 			}
 		}
-		if (!txbuf.size() && readyState == CLOSING) {
+		flushTx();
+		if (txhead == txbuf.size() && readyState == CLOSING) {
 			closesocket(sockfd);
 			readyState = CLOSED;
 		}
@@ -284,24 +337,40 @@ class _RealWebSocket : public easywsclient::WebSocket {
 	}
 
 	virtual void _dispatchBinary(BytesCallback_Imp& callable) {
+		struct CallbackAdapter : public RawCallback_Imp
+		// Adapt void(const uint8_t*, size_t) to void(const std::vector<uint8_t>&)
+		{
+			BytesCallback_Imp& callable;
+			CallbackAdapter(BytesCallback_Imp& callable) : callable(callable) {}
+			void operator()(const uint8_t* data, size_t size) {
+				const std::vector<uint8_t> message(data, data + size);
+				callable(message);
+			}
+		};
+		CallbackAdapter rawCallback(callable);
+		_dispatchRaw(rawCallback);
+	}
+
+	virtual void _dispatchRaw(RawCallback_Imp& callable) {
 		// TODO: consider acquiring a lock on rxbuf...
 		if (isRxBad) {
 			return;
 		}
 		while (true) {
 			wsheader_type ws;
-			if (rxbuf.size() < 2) {
-				return; /* Need at least 2 */
+			const size_t available = rxtail - rxhead;
+			if (available < 2) {
+				break; /* Need at least 2 */
 			}
-			const uint8_t* data = (uint8_t*)&rxbuf[0]; // peek, but don't consume
+			uint8_t* data = &rxbuf[rxhead]; // peek, but don't consume
 			ws.fin = (data[0] & 0x80) == 0x80;
 			ws.opcode = (wsheader_type::opcode_type)(data[0] & 0x0f);
 			ws.mask = (data[1] & 0x80) == 0x80;
 			ws.N0 = (data[1] & 0x7f);
 			ws.header_size =
 				2 + (ws.N0 == 126 ? 2 : 0) + (ws.N0 == 127 ? 8 : 0) + (ws.mask ? 4 : 0);
-			if (rxbuf.size() < ws.header_size) {
-				return; /* Need: ws.header_size - rxbuf.size() */
+			if (available < ws.header_size) {
+				break; /* Need: ws.header_size - available */
 			}
 			int i = 0;
 			if (ws.N0 < 126) {
@@ -352,9 +421,12 @@ class _RealWebSocket : public easywsclient::WebSocket {
 
 			// Note: The checks above should hopefully ensure this addition
 			//       cannot overflow:
-			if (rxbuf.size() < ws.header_size + ws.N) {
-				return; /* Need: ws.header_size+ws.N - rxbuf.size() */
+			if (available < ws.header_size + ws.N) {
+				// Make sure the rest of the frame fits without another move
+				reserveRx(ws.header_size + (size_t)ws.N - available);
+				break; /* Need: ws.header_size+ws.N - available */
 			}
+			uint8_t* payload = data + ws.header_size;
 
 			// We got a whole message, now do something with it:
 			if (false) {
@@ -363,25 +435,28 @@ class _RealWebSocket : public easywsclient::WebSocket {
 					   ws.opcode == wsheader_type::CONTINUATION) {
 				if (ws.mask) {
 					for (size_t i = 0; i != ws.N; ++i) {
-						rxbuf[i + ws.header_size] ^= ws.masking_key[i & 0x3];
+						payload[i] ^= ws.masking_key[i & 0x3];
 					}
 				}
-				receivedData.insert(receivedData.end(), rxbuf.begin() + ws.header_size,
-									rxbuf.begin() + ws.header_size + (size_t)ws.N); // just feed
-				if (ws.fin) {
-					callable((const std::vector<uint8_t>)receivedData);
-					receivedData.erase(receivedData.begin(), receivedData.end());
-					std::vector<uint8_t>().swap(receivedData); // free memory
+				if (ws.fin && receivedData.empty()) {
+					// Unfragmented message; hand it out in place
+					callable(payload, (size_t)ws.N);
+				} else {
+					receivedData.insert(receivedData.end(), payload,
+										payload + (size_t)ws.N); // feed
+					if (ws.fin) {
+						callable(receivedData.data(), receivedData.size());
+						receivedData.erase(receivedData.begin(), receivedData.end());
+						std::vector<uint8_t>().swap(receivedData); // free memory
+					}
 				}
 			} else if (ws.opcode == wsheader_type::PING) {
 				if (ws.mask) {
 					for (size_t i = 0; i != ws.N; ++i) {
-						rxbuf[i + ws.header_size] ^= ws.masking_key[i & 0x3];
+						payload[i] ^= ws.masking_key[i & 0x3];
 					}
 				}
-				std::string data(rxbuf.begin() + ws.header_size,
-								 rxbuf.begin() + ws.header_size + (size_t)ws.N);
-				sendData(wsheader_type::PONG, data.size(), data.begin(), data.end());
+				sendData(wsheader_type::PONG, ws.N, payload, payload + (size_t)ws.N);
 			} else if (ws.opcode == wsheader_type::PONG) {
 			} else if (ws.opcode == wsheader_type::CLOSE) {
 				close();
@@ -390,7 +465,11 @@ class _RealWebSocket : public easywsclient::WebSocket {
 				close();
 			}
 
-			rxbuf.erase(rxbuf.begin(), rxbuf.begin() + ws.header_size + (size_t)ws.N);
+			rxhead += ws.header_size + (size_t)ws.N;
+		}
+		if (rxhead == rxtail) {
+			rxhead = 0;
+			rxtail = 0;
 		}
 	}
 
@@ -423,10 +502,9 @@ class _RealWebSocket : public easywsclient::WebSocket {
 		if (readyState == CLOSING || readyState == CLOSED) {
 			return;
 		}
-		std::vector<uint8_t> header;
-		header.assign(
-			2 + (message_size >= 126 ? 2 : 0) + (message_size >= 65536 ? 6 : 0) + (useMask ? 4 : 0),
-			0);
+		uint8_t header[14] = {0};
+		const size_t header_size =
+			2 + (message_size >= 126 ? 2 : 0) + (message_size >= 65536 ? 6 : 0) + (useMask ? 4 : 0);
 		header[0] = 0x80 | type;
 		if (false) {
 		} else if (message_size < 126) {
@@ -464,8 +542,13 @@ class _RealWebSocket : public easywsclient::WebSocket {
 				header[13] = masking_key[3];
 			}
 		}
+		if (txhead > 0 && txhead >= txbuf.size() / 2) {
+			// The socket is backed up; drop what was sent so txbuf does not grow forever
+			txbuf.erase(txbuf.begin(), txbuf.begin() + txhead);
+			txhead = 0;
+		}
 		// N.B. - txbuf will keep growing until it can be transmitted over the socket:
-		txbuf.insert(txbuf.end(), header.begin(), header.end());
+		txbuf.insert(txbuf.end(), header, header + header_size);
 		txbuf.insert(txbuf.end(), message_begin, message_end);
 		if (useMask) {
 			size_t message_offset = txbuf.size() - message_size;
@@ -473,6 +556,8 @@ class _RealWebSocket : public easywsclient::WebSocket {
 				txbuf[message_offset + i] ^= masking_key[i & 0x3];
 			}
 		}
+		// Send right away instead of waiting for the next poll; a frame of latency is a lot here
+		flushTx();
 	}
 
 	void close() {
@@ -482,8 +567,7 @@ class _RealWebSocket : public easywsclient::WebSocket {
 		readyState = CLOSING;
 		uint8_t closeFrame[6] = {0x88, 0x80, 0x00,
 								 0x00, 0x00, 0x00}; // last 4 bytes are a masking key
-		std::vector<uint8_t> header(closeFrame, closeFrame + 6);
-		txbuf.insert(txbuf.end(), header.begin(), header.end());
+		txbuf.insert(txbuf.end(), closeFrame, closeFrame + 6);
 	}
 };
 
@@ -576,6 +660,9 @@ easywsclient::WebSocket::pointer from_url(const std::string& url, bool useMask,
 	int flag = 1;
 	setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&flag,
 			   sizeof(flag)); // Disable Nagle's algorithm
+#ifdef SO_NOSIGPIPE
+	setsockopt(sockfd, SOL_SOCKET, SO_NOSIGPIPE, (char*)&flag, sizeof(flag)); // No MSG_NOSIGNAL
+#endif
 #ifdef _WIN32
 	u_long on = 1;
 	ioctlsocket(sockfd, FIONBIO, &on);
@@ -43,6 +43,9 @@ struct Callback_Imp {
 struct BytesCallback_Imp {
 	virtual void operator()(const std::vector<uint8_t>& message) = 0;
 };
+struct RawCallback_Imp {
+	virtual void operator()(const uint8_t* data, size_t size) = 0;
+};
 
 class WebSocket {
    public:
@@ -91,9 +94,25 @@ class WebSocket {
 		_dispatchBinary(callback);
 	}
 
+	template <class Callable>
+	void dispatchRaw(Callable callable)
+	// For callbacks that accept a (const uint8_t*, size_t) pair. The bytes point into the receive
+	// buffer and are only valid until the callback returns, so no copy is made for messages that
+	// arrive in a single frame.
+	{
+		struct _Callback : public RawCallback_Imp {
+			Callable& callable;
+			_Callback(Callable& callable) : callable(callable) {}
+			void operator()(const uint8_t* data, size_t size) { callable(data, size); }
+		};
+		_Callback callback(callable);
+		_dispatchRaw(callback);
+	}
+
    protected:
 	virtual void _dispatch(Callback_Imp& callable) = 0;
 	virtual void _dispatchBinary(BytesCallback_Imp& callable) = 0;
+	virtual void _dispatchRaw(RawCallback_Imp& callable) = 0;
 };
 
 } // namespace easywsclient
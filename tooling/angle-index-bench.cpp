@@ -0,0 +1,91 @@
+// Benchmarks placing objects by rejection sampling against sampling the free space of an
+// AngleIndex, on the most crowded ship the game can produce: level 8 with 6 players.
+//
+// Build from the repository root with
+//   g++ -O2 -std=c++14 -Isource tooling/angle-index-bench.cpp source/AngleIndex.cpp
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "AngleIndex.h"
+
+/** Players in the game */
+constexpr int PLAYERS = 6;
+/** Ship size of level 8 at 6 players (base plus per player size) */
+constexpr float SHIP_SIZE = 600 + 45 * PLAYERS;
+/** Object counts of level 8, scaled from 2 to 6 players */
+constexpr int BREACHES = 20 * PLAYERS / 2;
+constexpr int DOORS = 10 * PLAYERS / 2;
+constexpr int BUTTONS = 6 * PLAYERS / 2;
+/** Clearance from every object, as for a button pair */
+constexpr float CLEARANCE = 30;
+/** Rejection sampling attempts before giving up, as GLaDOS used to allow */
+constexpr int MAX_ATTEMPTS = 120;
+/** Placements per run */
+constexpr int ROUNDS = 100000;
+
+float difference(float a, float b) {
+	return SHIP_SIZE / 2 - std::abs(std::abs(a - b) - SHIP_SIZE / 2);
+}
+
+int main() {
+	std::minstd_rand rand(0);
+	std::uniform_real_distribution<float> angles(0, SHIP_SIZE);
+	std::uniform_real_distribution<float> fraction(0, 1);
+
+	for (int active = 4; active <= BREACHES + DOORS + BUTTONS + PLAYERS; active *= 2) {
+		std::vector<float> objects;
+		for (int i = 0; i < active; i++) {
+			objects.push_back(angles(rand));
+		}
+
+		// Rejection sampling
+		int found = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < ROUNDS; r++) {
+			for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+				const float angle = angles(rand);
+				bool good = true;
+				for (const float object : objects) {
+					if (difference(angle, object) < CLEARANCE) {
+						good = false;
+						break;
+					}
+				}
+				if (good) {
+					found++;
+					break;
+				}
+			}
+		}
+		const double rejectTime =
+			std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+				.count();
+		const int rejectFound = found;
+
+		// Free space sampling, rebuilding the index every time as GLaDOS does
+		AngleIndex index;
+		found = 0;
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < ROUNDS; r++) {
+			index.clear(SHIP_SIZE);
+			for (const float object : objects) {
+				index.block(object, CLEARANCE);
+			}
+			index.build();
+			if (index.sample(fraction(rand)) >= 0) {
+				found++;
+			}
+		}
+		const double indexTime =
+			std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+				.count();
+
+		std::printf("%3d objects: rejection %7.3f us (%5.1f%% placed), index %7.3f us (%5.1f%%)\n",
+					active, rejectTime / ROUNDS, 100.0 * rejectFound / ROUNDS, indexTime / ROUNDS,
+					100.0 * found / ROUNDS);
+	}
+	return 0;
+}
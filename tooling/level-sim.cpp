@@ -0,0 +1,446 @@
+// Plays thousands of seeded sessions of each level with bot players, to balance level files without
+// playtesting. For every level and player count it reports the win rate, the ship health over the
+// course of the level, how often every breach slot was in use, and how often GLaDOS had to drop an
+// event because the ship had no free objects left for it.
+//
+// Each session runs the host's side of a game: the ship in authoritative mode, so the host resolves
+// every donut's collisions itself, GLaDOS, and one bot per donut. Stabilizer challenges that GLaDOS
+// sends to other players are started on the ship directly. Sessions run in one worker process per
+// core, so each worker has its own copy of the game's singletons and plays its own game.
+//
+// Bot policies:
+//   greedy  Fix your own nearest breach, else hold the nearest unclaimed button, else wait at the
+//           nearest door. Roll with the stabilizer whenever it is active. Closed doors block.
+//   idle    Nobody moves; shows the raw pressure of the level.
+//
+// This links against the game and cugl but never opens a window. Build it like the desktop game on
+// a POSIX system, with this file in place of source/main.cpp, and run it as
+//   level-sim <assets directory> [--sessions N] [--levels 5,6] [--players 2,3] [--workers N]
+//             [--policy greedy|idle] [--seed N]
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "GLaDOS.h"
+#include "LevelConstants.h"
+#include "MagicInternetBox.h"
+#include "NetworkDataType.h"
+#include "RandomStream.h"
+#include "ReplayNetworkConnection.h"
+#include "ShipModel.h"
+#include "SoundEffectController.h"
+#include "TutorialConstants.h"
+
+/** Simulated frames per second */
+constexpr float FRAMERATE = 60.0f;
+/** Longest a session may run, in frames, in case a level never ends */
+constexpr unsigned int MAX_FRAMES = 60 * 60 * 30;
+/** Number of points on the health curve */
+constexpr size_t HEALTH_SAMPLES = 10;
+
+/** Fastest a bot rolls, in degrees per frame; the top speed of a player's donut */
+constexpr float MAX_TURN = 1.7f;
+/** Turning speed of a bot relative to the angle left to its target */
+constexpr float STEER_GAIN = 0.25f;
+/** How far past its breach a bot rolls before coming back to fix it again */
+constexpr float BREACH_ROCK = 8.0f;
+
+/** How the bots play */
+enum class Policy { Greedy, Idle };
+
+/** One game to play */
+struct Session {
+	/** Level number */
+	uint8_t level;
+	/** Number of players */
+	uint8_t players;
+	/** Level seed */
+	uint32_t seed;
+};
+
+/** What happened in one game */
+struct SessionResult {
+	/** Whether the timer ran out with health left */
+	bool won = false;
+	/** Health at the end, as a fraction of the starting health */
+	float endHealth = 0;
+	/** Health at evenly spaced points of the level time, as a fraction of the starting health */
+	std::array<float, HEALTH_SAMPLES> health{};
+	/** Frames simulated */
+	unsigned int frames = 0;
+	/** Frames with no free breach slot */
+	unsigned int saturated = 0;
+	/** Sum over frames of the fraction of breach slots in use */
+	double occupancy = 0;
+	/** The scheduler counters of GLaDOS at the end */
+	GLaDOS::SchedulerStats stats;
+};
+
+static_assert(std::is_trivially_copyable<SessionResult>::value,
+			  "Workers write results straight into shared memory");
+
+/**
+ * Fill in every result by calling play(task) in a fixed number of forked worker processes. The
+ * workers claim tasks one at a time from a counter in shared memory, so workers that draw short
+ * sessions (levels lost early) go on to the next task instead of idling, and write each result
+ * straight into shared memory.
+ *
+ * @return Whether every worker finished
+ */
+template <typename F>
+static bool runWorkers(size_t workers, std::vector<SessionResult>& results, const F& play) {
+	const size_t bytes = sizeof(std::atomic<size_t>) + results.size() * sizeof(SessionResult);
+	void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (block == MAP_FAILED) {
+		return false;
+	}
+	auto* next = new (block) std::atomic<size_t>(0);
+	auto* shared = reinterpret_cast<SessionResult*>(next + 1);
+
+	std::vector<pid_t> pids;
+	for (size_t worker = 0; worker < workers; worker++) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			for (size_t task = (*next)++; task < results.size(); task = (*next)++) {
+				shared[task] = play(task);
+			}
+			_exit(0);
+		}
+		if (pid > 0) {
+			pids.push_back(pid);
+		}
+	}
+
+	bool finished = !pids.empty();
+	for (const pid_t pid : pids) {
+		int status = 0;
+		finished = waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+				   WEXITSTATUS(status) == 0 && finished;
+	}
+	std::copy(shared, shared + results.size(), results.begin());
+	munmap(block, bytes);
+	return finished;
+}
+
+/** Returns the signed angle to go from one angle to another, the short way around the ship */
+static float toward(float to, float from, float size) {
+	const float a = to - from + size / 2;
+	return a - std::floor(a / size) * size - size / 2;
+}
+
+/** Limit a donut's velocity so that it stops at the edge of any door that is still closed */
+static float blockDoors(ShipModel& ship, float angle, float velocity) {
+	const DoorStore& doors = ship.getDoorStore();
+	for (size_t i = 0; i < doors.size(); i++) {
+		if (doors.active[i] == 0 || ship.getDoors()[i]->halfOpen()) {
+			continue;
+		}
+		const float d = toward(doors.angle[i], angle, ship.getSize());
+		if (velocity > 0 && d > 0 && d - globals::DOOR_WIDTH < velocity) {
+			velocity = std::max(0.0f, d - globals::DOOR_WIDTH);
+		} else if (velocity < 0 && d < 0 && d + globals::DOOR_WIDTH > velocity) {
+			velocity = std::min(0.0f, d + globals::DOOR_WIDTH);
+		}
+	}
+	return velocity;
+}
+
+/** Returns the index of the nearest of the given angles accepted by the filter, or -1 */
+template <typename F>
+static int nearest(const std::vector<float>& angles, float from, float size, const F& accept) {
+	int best = -1;
+	float bestDist = size;
+	for (size_t i = 0; i < angles.size(); i++) {
+		const float dist = std::abs(toward(angles[i], from, size));
+		if (dist < bestDist && accept(i)) {
+			best = static_cast<int>(i);
+			bestDist = dist;
+		}
+	}
+	return best;
+}
+
+/** Steer every active donut for one frame */
+static void steer(ShipModel& ship, Policy policy, std::vector<uint8_t>& claimed) {
+	if (policy == Policy::Idle) {
+		return;
+	}
+	const float size = ship.getSize();
+	const BreachStore& breaches = ship.getBreachStore();
+	const ButtonStore& buttons = ship.getButtonStore();
+	const DoorStore& doors = ship.getDoorStore();
+	StabilizerModel& stabilizer = ship.getStabilizer();
+	claimed.assign(buttons.size(), 0);
+
+	const auto& donuts = ship.getDonuts();
+	for (uint8_t p = 0; p < donuts.size(); p++) {
+		const auto& donut = donuts[p];
+		if (!donut->getIsActive()) {
+			continue;
+		}
+		const float angle = donut->getAngle();
+		float velocity = 0;
+		if (stabilizer.getIsActive()) {
+			donut->setVelocity(blockDoors(ship, angle, stabilizer.isLeft() ? -MAX_TURN : MAX_TURN));
+			continue;
+		}
+
+		const int b = nearest(breaches.angle, angle, size, [&](size_t i) {
+			return breaches.active[i] != 0 && breaches.player[i] == p && breaches.health[i] > 0;
+		});
+		const int k = nearest(buttons.angle, angle, size,
+							  [&](size_t i) { return buttons.active[i] != 0 && claimed[i] == 0; });
+		const int d = nearest(doors.angle, angle, size, [&](size_t i) {
+			return doors.active[i] != 0 && !ship.getDoors()[i]->halfOpen();
+		});
+		if (b >= 0) {
+			// Roll off the breach after each fix, so the next pass over it counts again
+			const float target =
+				breaches.playerOn[b] != 0 ? breaches.angle[b] + BREACH_ROCK : breaches.angle[b];
+			velocity = toward(target, angle, size) * STEER_GAIN;
+		} else if (k >= 0) {
+			claimed[k] = 1;
+			const float offset = toward(buttons.angle[k], angle, size);
+			if (std::abs(offset) < globals::BUTTON_ACTIVE_ANGLE / 2) {
+				if (!donut->isJumping()) {
+					donut->startJump();
+				}
+			} else {
+				velocity = offset * STEER_GAIN;
+			}
+		} else if (d >= 0) {
+			velocity = toward(doors.angle[d], angle, size) * STEER_GAIN;
+		}
+
+		velocity = std::max(-MAX_TURN, std::min(MAX_TURN, velocity));
+		donut->setVelocity(blockDoors(ship, angle, velocity));
+	}
+}
+
+/** Play one session to the end */
+static SessionResult play(const Session& session, const std::shared_ptr<LevelModel>& level,
+						  Policy policy) {
+	auto conn = std::make_unique<cugl::ReplayNetworkConnection>(0, session.players);
+	cugl::ReplayNetworkConnection* outbox = conn.get();
+	MagicInternetBox::getInstance().initReplay(std::move(conn), session.level, true, session.seed,
+											   true);
+
+	const auto ship = ShipModel::alloc(level, session.players, 0);
+	ship->seed(session.seed, 0);
+	ship->setLevelNum(session.level);
+	GLaDOS gm;
+	gm.seed(session.seed);
+	gm.init(ship, level);
+
+	SessionResult result;
+	const float initHealth = ship->getHealth();
+	const float timestep = 1 / FRAMERATE;
+	const auto slots = static_cast<double>(ship->getBreaches().size());
+	std::vector<uint8_t> claimed;
+	size_t sample = 0;
+
+	while (!ship->isLevelOver() && result.frames < MAX_FRAMES) {
+		steer(*ship, policy, claimed);
+		ship->update(timestep);
+		gm.update(timestep);
+
+		// Stand in for the other players' devices, which start their own stabilizer challenges
+		for (const auto& message : outbox->takeSent()) {
+			if (!message.empty() && message[0] == AllCreate) {
+				ship->createAllTask();
+			}
+		}
+
+		result.frames++;
+		const size_t free = ship->getFreeBreaches().size();
+		result.saturated += free == 0 && slots > 0 ? 1 : 0;
+		result.occupancy += slots > 0 ? (slots - static_cast<double>(free)) / slots : 0;
+		const float progress = ship->timePassed() / level->getTime();
+		while (sample < HEALTH_SAMPLES &&
+			   progress >= static_cast<float>(sample) / HEALTH_SAMPLES) {
+			result.health[sample++] = ship->getHealth() / initHealth;
+		}
+	}
+
+	result.won = ship->getHealth() > 0 && ship->timerEnded();
+	result.endHealth = std::max(0.0f, ship->getHealth() / initHealth);
+	for (; sample < HEALTH_SAMPLES; sample++) {
+		result.health[sample] = result.endHealth;
+	}
+	result.stats = gm.getSchedulerStats();
+	return result;
+}
+
+/** Parse a comma separated list of numbers */
+static std::vector<uint8_t> parseList(const char* arg) {
+	std::vector<uint8_t> values;
+	const std::string text(arg);
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find(',', start);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		values.push_back(static_cast<uint8_t>(std::strtoul(text.c_str() + start, nullptr, 10)));
+		start = end + 1;
+	}
+	return values;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr,
+					 "Usage: %s <assets directory> [--sessions N] [--levels 5,6] [--players 2,3] "
+					 "[--workers N] [--policy greedy|idle] [--seed N]\n",
+					 argv[0]);
+		return 2;
+	}
+	const std::string assets = argv[1];
+	unsigned long sessions = 1000;
+	std::vector<uint8_t> levels;
+	std::vector<uint8_t> players;
+	size_t workers = std::max(1u, std::thread::hardware_concurrency());
+	Policy policy = Policy::Greedy;
+	uint32_t baseSeed = 0;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		const std::string flag = argv[i];
+		const char* value = argv[i + 1];
+		if (flag == "--sessions") {
+			sessions = std::strtoul(value, nullptr, 10);
+		} else if (flag == "--levels") {
+			levels = parseList(value);
+		} else if (flag == "--players") {
+			players = parseList(value);
+		} else if (flag == "--workers") {
+			workers = std::max(1ul, std::strtoul(value, nullptr, 10));
+		} else if (flag == "--policy") {
+			policy = std::strcmp(value, "idle") == 0 ? Policy::Idle : Policy::Greedy;
+		} else if (flag == "--seed") {
+			baseSeed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		} else {
+			std::fprintf(stderr, "Unknown option %s\n", flag.c_str());
+			return 2;
+		}
+	}
+	if (sessions == 0) {
+		return 0;
+	}
+	if (levels.empty()) {
+		for (uint8_t l = 0; l < MAX_NUM_LEVELS; l++) {
+			if (!tutorial::IS_TUTORIAL_LEVEL(l) && std::strcmp(LEVEL_NAMES.at(l), "") != 0) {
+				levels.push_back(l);
+			}
+		}
+	}
+	if (players.empty()) {
+		for (uint8_t p = globals::MIN_PLAYERS; p <= globals::MAX_PLAYERS; p++) {
+			players.push_back(p);
+		}
+	}
+
+	// The game logs every resolved button; keep the report readable
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN);
+	// Create the sound effect singleton once for every worker; it stays silent without assets
+	SoundEffectController::getInstance();
+
+	// Load every level up front; the models are only read once play starts
+	std::vector<std::shared_ptr<LevelModel>> models(MAX_NUM_LEVELS);
+	for (const uint8_t l : levels) {
+		if (l >= MAX_NUM_LEVELS || tutorial::IS_TUTORIAL_LEVEL(l)) {
+			std::fprintf(stderr, "Level %d is not a playable level\n", l);
+			return 2;
+		}
+		const auto json = cugl::JsonReader::alloc(assets + "/" + LEVEL_NAMES.at(l));
+		models[l] = LevelModel::alloc();
+		if (json == nullptr || !models[l]->preload(json->readJson())) {
+			std::fprintf(stderr, "Could not load level %s\n", LEVEL_NAMES.at(l));
+			return 2;
+		}
+	}
+
+	// Every session gets its own seed, stable across runs and worker counts
+	std::vector<Session> tasks;
+	const RandomStream root = RandomStream::level(baseSeed);
+	for (const uint8_t l : levels) {
+		for (const uint8_t p : players) {
+			RandomStream seeds = root.split(l).split(p);
+			for (unsigned long s = 0; s < sessions; s++) {
+				tasks.push_back({l, p, static_cast<uint32_t>(seeds())});
+			}
+		}
+	}
+
+	std::vector<SessionResult> results(tasks.size());
+	const auto start = std::chrono::steady_clock::now();
+	const bool finished = runWorkers(workers, results, [&](size_t task) {
+		const Session& session = tasks[task];
+		return play(session, models[session.level], policy);
+	});
+	if (!finished) {
+		std::fprintf(stderr, "A worker failed to finish\n");
+		return 1;
+	}
+	const double wall =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double simulated = 0;
+	for (size_t first = 0; first < tasks.size(); first += sessions) {
+		const Session& config = tasks[first];
+		double wins = 0;
+		double endHealth = 0;
+		double frames = 0;
+		double saturated = 0;
+		double occupancy = 0;
+		double fired = 0;
+		double placed = 0;
+		double exhausted = 0;
+		double dropped = 0;
+		std::array<double, HEALTH_SAMPLES> health{};
+		for (size_t i = first; i < first + sessions; i++) {
+			const SessionResult& r = results[i];
+			wins += r.won ? 1 : 0;
+			endHealth += r.endHealth;
+			frames += r.frames;
+			saturated += r.saturated;
+			occupancy += r.occupancy;
+			fired += r.stats.fired;
+			placed += r.stats.placed;
+			exhausted += r.stats.exhausted;
+			dropped += r.stats.dropped;
+			for (size_t s = 0; s < HEALTH_SAMPLES; s++) {
+				health[s] += r.health[s];
+			}
+		}
+		simulated += frames / FRAMERATE;
+		const auto n = static_cast<double>(sessions);
+		std::printf(
+			"level %2d, %d players: win %5.1f%%, end health %5.1f%%, breaches saturated %5.1f%% "
+			"of frames (%4.1f%% of slots used), %6.1f events fired, %6.1f placed, starved %5.1f%%, "
+			"other drops %5.1f%%\n  health:",
+			config.level, config.players, 100 * wins / n, 100 * endHealth / n,
+			frames > 0 ? 100 * saturated / frames : 0, frames > 0 ? 100 * occupancy / frames : 0,
+			fired / n, placed / n, fired > 0 ? 100 * exhausted / fired : 0,
+			fired > 0 ? 100 * (dropped - exhausted) / fired : 0);
+		for (const double h : health) {
+			std::printf(" %3.0f", 100 * h / n);
+		}
+		std::printf("\n");
+	}
+	std::printf("%zu sessions on %zu workers in %.2f s: %.0fx real time\n", tasks.size(), workers,
+				wall, wall > 0 ? simulated / wall : 0);
+	return 0;
+}
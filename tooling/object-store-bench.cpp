@@ -0,0 +1,158 @@
+// Benchmarks the per-frame ship object loops (health drain, active scan and encode) over
+// separately allocated models behind shared pointers against packed per-field arrays, on the most
+// crowded ship the game can produce: level 8 with 6 players.
+//
+// The models are allocated with unrelated blocks in between, as they are in a running game, so
+// that the pointer layout pays for the cache misses it would cause.
+//
+// Build from the repository root with
+//   g++ -O2 -std=c++14 tooling/object-store-bench.cpp
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+/** Object counts of level 8, scaled from 2 to 6 players */
+constexpr size_t BREACHES = 60;
+constexpr size_t DOORS = 30;
+/** Bytes of unrelated allocation between consecutive models */
+constexpr size_t SCATTER = 4096;
+/** Frames per run */
+constexpr int FRAMES = 200000;
+/** Frames between evictions of the cache by the rest of the game */
+constexpr int BLOCK = 16;
+
+/** A breach laid out as the old model was */
+struct Breach {
+	float angle = 0;
+	uint8_t health = 0;
+	bool playerOn = false;
+	uint8_t player = 0;
+	bool needSpriteUpdate = false;
+	float timeCreated = 0;
+	bool isActive = false;
+};
+
+/** A door laid out as the old model was */
+struct Door {
+	unsigned int height = 0;
+	bool isActive = false;
+	float angle = 0;
+	uint8_t playersOn = 0;
+};
+
+/** Packed breaches */
+struct BreachStore {
+	std::vector<float> angle, timeCreated;
+	std::vector<uint8_t> health, player, active;
+};
+
+/** Packed doors */
+struct DoorStore {
+	std::vector<float> angle;
+	std::vector<uint8_t> active;
+};
+
+int main() {
+	std::minstd_rand rand(0);
+	std::uniform_real_distribution<float> unit(0, 1);
+	std::vector<std::unique_ptr<char[]>> scatter;
+
+	std::vector<std::shared_ptr<Breach>> breaches;
+	std::vector<std::shared_ptr<Door>> doors;
+	BreachStore breachStore;
+	DoorStore doorStore;
+	for (size_t i = 0; i < BREACHES + DOORS; i++) {
+		scatter.emplace_back(new char[SCATTER]);
+		const bool active = unit(rand) < 0.5f;
+		const float angle = unit(rand) * 870;
+		if (i < BREACHES) {
+			auto breach = std::make_shared<Breach>();
+			breach->angle = angle;
+			breach->isActive = active;
+			breach->health = active ? 3 : 0;
+			breach->timeCreated = unit(rand) * 60;
+			breaches.push_back(breach);
+			breachStore.angle.push_back(angle);
+			breachStore.timeCreated.push_back(breach->timeCreated);
+			breachStore.health.push_back(breach->health);
+			breachStore.player.push_back(0);
+			breachStore.active.push_back(active ? 1 : 0);
+		} else {
+			auto door = std::make_shared<Door>();
+			door->angle = angle;
+			door->isActive = active;
+			doors.push_back(door);
+			doorStore.angle.push_back(angle);
+			doorStore.active.push_back(active ? 1 : 0);
+		}
+	}
+
+	// Scratch memory touched between blocks of frames, standing in for the rest of the game
+	std::vector<char> game(1 << 22);
+	auto evict = [&game]() {
+		for (size_t i = 0; i < game.size(); i += 64) {
+			game[i]++;
+		}
+	};
+
+	std::vector<uint8_t> data;
+	data.reserve(512);
+	double checksum = 0;
+	double pointerTime = 0;
+	double packedTime = 0;
+	for (int block = 0; block < FRAMES / BLOCK; block++) {
+		evict();
+		auto start = std::chrono::steady_clock::now();
+		for (int f = block * BLOCK; f < (block + 1) * BLOCK; f++) {
+			const float now = std::trunc(static_cast<float>(f % 3600) / 60);
+			float drain = 0;
+			data.clear();
+			for (const auto& breach : breaches) {
+				if (breach->isActive && now - std::trunc(breach->timeCreated) > 5) {
+					drain += 0.003f;
+				}
+				data.push_back(breach->health);
+				data.push_back(static_cast<uint8_t>(breach->angle));
+			}
+			for (const auto& door : doors) {
+				data.push_back(door->isActive ? static_cast<uint8_t>(door->angle) : 0);
+			}
+			checksum += drain + static_cast<double>(data.size());
+		}
+		pointerTime +=
+			std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+				.count();
+
+		evict();
+		start = std::chrono::steady_clock::now();
+		for (int f = block * BLOCK; f < (block + 1) * BLOCK; f++) {
+			const float now = std::trunc(static_cast<float>(f % 3600) / 60);
+			float drain = 0;
+			data.clear();
+			for (size_t i = 0; i < BREACHES; i++) {
+				if (breachStore.active[i] != 0 &&
+					now - std::trunc(breachStore.timeCreated[i]) > 5) {
+					drain += 0.003f;
+				}
+				data.push_back(breachStore.health[i]);
+				data.push_back(static_cast<uint8_t>(breachStore.angle[i]));
+			}
+			for (size_t i = 0; i < DOORS; i++) {
+				data.push_back(doorStore.active[i] != 0 ? static_cast<uint8_t>(doorStore.angle[i])
+														: 0);
+			}
+			checksum += drain + static_cast<double>(data.size());
+		}
+		packedTime +=
+			std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+				.count();
+	}
+
+	std::printf("pointers %.1f ns/frame, packed %.1f ns/frame (checksum %.0f)\n",
+				pointerTime / FRAMES, packedTime / FRAMES, checksum);
+	return 0;
+}
@@ -0,0 +1,174 @@
+#!/usr/bin/env python
+"""Packs an asset directory into a single archive for cugl::AssetPack.
+
+The pack has a header, an index sorted by the FNV-1a hash of each relative
+path, a table of names, and the entry data aligned to 16 bytes. Entries that
+shrink under LZ4 block compression are stored compressed (see --compress).
+The format is documented in cugl/include/cugl/io/CUAssetPack.h.
+
+The pack replaces the loose files, so write it outside the asset directory
+and ship a directory holding only the pack. Otherwise every asset ships twice.
+
+Example:
+    python tooling/pack-assets.py assets build/packed/assets.pack --compress json
+
+Then bundle build/packed (not assets) as the asset directory of the release.
+
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = 0x4B505543
+VERSION = 1
+ALIGNMENT = 16
+COMPRESSED = 1
+
+HEADER = struct.Struct('<IIIIII')
+ENTRY = struct.Struct('<QQIIII')
+
+FNV_OFFSET = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+MASK64 = 0xffffffffffffffff
+
+# LZ4 block constraints
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MF_LIMIT = 12
+MAX_OFFSET = 0xffff
+
+
+def fnv1a(path):
+    """Returns the 64-bit FNV-1a hash of a pack path."""
+    result = FNV_OFFSET
+    for byte in bytearray(path.encode('utf-8')):
+        result ^= byte
+        result = (result * FNV_PRIME) & MASK64
+    return result
+
+
+def write_length(out, length):
+    """Writes the continuation bytes of an LZ4 length field."""
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def lz4_compress(data):
+    """Returns data compressed as a single LZ4 block (greedy matching)."""
+    data = bytes(data)
+    size = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    limit = size - MF_LIMIT
+    while pos < limit:
+        key = data[pos:pos + MIN_MATCH]
+        cand = table.get(key)
+        table[key] = pos
+        if cand is None or pos - cand > MAX_OFFSET:
+            pos += 1
+            continue
+
+        end = pos + MIN_MATCH
+        stop = size - LAST_LITERALS
+        while end < stop and data[end] == data[cand + end - pos]:
+            end += 1
+
+        literals = pos - anchor
+        matchlen = end - pos - MIN_MATCH
+        out.append((min(literals, 15) << 4) | min(matchlen, 15))
+        if literals >= 15:
+            write_length(out, literals - 15)
+        out += data[anchor:pos]
+        out += struct.pack('<H', pos - cand)
+        if matchlen >= 15:
+            write_length(out, matchlen - 15)
+        pos = end
+        anchor = end
+
+    literals = size - anchor
+    out.append(min(literals, 15) << 4)
+    if literals >= 15:
+        write_length(out, literals - 15)
+    out += data[anchor:]
+    return bytes(out)
+
+
+def collect(root, output):
+    """Returns the sorted relative paths of all files under root."""
+    result = []
+    skip = os.path.abspath(output)
+    for folder, _, files in os.walk(root):
+        for name in files:
+            full = os.path.join(folder, name)
+            if os.path.abspath(full) == skip or name.startswith('.'):
+                continue
+            result.append(os.path.relpath(full, root).replace(os.sep, '/'))
+    return sorted(result)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('root', help='the asset directory to pack')
+    parser.add_argument('output', help='the pack file to write')
+    parser.add_argument('--compress', nargs='*', default=[], metavar='EXT',
+                        help='file extensions to try compressing (e.g. json ttf)')
+    args = parser.parse_args()
+
+    compress = set(ext.lower().lstrip('.') for ext in args.compress)
+    paths = collect(args.root, args.output)
+
+    names = bytearray()
+    entries = []
+    blobs = []
+    for path in paths:
+        with open(os.path.join(args.root, path), 'rb') as f:
+            data = f.read()
+        flags = 0
+        stored = data
+        if os.path.splitext(path)[1].lower().lstrip('.') in compress and data:
+            packed = lz4_compress(data)
+            if len(packed) < len(data):
+                stored = packed
+                flags = COMPRESSED
+        entries.append([fnv1a(path), 0, len(data), len(stored), flags, len(names)])
+        names += path.encode('utf-8') + b'\0'
+        blobs.append(stored)
+
+    hashes = [e[0] for e in entries]
+    if len(set(hashes)) != len(hashes):
+        print('warning: hash collision in pack; lookups will check names', file=sys.stderr)
+
+    offset = HEADER.size + ENTRY.size * len(entries) + len(names)
+    for entry, blob in zip(entries, blobs):
+        offset = (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+        entry[1] = offset
+        offset += len(blob)
+
+    order = sorted(range(len(entries)), key=lambda i: entries[i][0])
+    folder = os.path.dirname(args.output)
+    if folder and not os.path.isdir(folder):
+        os.makedirs(folder)
+    with open(args.output, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, 0, len(entries), len(names), 0))
+        for i in order:
+            f.write(ENTRY.pack(*entries[i]))
+        f.write(names)
+        for entry, blob in zip(entries, blobs):
+            f.write(b'\0' * (entry[1] - f.tell()))
+            f.write(blob)
+
+    total = sum(e[2] for e in entries)
+    print('Packed %d files (%d bytes) into %s (%d bytes)' %
+          (len(entries), total, args.output, offset))
+
+
+if __name__ == '__main__':
+    main()
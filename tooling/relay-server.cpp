@@ -0,0 +1,142 @@
+// A UDP relay for players whose NATs defeat punchthrough, to run next to the punchthrough server
+// (or locally, for testing the relay path of the ad-hoc connection).
+//
+// Runs a UDPProxyCoordinator on the given port, which the game connects to through the relay
+// settings of its ConnectionConfig; the game has no relay unless SWEETSPACE_RELAY is set to this
+// machine's address. A UDPProxyServer on a second peer logs in to the coordinator over loopback
+// and forwards the traffic of every relay it is handed. Behind a NAT or on a LAN, pass the address
+// players should send relayed traffic to as the public address.
+//
+// Build from the repository root with
+//   c++ -O2 -std=c++14 -Isource tooling/relay-server.cpp source/libraries/SLikeNet/*.cpp -lpthread
+// and run it as
+//   relay-server [port] [public address]
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "libraries/SLikeNet/slikenet/MessageIdentifiers.h"
+#include "libraries/SLikeNet/slikenet/UDPProxyCoordinator.h"
+#include "libraries/SLikeNet/slikenet/UDPProxyServer.h"
+#include "libraries/SLikeNet/slikenet/peerinterface.h"
+
+/** Port the coordinator listens on if none is given; matches RELAY_PORT in MagicInternetBox */
+constexpr unsigned short DEFAULT_PORT = 61112;
+/** Most game peers connected to the coordinator at once */
+constexpr unsigned int MAX_CONNECTIONS = 1024;
+/** Password the relay server logs in to the coordinator with; both live in this process */
+constexpr auto LOGIN_PASSWORD = "sweetspace";
+/** Time between polls of the peers */
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(10);
+/** How long to block on shutdown (ms) */
+constexpr unsigned int SHUTDOWN_BLOCK = 100;
+
+/** Cleared by SIGINT to stop the server */
+static std::atomic<bool> running(true);
+
+/** Reports how logging in to the coordinator went */
+class LoginHandler : public SLNet::UDPProxyServerResultHandler {
+   public:
+	void OnLoginSuccess(SLNet::RakString /*usedPassword*/,
+						SLNet::UDPProxyServer* /*proxyServerPlugin*/) override {
+		std::printf("Relay server logged in; forwarding\n");
+	}
+	void OnAlreadyLoggedIn(SLNet::RakString /*usedPassword*/,
+						   SLNet::UDPProxyServer* /*proxyServerPlugin*/) override {
+		std::printf("Relay server was already logged in\n");
+	}
+	void OnNoPasswordSet(SLNet::RakString /*usedPassword*/,
+						 SLNet::UDPProxyServer* /*proxyServerPlugin*/) override {
+		std::fprintf(stderr, "Coordinator has no login password\n");
+		running = false;
+	}
+	void OnWrongPassword(SLNet::RakString /*usedPassword*/,
+						 SLNet::UDPProxyServer* /*proxyServerPlugin*/) override {
+		std::fprintf(stderr, "Coordinator rejected the relay server's password\n");
+		running = false;
+	}
+};
+
+/** Drain a peer's packets, setting accepted to any address that accepted our connection */
+static void drain(SLNet::RakPeerInterface* peer, const char* name,
+				  SLNet::SystemAddress* accepted = nullptr) {
+	for (SLNet::Packet* packet = peer->Receive(); packet != nullptr;
+		 peer->DeallocatePacket(packet), packet = peer->Receive()) {
+		switch (packet->data[0]) {
+			case ID_NEW_INCOMING_CONNECTION:
+				std::printf("%s: %s connected\n", name, packet->systemAddress.ToString());
+				break;
+			case ID_CONNECTION_REQUEST_ACCEPTED:
+				if (accepted != nullptr) {
+					*accepted = packet->systemAddress;
+				}
+				break;
+			case ID_DISCONNECTION_NOTIFICATION:
+			case ID_CONNECTION_LOST:
+				std::printf("%s: %s left\n", name, packet->systemAddress.ToString());
+				break;
+			case ID_CONNECTION_ATTEMPT_FAILED:
+				std::fprintf(stderr, "%s: could not connect to %s\n", name,
+							 packet->systemAddress.ToString());
+				running = false;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	const auto port =
+		argc > 1 ? static_cast<unsigned short>(std::atoi(argv[1])) : DEFAULT_PORT; // NOLINT
+	const char* publicAddress = argc > 2 ? argv[2] : nullptr;							// NOLINT
+
+	SLNet::RakPeerInterface* coordinatorPeer = SLNet::RakPeerInterface::GetInstance();
+	SLNet::UDPProxyCoordinator coordinator;
+	coordinator.SetRemoteLoginPassword(LOGIN_PASSWORD);
+	coordinatorPeer->AttachPlugin(&coordinator);
+	SLNet::SocketDescriptor coordinatorSocket(port, nullptr);
+	if (coordinatorPeer->Startup(MAX_CONNECTIONS, &coordinatorSocket, 1) !=
+		SLNet::RAKNET_STARTED) {
+		std::fprintf(stderr, "Could not listen on port %d\n", port);
+		return 1;
+	}
+	coordinatorPeer->SetMaximumIncomingConnections(MAX_CONNECTIONS);
+
+	SLNet::RakPeerInterface* serverPeer = SLNet::RakPeerInterface::GetInstance();
+	SLNet::UDPProxyServer server;
+	LoginHandler loginHandler;
+	server.SetResultHandler(&loginHandler);
+	if (publicAddress != nullptr) {
+		server.SetServerPublicIP(publicAddress);
+	}
+	serverPeer->AttachPlugin(&server);
+	SLNet::SocketDescriptor serverSocket;
+	serverPeer->Startup(1, &serverSocket, 1);
+	serverPeer->Connect("127.0.0.1", port, nullptr, 0);
+
+	std::signal(SIGINT, [](int /*signal*/) { running = false; });
+	std::printf("Relay coordinator listening on port %d\n", port);
+
+	while (running) {
+		drain(coordinatorPeer, "coordinator");
+
+		SLNet::SystemAddress accepted = SLNet::UNASSIGNED_SYSTEM_ADDRESS;
+		drain(serverPeer, "relay", &accepted);
+		if (accepted != SLNet::UNASSIGNED_SYSTEM_ADDRESS) {
+			server.LoginToCoordinator(LOGIN_PASSWORD, accepted);
+		}
+
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+
+	std::printf("Shutting down\n");
+	serverPeer->Shutdown(SHUTDOWN_BLOCK);
+	coordinatorPeer->Shutdown(SHUTDOWN_BLOCK);
+	SLNet::RakPeerInterface::DestroyInstance(serverPeer);
+	SLNet::RakPeerInterface::DestroyInstance(coordinatorPeer);
+	return 0;
+}
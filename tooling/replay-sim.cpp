@@ -0,0 +1,208 @@
+// Re-simulates a replay log recorded by a build with SWEETSPACE_RECORD_REPLAY defined, and reports
+// the simulation time of every frame and the first frame of each level whose ship state diverges
+// from the recording.
+//
+// Each level is rebuilt from its recorded seed, player count and level file. Every recorded frame
+// then runs the same steps as GameMode::update: the network update (fed the recorded inbound
+// messages through a ReplayNetworkConnection), the recorded roll and jump, the ship, and GLaDOS if
+// the recording player was the host. Messages the re-simulation sends are counted against the
+// recorded ones.
+//
+// This links against the game and cugl but never opens a window. Build it like the desktop game,
+// with this file in place of source/main.cpp, and run it as
+//   replay-sim <replay.ssr> <assets directory>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "GLaDOS.h"
+#include "LevelConstants.h"
+#include "MagicInternetBox.h"
+#include "ReplayLog.h"
+#include "ReplayNetworkConnection.h"
+#include "ShipModel.h"
+#include "TutorialConstants.h"
+
+/** Per level results */
+struct LevelReport {
+	/** Level number */
+	uint8_t level = 0;
+	/** Simulation time of every simulated frame, in microseconds */
+	std::vector<double> frameTimes;
+	/** Index of the first diverging frame, or -1 */
+	long divergence = -1;
+	/** Messages sent in the recording and the re-simulation */
+	size_t recordedSent = 0;
+	size_t replayedSent = 0;
+};
+
+/** The state of the level being re-simulated */
+struct Level {
+	std::shared_ptr<ShipModel> ship;
+	tl::optional<GLaDOS> gm;
+	cugl::ReplayNetworkConnection* conn = nullptr;
+	uint8_t playerID = 0;
+	bool valid = false;
+};
+
+/** Rebuild a level as GameMode::init does */
+static bool startLevel(const ReplayLog::Entry& entry, const std::string& assets, Level& level) {
+	level.gm.reset();
+	level.playerID = entry.playerID;
+	level.valid = false;
+	if (entry.level >= MAX_NUM_LEVELS) {
+		return false;
+	}
+
+	if (!tutorial::IS_TUTORIAL_LEVEL(entry.level)) {
+		const auto json = cugl::JsonReader::alloc(assets + "/" + LEVEL_NAMES.at(entry.level));
+		const auto model = LevelModel::alloc();
+		if (json == nullptr || !model->preload(json->readJson())) {
+			std::fprintf(stderr, "Could not load level %s\n", LEVEL_NAMES.at(entry.level));
+			return false;
+		}
+		level.ship = ShipModel::alloc(model, entry.numPlayers, entry.playerID);
+		level.ship->seed(entry.seed, entry.playerID);
+		if (entry.playerID == 0) {
+			level.gm.emplace();
+			level.gm->seed(entry.seed);
+			level.gm->init(level.ship, model);
+		}
+	} else {
+		level.ship = ShipModel::alloc(0, 0, 0, 0, 0, 0);
+		level.ship->seed(entry.seed, entry.playerID);
+		level.gm.emplace();
+		level.gm->seed(entry.seed);
+		level.gm->init(level.ship, entry.level);
+		if (entry.playerID != 0) {
+			level.gm.reset();
+		}
+	}
+	level.ship->setLevelNum(entry.level);
+
+	auto conn = std::make_unique<cugl::ReplayNetworkConnection>(entry.playerID, entry.numPlayers);
+	level.conn = conn.get();
+	MagicInternetBox::getInstance().initReplay(std::move(conn), entry.level, entry.parity,
+											   entry.seed, entry.authoritative);
+	level.valid = true;
+	return true;
+}
+
+/** Simulate one recorded frame as GameMode::update does */
+static void stepLevel(const ReplayLog::Entry& entry, Level& level) {
+	auto& net = MagicInternetBox::getInstance();
+	net.update(level.ship);
+
+	// Loss and win screens do not step the models
+	if (level.ship->getHealth() < 1 ||
+		(level.ship->timerEnded() && level.ship->getHealth() > 0)) {
+		return;
+	}
+
+	const auto& donut = level.ship->getDonuts()[level.playerID];
+	if (entry.jump && !donut->isJumping()) {
+		donut->startJump();
+		net.jump(level.playerID);
+	}
+	donut->applyForce(entry.roll);
+	donut->transitionFaceState(DonutModel::FaceState::Idle);
+
+	level.ship->update(entry.timestep);
+	if (level.gm.has_value()) {
+		level.gm->update(entry.timestep);
+	}
+}
+
+/** Returns the given percentile of some sorted times */
+static double percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty()) {
+		return 0;
+	}
+	const auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+	return sorted[index];
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::fprintf(stderr, "Usage: %s <replay.ssr> <assets directory>\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<ReplayLog::Entry> entries;
+	if (!ReplayLog::read(argv[1], entries)) {
+		if (entries.empty()) {
+			return 2;
+		}
+		std::fprintf(stderr, "Replay log is truncated; re-simulating %zu records\n",
+					 entries.size());
+	}
+
+	std::vector<LevelReport> reports;
+	Level level;
+	long frame = 0;
+	for (const auto& entry : entries) {
+		switch (entry.kind) {
+			case ReplayLog::Kind::Level:
+				frame = 0;
+				if (startLevel(entry, argv[2], level)) {
+					reports.emplace_back();
+					reports.back().level = entry.level;
+				}
+				break;
+			case ReplayLog::Kind::Inbound:
+				if (level.valid) {
+					level.conn->push(entry.message);
+				}
+				break;
+			case ReplayLog::Kind::Outbound:
+				if (level.valid) {
+					reports.back().recordedSent++;
+				}
+				break;
+			case ReplayLog::Kind::Frame: {
+				if (!level.valid) {
+					break;
+				}
+				const auto start = std::chrono::steady_clock::now();
+				stepLevel(entry, level);
+				const auto end = std::chrono::steady_clock::now();
+				reports.back().frameTimes.push_back(
+					std::chrono::duration<double, std::micro>(end - start).count());
+				reports.back().replayedSent += level.conn->takeSent().size();
+				frame++;
+				break;
+			}
+			case ReplayLog::Kind::Digest:
+				if (level.valid && reports.back().divergence < 0 &&
+					ReplayLog::hash(level.ship) != entry.digest) {
+					reports.back().divergence = frame - 1;
+				}
+				break;
+		}
+	}
+
+	int diverged = 0;
+	for (auto& report : reports) {
+		std::vector<double> sorted = report.frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0;
+		for (const double t : sorted) {
+			total += t;
+		}
+		std::printf(
+			"level %2d: %6zu frames, mean %7.2f us, p50 %7.2f us, p99 %7.2f us, max %8.2f us, "
+			"sent %zu/%zu",
+			report.level, sorted.size(), sorted.empty() ? 0 : total / sorted.size(),
+			percentile(sorted, 0.5), percentile(sorted, 0.99), percentile(sorted, 1),
+			report.replayedSent, report.recordedSent);
+		if (report.divergence >= 0) {
+			std::printf(", DIVERGED at frame %ld\n", report.divergence);
+			diverged++;
+		} else {
+			std::printf("\n");
+		}
+	}
+	return diverged == 0 ? 0 : 1;
+}
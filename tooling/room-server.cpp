@@ -0,0 +1,687 @@
+// A local stand-in for the matchmaking servers, for testing and benchmarking the connection
+// handshakes without the internet. Run it next to tooling/relay-server.cpp to cover the relay
+// path too.
+//
+// Serves both ways of joining a game:
+//   - NAT punchthrough on UDP, for the ad-hoc connection. Every peer that connects is assigned a
+//     room ID, as the real server does. Punchthrough requests name their target by room ID, so
+//     they are translated to the GUID of the room's host before the vendored
+//     NatPunchthroughServer sees them. Everything else about the handshake is between players.
+//   - Rooms on a websocket, for the fallback connection. The server assigns room IDs and player
+//     IDs, and forwards messages between the players of each room.
+// A status line every few seconds counts open rooms, punchthrough requests and websocket traffic.
+//
+// Point the game at it by setting SWEETSPACE_SERVER to this machine's address. The default ports
+// match MagicInternetBox, which always uses them.
+//
+// Linux and macOS only. Build from the repository root with
+//   c++ -O2 -std=c++14 -Isource tooling/room-server.cpp source/libraries/SLikeNet/*.cpp -lpthread
+// and run it as
+//   room-server [punchthrough port] [websocket port]
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "libraries/SLikeNet/slikenet/Base64Encoder.h"
+#include "libraries/SLikeNet/slikenet/BitStream.h"
+#include "libraries/SLikeNet/slikenet/DR_SHA1.h"
+#include "libraries/SLikeNet/slikenet/MessageIdentifiers.h"
+#include "libraries/SLikeNet/slikenet/NatPunchthroughServer.h"
+#include "libraries/SLikeNet/slikenet/PluginInterface2.h"
+#include "libraries/SLikeNet/slikenet/peerinterface.h"
+
+/** Punchthrough port if none is given; matches SERVER_PORT in MagicInternetBox */
+constexpr unsigned short DEFAULT_PUNCH_PORT = 61111;
+/** Websocket port if none is given; matches FALLBACK_PORT in MagicInternetBox */
+constexpr unsigned short DEFAULT_WS_PORT = 8080;
+/** Most peers connected to the punchthrough server at once */
+constexpr unsigned int MAX_CONNECTIONS = 1024;
+/** Most players per websocket room; matches MAX_PLAYERS in MagicInternetBox */
+constexpr uint8_t MAX_PLAYERS = 6;
+/** Number of characters in a room ID; matches ROOM_LENGTH in Globals.h */
+constexpr int ROOM_LENGTH = 5;
+/** Number of distinct room IDs */
+constexpr uint32_t ROOM_COUNT = 100000;
+/** Time between polls of the sockets (ms) */
+constexpr int POLL_INTERVAL = 10;
+/** Time between status lines */
+constexpr auto STATUS_INTERVAL = std::chrono::seconds(5);
+/** How long to block on shutdown (ms) */
+constexpr unsigned int SHUTDOWN_BLOCK = 100;
+
+/** Packet IDs of the ad-hoc connection that the server sends, from its CustomDataPackets */
+constexpr uint8_t ADHOC_ASSIGNED_ROOM = ID_USER_PACKET_ENUM + 1;
+
+/** Message types of the websocket connection, from its CustomDataPackets */
+enum WsMessage : uint8_t {
+	GeneralMsg = 0,
+	HostMsg,
+	PlayerJoined = 50,
+	PlayerDisconnect,
+	StartGame,
+	AssignedRoom = 100,
+	JoinRoom,
+	ApiMismatch
+};
+
+/** Results of a websocket JoinRoom request, as the connection reads them */
+enum JoinResult : uint8_t { Joined = 0, RoomNotFound = 1, RoomFull = 2, GameStarted = 4 };
+
+/** Cleared by SIGINT to stop the server */
+static std::atomic<bool> running(true);
+
+/** Counters for the status line */
+struct Stats {
+	uint64_t punchRequests = 0;
+	uint64_t unknownRooms = 0;
+	uint64_t wsMessages = 0;
+	uint64_t wsBytes = 0;
+};
+static Stats stats;
+
+/** Hands out unused room IDs */
+class RoomIds {
+   public:
+	RoomIds() : rng(std::random_device()()) {}
+
+	/** Returns an unused room ID and marks it used; there must be one left */
+	uint32_t take() {
+		std::uniform_int_distribution<uint32_t> dist(0, ROOM_COUNT - 1);
+		uint32_t id = dist(rng);
+		while (used[id]) {
+			id = (id + 1) % ROOM_COUNT;
+		}
+		used[id] = true;
+		return id;
+	}
+
+	/** Marks the given room ID unused */
+	void release(uint32_t id) { used[id] = false; }
+
+	/** Returns the room ID as players type it */
+	static std::string format(uint32_t id) {
+		std::array<char, ROOM_LENGTH + 1> buf{};
+		std::snprintf(buf.data(), buf.size(), "%0*u", ROOM_LENGTH, id);
+		return std::string(buf.data(), ROOM_LENGTH);
+	}
+
+   private:
+	std::mt19937 rng;
+	std::vector<bool> used = std::vector<bool>(ROOM_COUNT, false);
+};
+static RoomIds roomIds;
+
+/**
+ * Gives every peer a room and points punchthrough requests for a room at its host.
+ *
+ * Attached before the NatPunchthroughServer so that it sees each request first.
+ */
+class RoomPlugin : public SLNet::PluginInterface2 {
+   public:
+	size_t numRooms() const { return rooms.size(); }
+
+   protected:
+	void OnNewConnection(const SLNet::SystemAddress& systemAddress, SLNet::RakNetGUID rakNetGUID,
+						 bool /*isIncoming*/) override {
+		const uint32_t room = roomIds.take();
+		rooms[room] = rakNetGUID;
+		owned[rakNetGUID.g] = room;
+
+		// [ ASSIGNED_ROOM | length (varint) | room ID ]
+		const std::string id = RoomIds::format(room);
+		SLNet::BitStream bs;
+		bs.Write(ADHOC_ASSIGNED_ROOM);
+		bs.Write(static_cast<uint8_t>(id.size()));
+		bs.WriteAlignedBytes(reinterpret_cast<const unsigned char*>(id.data()),
+							 static_cast<unsigned int>(id.size()));
+		rakPeerInterface->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, systemAddress, false);
+	}
+
+	void OnClosedConnection(const SLNet::SystemAddress& /*systemAddress*/,
+							SLNet::RakNetGUID rakNetGUID,
+							SLNet::PI2_LostConnectionReason /*lostConnectionReason*/) override {
+		const auto it = owned.find(rakNetGUID.g);
+		if (it == owned.end()) {
+			return;
+		}
+		rooms.erase(it->second);
+		roomIds.release(it->second);
+		owned.erase(it);
+	}
+
+	SLNet::PluginReceiveResult OnReceive(SLNet::Packet* packet) override {
+		if (packet->data[0] != ID_NAT_PUNCHTHROUGH_REQUEST) {
+			return SLNet::RR_CONTINUE_PROCESSING;
+		}
+		stats.punchRequests++;
+
+		// [ ID_NAT_PUNCHTHROUGH_REQUEST | target GUID ]; players pass a room ID as the GUID
+		SLNet::BitStream in(packet->data, packet->length, false);
+		in.IgnoreBytes(sizeof(SLNet::MessageID));
+		SLNet::RakNetGUID target;
+		if (!in.Read(target) || target.g >= ROOM_COUNT) {
+			// Mesh peers punch through to each other by their real GUIDs
+			return SLNet::RR_CONTINUE_PROCESSING;
+		}
+		const auto it = rooms.find(static_cast<uint32_t>(target.g));
+		if (it == rooms.end()) {
+			// The punchthrough server reports the target as not connected
+			stats.unknownRooms++;
+			return SLNet::RR_CONTINUE_PROCESSING;
+		}
+		SLNet::BitStream out(packet->data, packet->length, false);
+		out.SetWriteOffset(BYTES_TO_BITS(sizeof(SLNet::MessageID)));
+		out.Write(it->second);
+		return SLNet::RR_CONTINUE_PROCESSING;
+	}
+
+   private:
+	/** The host of each room */
+	std::unordered_map<uint32_t, SLNet::RakNetGUID> rooms;
+	/** The room of each peer */
+	std::unordered_map<uint64_t, uint32_t> owned;
+};
+
+/** The key every websocket handshake hashes with the client's key */
+constexpr auto WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+/** Opcodes of the websocket frames the server understands */
+constexpr uint8_t WS_BINARY = 0x2;
+constexpr uint8_t WS_CLOSE = 0x8;
+constexpr uint8_t WS_PING = 0x9;
+constexpr uint8_t WS_PONG = 0xA;
+/** The FIN bit of a frame's first byte */
+constexpr uint8_t WS_FIN = 0x80;
+/** The masked bit of a frame's second byte */
+constexpr uint8_t WS_MASKED = 0x80;
+/** Payload lengths that announce a 16 or 64 bit extended length */
+constexpr uint8_t WS_LEN_16 = 126;
+constexpr uint8_t WS_LEN_64 = 127;
+/** Largest frame accepted from a client, well over anything the game sends */
+constexpr uint64_t WS_MAX_FRAME = 1 << 20;
+/** Bytes read from a socket at a time */
+constexpr size_t READ_CHUNK = 16384;
+
+/** A websocket client */
+struct WsClient {
+	int fd;
+	/** Whether the HTTP upgrade is done */
+	bool upgraded = false;
+	/** Whether to close once the outbox is flushed */
+	bool closing = false;
+	/** Received bytes not yet handled */
+	std::string inbox;
+	/** Bytes not yet written to the socket */
+	std::string outbox;
+	/** Room and player ID, if in a room */
+	uint32_t room = 0;
+	uint8_t player = 0;
+	bool inRoom = false;
+
+	explicit WsClient(int fd) : fd(fd) {}
+};
+
+/** A websocket room */
+struct WsRoom {
+	/** The clients by player ID, or -1 for players that left */
+	std::vector<int> players;
+	uint8_t apiVer = 0;
+	bool started = false;
+};
+
+/** Runs the websocket rooms */
+class WsServer {
+   public:
+	~WsServer() {
+		for (auto& c : clients) {
+			close(c.first);
+		}
+		if (listener >= 0) {
+			close(listener);
+		}
+	}
+
+	/** Start listening on the given port; returns whether that worked */
+	bool listen(unsigned short port) {
+		listener = socket(AF_INET, SOCK_STREAM, 0);
+		if (listener < 0) {
+			return false;
+		}
+		const int yes = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(port);
+		if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+			::listen(listener, SOMAXCONN) != 0) {
+			return false;
+		}
+		fcntl(listener, F_SETFL, O_NONBLOCK);
+		return true;
+	}
+
+	/** Wait up to the given time for socket activity and handle all of it */
+	void poll(int timeoutMs) {
+		std::vector<pollfd> fds;
+		fds.push_back({listener, POLLIN, 0});
+		for (const auto& c : clients) {
+			const short events = c.second.outbox.empty() ? POLLIN : (POLLIN | POLLOUT);
+			fds.push_back({c.first, events, 0});
+		}
+		if (::poll(fds.data(), fds.size(), timeoutMs) <= 0) {
+			return;
+		}
+
+		if ((fds[0].revents & POLLIN) != 0) {
+			accept();
+		}
+		std::vector<int> dead;
+		for (size_t i = 1; i < fds.size(); i++) {
+			auto& c = clients.at(fds[i].fd);
+			bool alive = true;
+			if ((fds[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0) {
+				alive = read(c);
+			}
+			if (alive && !c.outbox.empty()) {
+				alive = flush(c);
+			}
+			if (!alive || (c.closing && c.outbox.empty())) {
+				dead.push_back(c.fd);
+			}
+		}
+		for (const int fd : dead) {
+			drop(fd);
+		}
+	}
+
+	size_t numRooms() const { return rooms.size(); }
+
+	size_t numClients() const { return clients.size(); }
+
+   private:
+	int listener = -1;
+	std::unordered_map<int, WsClient> clients;
+	std::unordered_map<uint32_t, WsRoom> rooms;
+
+	void accept() {
+		for (int fd = ::accept(listener, nullptr, nullptr); fd >= 0;
+			 fd = ::accept(listener, nullptr, nullptr)) {
+			fcntl(fd, F_SETFL, O_NONBLOCK);
+			const int yes = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+			clients.emplace(fd, WsClient(fd));
+		}
+	}
+
+	/** Read everything available and handle it; returns false if the client is gone */
+	bool read(WsClient& c) {
+		std::array<char, READ_CHUNK> buf{};
+		while (true) {
+			const ssize_t n = recv(c.fd, buf.data(), buf.size(), 0);
+			if (n > 0) {
+				c.inbox.append(buf.data(), static_cast<size_t>(n));
+				continue;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			return false;
+		}
+		return c.upgraded ? readFrames(c) : upgrade(c);
+	}
+
+	/** Write as much of the outbox as the socket takes; returns false if the client is gone */
+	static bool flush(WsClient& c) {
+		const ssize_t n = send(c.fd, c.outbox.data(), c.outbox.size(), 0);
+		if (n < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		c.outbox.erase(0, static_cast<size_t>(n));
+		return true;
+	}
+
+	/** Answer the HTTP upgrade request once it is all in; returns false if it is malformed */
+	bool upgrade(WsClient& c) {
+		const size_t end = c.inbox.find("\r\n\r\n");
+		if (end == std::string::npos) {
+			return true;
+		}
+		const std::string request = c.inbox.substr(0, end + 2);
+		c.inbox.erase(0, end + 4);
+
+		// Header names are case insensitive, but the key itself is not
+		std::string lower = request;
+		std::transform(lower.begin(), lower.end(), lower.begin(),
+					   [](char ch) { return static_cast<char>(std::tolower(ch)); });
+		const std::string header = "\r\nsec-websocket-key:";
+		const size_t keyPos = lower.find(header);
+		if (keyPos == std::string::npos) {
+			return false;
+		}
+		size_t start = keyPos + header.size();
+		const size_t stop = request.find("\r\n", start);
+		while (start < stop && request[start] == ' ') {
+			start++;
+		}
+		const std::string key = request.substr(start, stop - start) + WS_GUID;
+
+		CSHA1 sha;
+		sha.Update(reinterpret_cast<const unsigned char*>(key.data()),
+				   static_cast<unsigned int>(key.size()));
+		sha.Final();
+		std::array<unsigned char, SHA1_LENGTH> hash{};
+		sha.GetHash(hash.data());
+		std::array<char, SHA1_LENGTH * 2> encoded{};
+		std::string accept(encoded.data(),
+						   Base64Encoding(hash.data(), SHA1_LENGTH, encoded.data()));
+		// The encoder ends its output with a line break
+		while (!accept.empty() && std::isspace(static_cast<unsigned char>(accept.back())) != 0) {
+			accept.pop_back();
+		}
+
+		c.outbox += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+					"Connection: Upgrade\r\nSec-WebSocket-Accept: " +
+					accept + "\r\n\r\n";
+		c.upgraded = true;
+		return readFrames(c);
+	}
+
+	/** Handle every complete frame in the inbox; returns false if the client broke protocol */
+	bool readFrames(WsClient& c) {
+		size_t pos = 0;
+		while (!c.closing) {
+			const auto* data = reinterpret_cast<const uint8_t*>(c.inbox.data()) + pos;
+			const size_t avail = c.inbox.size() - pos;
+			if (avail < 2) {
+				break;
+			}
+			const uint8_t opcode = data[0] & 0x0F;
+			if ((data[0] & WS_FIN) == 0 || (data[1] & WS_MASKED) == 0) {
+				// The game never fragments, and clients must mask
+				return false;
+			}
+			size_t header = 2;
+			uint64_t length = data[1] & ~WS_MASKED & 0xFF;
+			if (length == WS_LEN_16 || length == WS_LEN_64) {
+				const size_t bytes = length == WS_LEN_16 ? 2 : 8;
+				if (avail < header + bytes) {
+					break;
+				}
+				length = 0;
+				for (size_t i = 0; i < bytes; i++) {
+					length = (length << 8) | data[header + i];
+				}
+				header += bytes;
+			}
+			if (length > WS_MAX_FRAME) {
+				return false;
+			}
+			const std::array<uint8_t, 4> mask = {data[header], data[header + 1],
+												 data[header + 2], data[header + 3]};
+			header += mask.size();
+			if (avail < header + length) {
+				break;
+			}
+
+			std::vector<uint8_t> payload(data + header, data + header + length);
+			for (size_t i = 0; i < payload.size(); i++) {
+				payload[i] ^= mask[i & 3];
+			}
+			pos += header + length;
+
+			switch (opcode) {
+				case WS_BINARY:
+					handle(c, payload);
+					break;
+				case WS_PING:
+					c.outbox += frame(WS_PONG, payload.data(), payload.size());
+					break;
+				case WS_CLOSE:
+					c.outbox += frame(WS_CLOSE, nullptr, 0);
+					c.closing = true;
+					break;
+				default:
+					break;
+			}
+		}
+		c.inbox.erase(0, pos);
+		return true;
+	}
+
+	/** Returns an unmasked frame with the given payload */
+	static std::string frame(uint8_t opcode, const uint8_t* data, size_t size) {
+		std::string out;
+		out.push_back(static_cast<char>(WS_FIN | opcode));
+		if (size < WS_LEN_16) {
+			out.push_back(static_cast<char>(size));
+		} else if (size <= UINT16_MAX) {
+			out.push_back(static_cast<char>(WS_LEN_16));
+			out.push_back(static_cast<char>(size >> 8));
+			out.push_back(static_cast<char>(size & 0xFF));
+		} else {
+			out.push_back(static_cast<char>(WS_LEN_64));
+			for (int shift = 56; shift >= 0; shift -= 8) {
+				out.push_back(static_cast<char>((static_cast<uint64_t>(size) >> shift) & 0xFF));
+			}
+		}
+		out.append(reinterpret_cast<const char*>(data), size);
+		return out;
+	}
+
+	/** Queue a binary message to the given client */
+	void sendTo(int fd, const std::vector<uint8_t>& msg) {
+		clients.at(fd).outbox += frame(WS_BINARY, msg.data(), msg.size());
+	}
+
+	/** Queue a binary message to every player in the room but the given one */
+	void sendToRoom(const WsRoom& room, uint8_t except, const std::vector<uint8_t>& msg) {
+		const std::string out = frame(WS_BINARY, msg.data(), msg.size());
+		for (size_t i = 0; i < room.players.size(); i++) {
+			if (i != except && room.players[i] >= 0) {
+				clients.at(room.players[i]).outbox += out;
+			}
+		}
+	}
+
+	/** Handle a message from a client */
+	void handle(WsClient& c, const std::vector<uint8_t>& msg) {
+		if (msg.empty()) {
+			return;
+		}
+		stats.wsMessages++;
+		stats.wsBytes += msg.size();
+
+		switch (msg[0]) {
+			case AssignedRoom: {
+				// [ AssignedRoom | API version ]
+				if (c.inRoom || msg.size() < 2) {
+					return;
+				}
+				c.room = roomIds.take();
+				c.player = 0;
+				c.inRoom = true;
+				WsRoom& room = rooms[c.room];
+				room.players.push_back(c.fd);
+				room.apiVer = msg[1];
+
+				std::vector<uint8_t> reply = {AssignedRoom};
+				const std::string id = RoomIds::format(c.room);
+				reply.insert(reply.end(), id.begin(), id.end());
+				sendTo(c.fd, reply);
+				std::printf("Websocket room %s opened\n", id.c_str());
+				return;
+			}
+			case JoinRoom: {
+				// [ JoinRoom | room ID | API version ]
+				if (c.inRoom || msg.size() < 2 + ROOM_LENGTH) {
+					return;
+				}
+				const std::string id(msg.begin() + 1, msg.begin() + 1 + ROOM_LENGTH);
+				const uint32_t roomID =
+					static_cast<uint32_t>(std::strtoul(id.c_str(), nullptr, 10)) % ROOM_COUNT;
+				const auto it = rooms.find(roomID);
+				if (it == rooms.end()) {
+					sendTo(c.fd, {JoinRoom, RoomNotFound});
+					return;
+				}
+				WsRoom& room = it->second;
+				if (msg[1 + ROOM_LENGTH] != room.apiVer) {
+					sendTo(c.fd, {ApiMismatch});
+					return;
+				}
+				if (room.started) {
+					sendTo(c.fd, {JoinRoom, GameStarted});
+					return;
+				}
+				if (room.players.size() >= MAX_PLAYERS) {
+					sendTo(c.fd, {JoinRoom, RoomFull});
+					return;
+				}
+
+				// [ JoinRoom | result | number of players | player ID ]
+				c.room = roomID;
+				c.player = static_cast<uint8_t>(room.players.size());
+				c.inRoom = true;
+				room.players.push_back(c.fd);
+				sendTo(c.fd, {JoinRoom, Joined, static_cast<uint8_t>(c.player + 1), c.player});
+				sendToRoom(room, c.player, {PlayerJoined, c.player});
+				return;
+			}
+			default:
+				break;
+		}
+
+		if (!c.inRoom) {
+			return;
+		}
+		WsRoom& room = rooms.at(c.room);
+		switch (msg[0]) {
+			case GeneralMsg:
+				sendToRoom(room, c.player, msg);
+				break;
+			case HostMsg:
+				if (c.player != 0 && room.players[0] >= 0) {
+					sendTo(room.players[0], msg);
+				}
+				break;
+			case StartGame:
+				if (c.player == 0) {
+					room.started = true;
+					sendToRoom(room, 0, msg);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	/** Close a client's socket and take it out of its room */
+	void drop(int fd) {
+		const WsClient& c = clients.at(fd);
+		if (c.inRoom) {
+			WsRoom& room = rooms.at(c.room);
+			room.players[c.player] = -1;
+			sendToRoom(room, c.player, {PlayerDisconnect, c.player});
+			const bool empty = std::none_of(room.players.begin(), room.players.end(),
+											[](int player) { return player >= 0; });
+			if (empty) {
+				std::printf("Websocket room %s closed\n", RoomIds::format(c.room).c_str());
+				rooms.erase(c.room);
+				roomIds.release(c.room);
+			}
+		}
+		close(fd);
+		clients.erase(fd);
+	}
+};
+
+int main(int argc, char** argv) {
+	const auto punchPort =
+		argc > 1 ? static_cast<unsigned short>(std::atoi(argv[1])) : DEFAULT_PUNCH_PORT; // NOLINT
+	const auto wsPort =
+		argc > 2 ? static_cast<unsigned short>(std::atoi(argv[2])) : DEFAULT_WS_PORT; // NOLINT
+
+	SLNet::RakPeerInterface* peer = SLNet::RakPeerInterface::GetInstance();
+	RoomPlugin roomPlugin;
+	SLNet::NatPunchthroughServer punchServer;
+	// The room plugin must see punchthrough requests before the server does
+	peer->AttachPlugin(&roomPlugin);
+	peer->AttachPlugin(&punchServer);
+	SLNet::SocketDescriptor socket(punchPort, nullptr);
+	if (peer->Startup(MAX_CONNECTIONS, &socket, 1) != SLNet::RAKNET_STARTED) {
+		std::fprintf(stderr, "Could not listen on UDP port %d\n", punchPort);
+		return 1;
+	}
+	peer->SetMaximumIncomingConnections(MAX_CONNECTIONS);
+
+	WsServer wsServer;
+	if (!wsServer.listen(wsPort)) {
+		std::fprintf(stderr, "Could not listen on TCP port %d\n", wsPort);
+		return 1;
+	}
+
+	std::signal(SIGINT, [](int /*signal*/) { running = false; });
+	// Clients that vanish mid-send are dropped on the failed send instead
+	std::signal(SIGPIPE, SIG_IGN);
+	// Keep the log current when it is redirected to a file during a benchmark
+	std::setvbuf(stdout, nullptr, _IOLBF, BUFSIZ);
+	std::printf("Punchthrough on UDP port %d, websocket rooms on TCP port %d\n", punchPort,
+				wsPort);
+
+	auto lastStatus = std::chrono::steady_clock::now();
+	while (running) {
+		// Waiting on the websocket doubles as the pause between polls of the punchthrough peer
+		wsServer.poll(POLL_INTERVAL);
+
+		for (SLNet::Packet* packet = peer->Receive(); packet != nullptr;
+			 peer->DeallocatePacket(packet), packet = peer->Receive()) {
+			switch (packet->data[0]) {
+				case ID_NEW_INCOMING_CONNECTION:
+					std::printf("%s connected\n", packet->systemAddress.ToString());
+					break;
+				case ID_DISCONNECTION_NOTIFICATION:
+				case ID_CONNECTION_LOST:
+					std::printf("%s left\n", packet->systemAddress.ToString());
+					break;
+				default:
+					break;
+			}
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastStatus >= STATUS_INTERVAL) {
+			lastStatus = now;
+			std::printf("%u peers in %zu ad-hoc rooms, %zu websocket clients in %zu rooms; "
+						"%llu punchthrough requests (%llu to unknown rooms), "
+						"%llu websocket messages (%llu bytes)\n",
+						peer->NumberOfConnections(), roomPlugin.numRooms(),
+						wsServer.numClients(), wsServer.numRooms(),
+						static_cast<unsigned long long>(stats.punchRequests),
+						static_cast<unsigned long long>(stats.unknownRooms),
+						static_cast<unsigned long long>(stats.wsMessages),
+						static_cast<unsigned long long>(stats.wsBytes));
+		}
+	}
+
+	std::printf("Shutting down\n");
+	peer->Shutdown(SHUTDOWN_BLOCK);
+	SLNet::RakPeerInterface::DestroyInstance(peer);
+	return 0;
+}